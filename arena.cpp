@@ -0,0 +1,109 @@
+#include "arena.h"
+
+#include <cstdint> // Provides uintptr_t
+#include <cstring> // Provides memcpy()
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+void Arena::addBlock(size_t minimum)
+{
+    size_t size = this->blocks.empty() ? ARENA_FIRST_BLOCK : this->blockSizes.back() * 2;
+    if (size > ARENA_MAX_BLOCK)
+    {
+        size = ARENA_MAX_BLOCK;
+    }
+    if (size < minimum) // An allocation larger than a block gets a block of its own size
+    {
+        size = minimum;
+    }
+
+    this->blocks.push_back(unique_ptr<char[]>(new char[size]));
+    this->blockSizes.push_back(size);
+    this->cursor = this->blocks.back().get();
+    this->limit = this->cursor + size;
+    return;
+}
+
+void* Arena::allocate(size_t size, size_t alignment)
+{
+    size_t padding = (alignment - (size_t)((uintptr_t)this->cursor & (alignment - 1))) & (alignment - 1);
+
+    if (this->cursor == nullptr || (size_t)(this->limit - this->cursor) < padding + size)
+    {
+        this->addBlock(size + alignment);
+        padding = (alignment - (size_t)((uintptr_t)this->cursor & (alignment - 1))) & (alignment - 1);
+    }
+
+    char* memory = this->cursor + padding;
+    this->cursor = memory + size;
+    this->used += size;
+    return memory;
+}
+
+string_view Arena::copy(string_view text)
+{
+    if (text.empty())
+    {
+        return string_view();
+    }
+
+    char* memory = (char*)this->allocate(text.size(), 1);
+    memcpy(memory, text.data(), text.size());
+    return string_view(memory, text.size());
+}
+
+string_view Arena::concat(string_view first, string_view second)
+{
+    char* memory = (char*)this->allocate(first.size() + second.size(), 1);
+    memcpy(memory, first.data(), first.size());
+    memcpy(memory + first.size(), second.data(), second.size());
+    return string_view(memory, first.size() + second.size());
+}
+
+void Arena::reset()
+{
+    if (this->blocks.size() > 1) // Keep the largest block, so a parser reused for similar netlists stops allocating
+    {
+        size_t largest = 0;
+        for (size_t i = 1; i < this->blocks.size(); ++i)
+        {
+            if (this->blockSizes[i] > this->blockSizes[largest])
+            {
+                largest = i;
+            }
+        }
+        unique_ptr<char[]> kept = move(this->blocks[largest]);
+        size_t keptSize = this->blockSizes[largest];
+        this->blocks.clear();
+        this->blockSizes.clear();
+        this->blocks.push_back(move(kept));
+        this->blockSizes.push_back(keptSize);
+    }
+
+    if (!this->blocks.empty())
+    {
+        this->cursor = this->blocks.back().get();
+        this->limit = this->cursor + this->blockSizes.back();
+    }
+    this->used = 0;
+    return;
+}
+
+size_t Arena::bytesUsed() const
+{
+    return this->used;
+}
+
+size_t Arena::bytesReserved() const
+{
+    size_t reserved = 0;
+    for (size_t size : this->blockSizes)
+    {
+        reserved += size;
+    }
+    return reserved;
+}
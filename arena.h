@@ -0,0 +1,56 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const size_t ARENA_FIRST_BLOCK = 64 * 1024; // Size of the first block; each later block doubles up to ARENA_MAX_BLOCK
+const size_t ARENA_MAX_BLOCK = 4 * 1024 * 1024;
+
+/*
+    Bump allocator for the storage of one conversion. Allocating moves a pointer through the current block,
+    and nothing is freed individually: reset() releases everything at once. Nothing stored in the arena has
+    its destructor run, so only trivially destructible data (names, plain structs) belong here
+*/
+class Arena
+{
+    private:
+        vector<unique_ptr<char[]>> blocks; // Every block allocated so far (the current one is last)
+        vector<size_t> blockSizes; // Size of each block
+        char* cursor; // Next free byte of the current block
+        char* limit; // One past the end of the current block
+        size_t used; // Bytes handed out since the last reset
+
+        void addBlock(size_t minimum); // Start a new block of at least minimum bytes
+
+    public:
+
+        // Default Constructor
+        Arena()
+        {
+            this->cursor = nullptr;
+            this->limit = nullptr;
+            this->used = 0;
+        }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+        string_view copy(string_view text); // Store a copy of the text
+        string_view concat(string_view first, string_view second); // Store first followed by second (e.g., "x" + "wire")
+
+        void reset(); // Release everything, keeping only the largest block for the next conversion
+        size_t bytesUsed() const;
+        size_t bytesReserved() const;
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include "batch.h"
+#include "parser.h"
+#include "threadpool.h"
+#include "dataflow.h"
+
+#include <algorithm> // Provides sort() and min()
+#include <cstdio> // Provides snprintf()
+#include <chrono> // Provides steady_clock for timing each conversion
+#include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
+#include <fstream> // Provides functionality for working with files in C++ (e.g., ifstream, ofstream, and fstream)
+#include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., cin and cout)
+#include <map>
+
+#if !defined(_WIN32)
+#include <glob.h> // Provides glob() for expanding wildcard patterns
+#endif
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+namespace fs = filesystem;
+
+static string defaultOutput(const string& netlistFile, const string& outputDir) // e.g., "circuits/ucircuit1.txt" -> "<outputDir>/ucircuit1.v"
+{
+    return (fs::path(outputDir) / fs::path(netlistFile).stem()).string() + ".v";
+}
+
+bool collectBatchJobs(const string& source, const string& outputDir, vector<BatchJob>& jobs, string& error)
+{
+    error_code ec;
+    vector<string> netlists; // Netlists that take their Verilog file name from outputDir
+
+    if (fs::is_directory(source, ec)) // Every *.txt file in the directory
+    {
+        for (const fs::directory_entry& entry : fs::directory_iterator(source, ec))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".txt")
+            {
+                netlists.push_back(entry.path().string());
+            }
+        }
+        sort(netlists.begin(), netlists.end()); // Directory order is unspecified, so sort for a stable summary
+    }
+    else if (source.find_first_of("*?[") != string::npos) // A glob pattern
+    {
+#if !defined(_WIN32)
+        glob_t matches;
+        if (glob(source.c_str(), 0, nullptr, &matches) == 0)
+        {
+            for (size_t i = 0; i < matches.gl_pathc; ++i)
+            {
+                netlists.push_back(matches.gl_pathv[i]);
+            }
+        }
+        globfree(&matches);
+#else
+        error = "Glob patterns are not supported on this platform: " + source;
+        return false;
+#endif
+    }
+    else // A manifest file
+    {
+        ifstream manifest(source);
+        if (!manifest.is_open())
+        {
+            error = "Unable to open the batch source " + source;
+            return false;
+        }
+
+        string line;
+        while (getline(manifest, line))
+        {
+            istringstream lineStream(line);
+            string netlistFile;
+            string verilogFile;
+
+            lineStream >> netlistFile >> verilogFile;
+
+            if (netlistFile.empty() || netlistFile[0] == '#') // Skip blank lines and comments
+            {
+                continue;
+            }
+
+            jobs.push_back(BatchJob{netlistFile, verilogFile.empty() ? defaultOutput(netlistFile, outputDir) : verilogFile});
+        }
+    }
+
+    for (const string& netlistFile : netlists)
+    {
+        jobs.push_back(BatchJob{netlistFile, defaultOutput(netlistFile, outputDir)});
+    }
+
+    if (jobs.empty())
+    {
+        error = "No netlists found in " + source;
+        return false;
+    }
+
+    // Two jobs that write the same file would race, and one of the modules would be lost (e.g., "a/x.txt" and "b/x.txt" both give "x.v")
+    map<string, size_t> writers; // Job of each Verilog file, by its absolute path
+    for (size_t index = 0; index < jobs.size(); ++index)
+    {
+        fs::path path = fs::weakly_canonical(jobs[index].verilogFile, ec);
+        if (ec)
+        {
+            path = fs::absolute(jobs[index].verilogFile, ec).lexically_normal();
+        }
+        auto inserted = writers.emplace(path.string(), index);
+        if (!inserted.second)
+        {
+            error = jobs[inserted.first->second].netlistFile + " and " + jobs[index].netlistFile + " would both be written to " + jobs[index].verilogFile +
+                    " (give each its own Verilog file in a manifest)";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int runBatch(const vector<BatchJob>& jobs, size_t threadCount, const ConvertOptions& options)
+{
+    vector<BatchResult> results(jobs.size()); // Each task writes only its own slot
+    vector<size_t> order(jobs.size()); // Submission order of the jobs
+
+    /*
+        Submit the largest netlists first so that they do not start last and leave the other workers idle,
+        work stealing then spreads the small ones over whichever workers are free
+    */
+    vector<uintmax_t> sizes(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        error_code ec;
+        order[i] = i;
+        sizes[i] = fs::file_size(jobs[i].netlistFile, ec);
+        if (ec)
+        {
+            sizes[i] = 0;
+        }
+    }
+    stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    auto start = chrono::steady_clock::now();
+    size_t workerCount;
+
+    {
+        ThreadPool pool(threadCount);
+        workerCount = pool.size();
+
+        ConvertOptions jobOptions = options;
+        if (jobOptions.emitThreads == 0) // The files are already converted in parallel, so each formats its instances on one thread
+        {
+            jobOptions.emitThreads = 1;
+        }
+
+        for (size_t index : order)
+        {
+            pool.submit([&jobs, &results, &jobOptions, index]
+            {
+                const BatchJob& job = jobs[index];
+                BatchResult& result = results[index];
+                auto jobStart = chrono::steady_clock::now();
+
+                NetParser netParser; // One parser per task, so the tasks share no state
+                netParser.setOptions(jobOptions);
+                result.success = netParser.convertToVerilog(job.netlistFile, job.verilogFile);
+                result.message = netParser.getErrorMessage();
+                result.stats = netParser.getStats();
+
+                if (result.success && jobOptions.criticalPath)
+                {
+                    DataflowGraph graph;
+                    graph.build(netParser.getOperations(), netParser.getSymbols());
+                    TimingReport report = graph.analyzeTiming();
+                    result.timing = report.hasLoop ? "combinational loop through " + graph.describe(report.loop.front()) : "critical path " + to_string(report.criticalPath) + " ns";
+                }
+                if (result.success && jobOptions.costReport) // One summary per job; the full report is for single conversions
+                {
+                    DataflowGraph graph;
+                    graph.build(netParser.getOperations(), netParser.getSymbols());
+                    CostReport cost = graph.analyzeCost(jobOptions.clockPeriod);
+                    double worstSlack = 0;
+                    for (size_t output = 0; output < cost.outputs.size(); ++output)
+                    {
+                        worstSlack = output == 0 ? cost.outputs[output].slack : min(worstSlack, cost.outputs[output].slack);
+                    }
+                    char text[96];
+                    if (cost.hasLoop || cost.outputs.empty())
+                    {
+                        snprintf(text, sizeof(text), "area %.1f gates", cost.area);
+                    }
+                    else
+                    {
+                        snprintf(text, sizeof(text), "area %.1f gates, worst output slack %.3f ns", cost.area, worstSlack);
+                    }
+                    result.cost = text;
+                }
+                result.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - jobStart).count();
+            });
+        }
+
+        pool.wait();
+    }
+
+    double totalMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Print the summary in the order the jobs were given
+    size_t failures = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const BatchResult& result = results[i];
+
+        if (result.success)
+        {
+            cout << "[ OK ] " << jobs[i].netlistFile << " -> " << jobs[i].verilogFile << " (" << result.milliseconds << " ms)";
+            if (!result.timing.empty())
+            {
+                cout << ", " << result.timing;
+            }
+            if (!result.cost.empty())
+            {
+                cout << ", " << result.cost;
+            }
+            cout << "\n";
+        }
+        else
+        {
+            failures++;
+            cout << "[FAIL] " << jobs[i].netlistFile << ": " << (result.message.empty() ? "incomplete Behavioral Netlist" : result.message) << "\n";
+        }
+    }
+
+    if (options.collectStats) // Sum of the per-file stats; the phase times add up the work of every thread
+    {
+        ConversionStats totals;
+        for (const BatchResult& result : results)
+        {
+            totals.add(result.stats);
+        }
+        printStats(cout, totals);
+    }
+
+    cout << jobs.size() - failures << " converted, " << failures << " failed, " << workerCount << " threads, " << totalMilliseconds << " ms" << endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "parser.h"
+
+#include <string>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// A single netlist to convert in batch mode
+struct BatchJob
+{
+    string netlistFile; // Behavioral netlist to read
+    string verilogFile; // Verilog file to write
+};
+
+// Outcome of a single batch job
+struct BatchResult
+{
+    bool success; // Whether the Verilog file was created
+    string message; // Why the conversion failed (empty on success)
+    double milliseconds; // Wall time of the conversion
+    ConversionStats stats; // Phase times and counts (when --stats is given)
+    string timing; // Critical path or combinational loop (when --critical-path is given)
+    string cost; // Total area and worst output slack (when --cost is given)
+};
+
+/*
+    Expand a directory (every *.txt inside it), a glob pattern (e.g., "circuits/ucircuit*.txt"), or a manifest file
+    (one "netlistFile [verilogFile]" per line) into jobs; netlists without an explicit Verilog file are
+    written to outputDir as <name>.v. Two jobs that would write the same Verilog file are an error
+*/
+bool collectBatchJobs(const string& source, const string& outputDir, vector<BatchJob>& jobs, string& error);
+
+// Convert every job on a work-stealing pool (zero threads means one per core) and print a per-file summary
+int runBatch(const vector<BatchJob>& jobs, size_t threadCount, const ConvertOptions& options);
+
+#endif
@@ -0,0 +1,338 @@
+#include "parser.h"
+#include "lexer.h"
+#include "netgen.h"
+#include "emitter.h"
+#include "dataflow.h"
+
+#include <chrono> // Provides steady_clock for timing each phase
+#include <cstdio> // Provides snprintf()
+#include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
+#include <fstream> // Provides functionality for working with files in C++ (e.g., ifstream, ofstream, and fstream)
+#include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., cin and cout)
+
+#if !defined(_WIN32)
+#include <sys/resource.h> // Provides getrusage()
+#include <unistd.h> // Provides getpid()
+#endif
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+namespace fs = filesystem;
+
+// Measurements of one phase of the conversion
+struct PhaseResult
+{
+    const char* name; // Phase name in the report
+    double seconds; // Best wall time over the repetitions
+    size_t bytes; // Bytes the phase consumes (netlist) or produces (Verilog)
+    long peakRssKb; // Peak resident set size of the process after the phase
+};
+
+static long peakRssKb() // Peak resident set size so far, in kilobytes (0 where unsupported)
+{
+#if !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        return usage.ru_maxrss; // Linux reports kilobytes
+    }
+#endif
+    return 0;
+}
+
+static void appendNumber(Emitter& out, double value) // JSON number with a fixed number of decimals
+{
+    char digits[64];
+    snprintf(digits, sizeof(digits), "%.6f", value);
+    out.append(digits);
+    return;
+}
+
+static void appendJsonString(Emitter& out, const string& text) // Quote a string for JSON
+{
+    out.append('"');
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out.append('\\');
+        }
+        if ((unsigned char)c < 0x20)
+        {
+            out.append(' ');
+            continue;
+        }
+        out.append(c);
+    }
+    out.append('"');
+    return;
+}
+
+void print_usage()
+{
+    cout << "Usage: dpgen_bench [--ops N] [--mix SPEC] [--widths SPEC] [--fanout N] [--registers F] [--signed F] [--seed N]" << endl;
+    cout << "                   [--input netlistFile] [--save netlistFile] [--repeat N] [--json reportFile]" << endl;
+    cout << "\t- --ops N        : Number of generated operation lines (default: 1000)" << endl;
+    cout << "\t- --mix SPEC     : Operator weights, e.g., \"add=4,sub=2,mul=1,comp=1,mux=1,shr=1,shl=1\"" << endl;
+    cout << "\t- --widths SPEC  : Bit width weights, e.g., \"8=2,16=2,32=1,64=1\"" << endl;
+    cout << "\t- --fanout N     : Number of reads of each generated net (default: 2)" << endl;
+    cout << "\t- --registers F  : Fraction of the lines that are register assignments (default: 0.1)" << endl;
+    cout << "\t- --signed F     : Fraction of the nets with a signed type (default: 0.5)" << endl;
+    cout << "\t- --seed N       : Seed of the generator (default: 1)" << endl;
+    cout << "\t- --input FILE   : Benchmark an existing netlist instead of generating one" << endl;
+    cout << "\t- --save FILE    : Also keep the generated netlist in FILE" << endl;
+    cout << "\t- --repeat N     : Run every phase N times and report the fastest (default: 1)" << endl;
+    cout << "\t- --json FILE    : Write the JSON report to FILE instead of the standard output" << endl;
+    return;
+}
+
+/*
+    Time each phase of a conversion (read, lex, resolve, emit, write, dataflow) on a generated or given netlist
+    and report the results as JSON:
+
+        read    : map the netlist file and touch every page
+        lex     : split the netlist into classified lines and tokens
+        resolve : the full parse; lexing, interning every name into the symbol table, and building the operation list
+        emit    : generate the Verilog module in memory
+        write   : write the module to a file
+        dataflow: build the dependency graph and find the critical path
+*/
+int main(int argc, char* argv[])
+{
+    NetgenOptions genOptions;
+    string inputFile;
+    string saveFile;
+    string jsonFile;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try
+        {
+            if (arg == "--ops" && hasValue) { genOptions.opCount = (size_t)stoull(argv[++i]); }
+            else if (arg == "--mix" && hasValue) { genOptions.opMix = argv[++i]; }
+            else if (arg == "--widths" && hasValue) { genOptions.widthMix = argv[++i]; }
+            else if (arg == "--fanout" && hasValue) { genOptions.fanout = stoi(argv[++i]); }
+            else if (arg == "--registers" && hasValue) { genOptions.registerDensity = stod(argv[++i]); }
+            else if (arg == "--signed" && hasValue) { genOptions.signedDensity = stod(argv[++i]); }
+            else if (arg == "--seed" && hasValue) { genOptions.seed = stoull(argv[++i]); }
+            else if (arg == "--input" && hasValue) { inputFile = argv[++i]; }
+            else if (arg == "--save" && hasValue) { saveFile = argv[++i]; }
+            else if (arg == "--repeat" && hasValue) { repeat = max(1, stoi(argv[++i])); }
+            else if (arg == "--json" && hasValue) { jsonFile = argv[++i]; }
+            else
+            {
+                print_usage();
+                return 1;
+            }
+        }
+        catch (const exception&)
+        {
+            cerr << "Error: Invalid value for " << arg << endl;
+            return 1;
+        }
+    }
+
+    using Clock = chrono::steady_clock;
+    auto secondsSince = [](Clock::time_point start) { return chrono::duration<double>(Clock::now() - start).count(); };
+
+    // Generate the netlist, unless one is given
+    double generateSeconds = 0;
+    string netlistPath = inputFile;
+    bool removeNetlist = false;
+
+#if !defined(_WIN32)
+    string scratch = to_string(getpid());
+#else
+    string scratch = "0";
+#endif
+
+    if (inputFile.empty())
+    {
+        string netlistText;
+        string error;
+        auto start = Clock::now();
+
+        if (!generateNetlist(genOptions, netlistText, error))
+        {
+            cerr << "Error: " << error << endl;
+            return 1;
+        }
+        generateSeconds = secondsSince(start);
+
+        netlistPath = saveFile;
+        if (netlistPath.empty())
+        {
+            netlistPath = (fs::temp_directory_path() / ("dpgen_bench_" + scratch + ".txt")).string();
+            removeNetlist = true;
+        }
+        if (!writeWholeFile(netlistPath, netlistText))
+        {
+            cerr << "Error: Unable to write the netlist " << netlistPath << endl;
+            return 1;
+        }
+    }
+
+    string verilogPath = (fs::temp_directory_path() / ("dpgen_bench_" + scratch + ".v")).string();
+
+    PhaseResult phases[] =
+    {
+        { "read", 1e300, 0, 0 },
+        { "lex", 1e300, 0, 0 },
+        { "resolve", 1e300, 0, 0 },
+        { "emit", 1e300, 0, 0 },
+        { "write", 1e300, 0, 0 },
+        { "dataflow", 1e300, 0, 0 },
+    };
+    size_t lineCount = 0;
+    size_t operationCount = 0;
+    size_t symbolCount = 0;
+    double criticalPath = 0; // -1 for a combinational loop
+
+    for (int run = 0; run < repeat; ++run)
+    {
+        // read
+        auto start = Clock::now();
+        MappedFile netlistFile(netlistPath);
+        if (!netlistFile.isOpen())
+        {
+            cerr << "Error: Unable to open the text file of " << netlistPath << endl;
+            return 1;
+        }
+        string_view netlistText = netlistFile.text();
+        size_t newlines = 0;
+        for (char c : netlistText) // Touch every page so that the mapping is really read
+        {
+            newlines += (c == '\n');
+        }
+        phases[0] = { "read", min(phases[0].seconds, secondsSince(start)), netlistText.size(), peakRssKb() };
+
+        // lex
+        start = Clock::now();
+        NetLexer lexer(netlistText);
+        NetLine line;
+        lineCount = 0;
+        while (lexer.nextLine(line))
+        {
+            lineCount++;
+        }
+        phases[1] = { "lex", min(phases[1].seconds, secondsSince(start)), netlistText.size(), peakRssKb() };
+
+        // resolve
+        start = Clock::now();
+        NetParser netParser;
+        if (!netParser.parseText(netlistText))
+        {
+            cerr << "Error: " << netParser.getErrorMessage() << endl;
+            return 1;
+        }
+        phases[2] = { "resolve", min(phases[2].seconds, secondsSince(start)), netlistText.size(), peakRssKb() };
+        operationCount = netParser.getOperations().size();
+        symbolCount = netParser.getSymbols().size();
+
+        // emit
+        start = Clock::now();
+        string verilogText = netParser.emitVerilog("bench");
+        phases[3] = { "emit", min(phases[3].seconds, secondsSince(start)), verilogText.size(), peakRssKb() };
+
+        // write
+        start = Clock::now();
+        if (!writeWholeFile(verilogPath, verilogText))
+        {
+            cerr << "Error: Unable to write the Verilog file " << verilogPath << endl;
+            return 1;
+        }
+        phases[4] = { "write", min(phases[4].seconds, secondsSince(start)), verilogText.size(), peakRssKb() };
+
+        // dataflow
+        start = Clock::now();
+        DataflowGraph graph;
+        graph.build(netParser.getOperations(), netParser.getSymbols());
+        TimingReport report = graph.analyzeTiming();
+        phases[5] = { "dataflow", min(phases[5].seconds, secondsSince(start)), netlistText.size(), peakRssKb() };
+        criticalPath = report.hasLoop ? -1 : report.criticalPath;
+
+        (void)newlines;
+    }
+
+    error_code ec;
+    fs::remove(verilogPath, ec);
+    if (removeNetlist)
+    {
+        fs::remove(netlistPath, ec);
+    }
+
+    // Report
+    Emitter json;
+    json.append("{\n  \"dpgen_version\": \"" DPGEN_VERSION "\",\n");
+    json.append("  \"netlist\": {\"file\": ");
+    appendJsonString(json, inputFile.empty() ? (saveFile.empty() ? string("generated") : saveFile) : inputFile);
+    json.append(", \"bytes\": ").appendInt((long long)phases[0].bytes);
+    json.append(", \"lines\": ").appendInt((long long)lineCount);
+    json.append(", \"operations\": ").appendInt((long long)operationCount);
+    json.append(", \"symbols\": ").appendInt((long long)symbolCount);
+    json.append(", \"critical_path_ns\": ");
+    appendNumber(json, criticalPath);
+    json.append("},\n");
+
+    if (inputFile.empty())
+    {
+        json.append("  \"generator\": {\"ops\": ").appendInt((long long)genOptions.opCount);
+        json.append(", \"mix\": ");
+        appendJsonString(json, genOptions.opMix);
+        json.append(", \"widths\": ");
+        appendJsonString(json, genOptions.widthMix);
+        json.append(", \"fanout\": ").appendInt(genOptions.fanout);
+        json.append(", \"registers\": ");
+        appendNumber(json, genOptions.registerDensity);
+        json.append(", \"signed\": ");
+        appendNumber(json, genOptions.signedDensity);
+        json.append(", \"seed\": ").appendInt((long long)genOptions.seed);
+        json.append(", \"seconds\": ");
+        appendNumber(json, generateSeconds);
+        json.append("},\n");
+    }
+
+    json.append("  \"repeat\": ").appendInt(repeat).append(",\n");
+    json.append("  \"phases\": [\n");
+
+    double totalSeconds = 0;
+    for (size_t i = 0; i < sizeof(phases) / sizeof(phases[0]); ++i)
+    {
+        const PhaseResult& phase = phases[i];
+        double seconds = phase.seconds > 0 ? phase.seconds : 1e-9; // Keep the rates finite for tiny inputs
+        totalSeconds += phase.seconds;
+
+        json.append("    {\"name\": \"").append(phase.name).append("\", \"seconds\": ");
+        appendNumber(json, phase.seconds);
+        json.append(", \"bytes\": ").appendInt((long long)phase.bytes);
+        json.append(", \"mb_per_second\": ");
+        appendNumber(json, phase.bytes / seconds / 1e6);
+        json.append(", \"operations_per_second\": ");
+        appendNumber(json, operationCount / seconds);
+        json.append(", \"peak_rss_kb\": ").appendInt(phase.peakRssKb).append("}");
+        json.append(i + 1 < sizeof(phases) / sizeof(phases[0]) ? ",\n" : "\n");
+    }
+
+    json.append("  ],\n  \"total_seconds\": ");
+    appendNumber(json, totalSeconds);
+    json.append(",\n  \"peak_rss_kb\": ").appendInt(peakRssKb()).append("\n}\n");
+
+    if (jsonFile.empty())
+    {
+        cout << json.text();
+    }
+    else if (!writeWholeFile(jsonFile, json.text()))
+    {
+        cerr << "Error: Unable to write the report " << jsonFile << endl;
+        return 1;
+    }
+
+    return 0;
+}
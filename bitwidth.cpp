@@ -0,0 +1,570 @@
+#include "bitwidth.h"
+#include "parser.h"
+#include "dataflow.h"
+
+#include <algorithm> // Provides min() and max()
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+typedef __int128 WideInt; // Holds every value of a 64-bit net, and the sum or product of two of them (GCC and Clang)
+
+const int MAX_ANALYZED_WIDTH = 64; // Wider nets keep their declared width
+const int WIDEN_AFTER_UPDATES = 4; // Times the interval of a net may grow before it is widened to its declared range
+
+// The values a net (or the output of an instance) can hold
+struct ValueRange
+{
+    bool known = false; // Set once an operation that drives the net has been evaluated
+    WideInt low = 0;
+    WideInt high = 0;
+
+    bool operator==(const ValueRange& other) const
+    {
+        return this->known == other.known && this->low == other.low && this->high == other.high;
+    }
+};
+
+enum class EvalStatus : uint8_t
+{
+    OK, // The result range is known
+    NOT_READY, // An input has no range yet (its driver was not evaluated)
+    UNKNOWN // The operation cannot be analyzed (e.g., a net wider than 64 bits), so its destination may hold anything
+};
+
+// One evaluation of an operation as the emitted instance computes it
+struct Evaluation
+{
+    bool moduleSigned = false; // Whether the signed module variant is emitted
+    int dataWidth = 0; // DATAWIDTH given by the width rule of the opcode
+    ValueRange inputs[MAX_OPERANDS]; // Each input as the instance reads it (indexed by operand slot)
+    ValueRange result; // Output of the instance
+};
+
+static WideInt lowest(int width, bool isSigned) // Smallest value of a width-bit number
+{
+    return isSigned ? -((WideInt)1 << (width - 1)) : 0;
+}
+
+static WideInt highest(int width, bool isSigned) // Largest value of a width-bit number
+{
+    return isSigned ? ((WideInt)1 << (width - 1)) - 1 : ((WideInt)1 << width) - 1;
+}
+
+static ValueRange fullRange(int width, bool isSigned)
+{
+    return ValueRange{true, lowest(width, isSigned), highest(width, isSigned)};
+}
+
+// The values read back after storing range into width bits read as isSigned (the same values if every one fits)
+static ValueRange fitRange(const ValueRange& range, int width, bool isSigned)
+{
+    if (range.low >= lowest(width, isSigned) && range.high <= highest(width, isSigned))
+    {
+        return range;
+    }
+    return fullRange(width, isSigned);
+}
+
+static ValueRange join(const ValueRange& a, const ValueRange& b)
+{
+    if (!a.known || !b.known)
+    {
+        return a.known ? a : b;
+    }
+    return ValueRange{true, min(a.low, b.low), max(a.high, b.high)};
+}
+
+static int bitLength(WideInt value) // Bits of a non-negative value (0 for 0)
+{
+    uint64_t high = (uint64_t)(value >> 64);
+    uint64_t low = (uint64_t)value;
+    if (high != 0)
+    {
+        return 128 - __builtin_clzll(high);
+    }
+    return low != 0 ? 64 - __builtin_clzll(low) : 0;
+}
+
+static int minimalWidth(const ValueRange& range, bool isSigned) // Fewest bits (at least one) that hold every value of range
+{
+    if (isSigned) // A sign bit on top of the magnitude of either end (the most negative value of n bits is -(2^n))
+    {
+        return 1 + max(bitLength(range.high < 0 ? 0 : range.high), bitLength(range.low < 0 ? -(range.low + 1) : 0));
+    }
+    if (range.low < 0)
+    {
+        return 128; // No unsigned width holds it
+    }
+    return max(1, bitLength(range.high));
+}
+
+static bool isAnalyzable(int width)
+{
+    return width >= 1 && width <= MAX_ANALYZED_WIDTH;
+}
+
+// Width of each net as the module declares it: printWire() declares a wire that selects a MUX with one bit
+static vector<int> declaredWidths(const SymbolTable& symbols, const UseDefIndex& useDefs)
+{
+    vector<int> widths(symbols.size());
+    for (size_t id = 0; id < symbols.size(); ++id)
+    {
+        const variableInfo& info = symbols.getInfo((int)id);
+        bool isSelect = info.netType == WIRE && id < useDefs.size() && useDefs.isUsedAs((int)id, PortRole::SELECT);
+        widths[id] = isSelect ? 1 : info.bitWidth;
+    }
+    return widths;
+}
+
+static size_t operandCountOf(Opcode opcode) // Operands (with the output) of a well-formed operation
+{
+    switch (opcode)
+    {
+        case Opcode::MUX: return 4; // g = sel ? a : b
+        case Opcode::REG: return 2; // z = zwire
+        default: return 3; // d = a + b
+    }
+}
+
+static EvalStatus evaluate(const OpList& ops, size_t index, const SymbolTable& symbols, const vector<int>& widths, const vector<ValueRange>& ranges, Evaluation& eval)
+{
+    Opcode opcode = ops.getOpcode(index);
+    OperandRange operands = ops.getOperands(index);
+    const OpDescriptor& desc = getDescriptor(opcode);
+
+    if (operands.size() != operandCountOf(opcode))
+    {
+        return EvalStatus::UNKNOWN;
+    }
+
+    eval.dataWidth = getMaxBitWidth(desc.widthRule, operands, symbols);
+    eval.moduleSigned = desc.signedModule != nullptr && isSigned(operands, symbols);
+    if (eval.dataWidth < 1 || eval.dataWidth > MAX_ANALYZED_WIDTH)
+    {
+        return EvalStatus::UNKNOWN;
+    }
+
+    for (size_t slot = 1; slot < operands.size(); ++slot)
+    {
+        if (opcode == Opcode::MUX && slot == 1) // The select drives a one-bit port, and either data input may be chosen
+        {
+            continue;
+        }
+
+        int width = widths[operands[slot]];
+        const ValueRange& range = ranges[operands[slot]];
+        if (!isAnalyzable(width))
+        {
+            return EvalStatus::UNKNOWN;
+        }
+        if (!range.known)
+        {
+            return EvalStatus::NOT_READY;
+        }
+
+        // A narrower net is zero-extended into the port, so the instance reads its bits as unsigned; a wider one is truncated
+        eval.inputs[slot] = width < eval.dataWidth ? fitRange(range, width, false) : fitRange(range, eval.dataWidth, eval.moduleSigned);
+    }
+
+    const ValueRange& a = eval.inputs[1];
+    const ValueRange& b = eval.inputs[2];
+    ValueRange exact{true, 0, 0};
+
+    switch (opcode)
+    {
+        case Opcode::ADD:
+            exact = ValueRange{true, a.low + b.low, a.high + b.high};
+            break;
+        case Opcode::SUB:
+            exact = ValueRange{true, a.low - b.high, a.high - b.low};
+            break;
+        case Opcode::MUL:
+            if (minimalWidth(a, true) + minimalWidth(b, true) > 126) // The product could overflow WideInt, and it wraps anyway
+            {
+                exact = fullRange(eval.dataWidth, eval.moduleSigned);
+            }
+            else
+            {
+                WideInt products[4] = { a.low * b.low, a.low * b.high, a.high * b.low, a.high * b.high };
+                exact = ValueRange{true, *min_element(products, products + 4), *max_element(products, products + 4)};
+            }
+            break;
+        case Opcode::GT:
+        case Opcode::LT:
+        case Opcode::EQ:
+            eval.result = ValueRange{true, 0, 1}; // A one-bit output port
+            return EvalStatus::OK;
+        case Opcode::MUX:
+            exact = join(eval.inputs[2], eval.inputs[3]);
+            break;
+        case Opcode::SHR: // Logical shift of an unsigned input
+            exact = ValueRange{true, a.low >> (int)min(b.high, (WideInt)127), a.high >> (int)min(b.low, (WideInt)127)};
+            break;
+        case Opcode::SHL:
+            if (b.high >= eval.dataWidth || minimalWidth(a, false) + (int)b.high > MAX_ANALYZED_WIDTH + 1) // Shifted past the top bit
+            {
+                exact = fullRange(eval.dataWidth, eval.moduleSigned);
+            }
+            else
+            {
+                exact = ValueRange{true, a.low << (int)b.low, a.high << (int)b.high};
+            }
+            break;
+        case Opcode::REG:
+            exact = join(a, ValueRange{true, 0, 0}); // A reset clears the register
+            break;
+        default:
+            return EvalStatus::UNKNOWN;
+    }
+
+    eval.result = fitRange(exact, eval.dataWidth, eval.moduleSigned); // The instance wraps at DATAWIDTH
+    return EvalStatus::OK;
+}
+
+// Name the narrowed instances while the operation list still holds them
+static void describeInstances(WidthSavings& savings, const OpList& ops, const SymbolTable& symbols)
+{
+    DataflowGraph graph; // Only for the instance names
+    bool built = false;
+    for (NarrowedInstance& instance : savings.instances)
+    {
+        if (instance.description.empty())
+        {
+            if (!built)
+            {
+                graph.build(ops, symbols);
+                built = true;
+            }
+            instance.description = graph.describe(instance.operation);
+        }
+    }
+    return;
+}
+
+void minimizeDataWidths(OpList& ops, const SymbolTable& symbols, const UseDefIndex& useDefs, WidthSavings& savings)
+{
+    size_t count = ops.size();
+    vector<int> widths = declaredWidths(symbols, useDefs);
+
+    // Inputs, and nets that no operation drives, may hold any value of their declared type
+    vector<ValueRange> ranges(symbols.size());
+    for (size_t id = 0; id < symbols.size(); ++id)
+    {
+        if (symbols.getInfo((int)id).netType == CONSTANT) // An integer literal holds its value only
+        {
+            WideInt value = (WideInt)getConstantValue((int)id, symbols);
+            ranges[id] = ValueRange{true, value, value};
+        }
+        else if (useDefs.getDefinition((int)id) < 0 && isAnalyzable(widths[id]))
+        {
+            ranges[id] = fullRange(widths[id], symbols.getInfo((int)id).signType == 's');
+        }
+    }
+
+    // Evaluate every operation in netlist order, then again each reader of a net whose range grew (a worklist,
+    // so a netlist in dataflow order settles in one pass and only loops through registers are revisited)
+    vector<uint32_t> worklist(count);
+    vector<uint8_t> queued(count, 1);
+    for (size_t index = 0; index < count; ++index)
+    {
+        worklist[index] = (uint32_t)index;
+    }
+
+    vector<uint8_t> updates(symbols.size(), 0);
+    for (size_t next = 0; next < worklist.size(); ++next)
+    {
+        size_t index = worklist[next];
+        queued[index] = 0;
+        if (ops.getOpcode(index) == Opcode::NONE || ops.getOperands(index).size() == 0)
+        {
+            continue;
+        }
+
+        int destination = ops.getOperands(index)[0];
+        int width = widths[destination];
+        if (!isAnalyzable(width))
+        {
+            continue;
+        }
+
+        Evaluation eval;
+        EvalStatus status = evaluate(ops, index, symbols, widths, ranges, eval);
+        if (status == EvalStatus::NOT_READY)
+        {
+            continue;
+        }
+
+        bool destinationSigned = symbols.getInfo(destination).signType == 's';
+        ValueRange stored = status == EvalStatus::OK ? fitRange(eval.result, width, destinationSigned) : fullRange(width, destinationSigned);
+        ValueRange merged = join(ranges[destination], stored);
+        if (merged == ranges[destination])
+        {
+            continue;
+        }
+
+        if (++updates[destination] > WIDEN_AFTER_UPDATES) // Still growing, e.g., an accumulator
+        {
+            merged = fullRange(width, destinationSigned);
+        }
+        ranges[destination] = merged;
+
+        for (const SignalUse& use : useDefs.getUses(destination))
+        {
+            if (!queued[use.operation])
+            {
+                queued[use.operation] = 1;
+                worklist.push_back(use.operation);
+            }
+        }
+    }
+
+    // The narrowest instance that computes the same value for every input in range
+    for (size_t index = 0; index < count; ++index)
+    {
+        Opcode opcode = ops.getOpcode(index);
+        Evaluation eval;
+        if (opcode == Opcode::NONE || ops.isWiring(index, symbols) || evaluate(ops, index, symbols, widths, ranges, eval) != EvalStatus::OK)
+        {
+            continue; // A shift by a constant is wiring, which no narrower instance saves
+        }
+
+        int width;
+        if (getDescriptor(opcode).widthRule == WidthRule::LARGEST_INPUT) // A comparison reads the whole value of both inputs
+        {
+            width = max(minimalWidth(eval.inputs[1], eval.moduleSigned), minimalWidth(eval.inputs[2], eval.moduleSigned));
+        }
+        else
+        {
+            width = minimalWidth(eval.result, eval.moduleSigned);
+            if (opcode == Opcode::SHR) // The high bits of the input shift down into the result
+            {
+                width = max(width, minimalWidth(eval.inputs[1], false));
+            }
+            if (opcode == Opcode::SHR || opcode == Opcode::SHL) // The shift amount port is DATAWIDTH bits wide too
+            {
+                width = max(width, minimalWidth(eval.inputs[2], false));
+            }
+        }
+
+        int current = ops.getDataWidth(index, symbols);
+        if (width < current)
+        {
+            ops.setDataWidth(index, width);
+            savings.instances.push_back(NarrowedInstance{(uint32_t)index, current, width, ""});
+        }
+    }
+
+    describeInstances(savings, ops, symbols);
+    return;
+}
+
+static bool isInternalNet(const variableInfo& info) // A wire or register (declared with net type "reg"), which is not a port of the module
+{
+    return info.netType == WIRE || info.netType == "reg";
+}
+
+// DATAWIDTH an operation needs for the bits of its destination that are demanded
+static int demandedWidth(const OpList& ops, size_t index, int width, const vector<int>& widths, const vector<int>& demand)
+{
+    Opcode opcode = ops.getOpcode(index);
+    OperandRange operands = ops.getOperands(index);
+    if (operands.size() != operandCountOf(opcode) || getDescriptor(opcode).widthRule == WidthRule::LARGEST_INPUT) // A comparison reads its inputs whole
+    {
+        return width;
+    }
+
+    int needed = min(width, max(1, demand[operands[0]]));
+    if (opcode == Opcode::SHR || opcode == Opcode::SHL)
+    {
+        int amountBits = min(width, widths[operands[2]]); // Never truncate the shift amount more than the original instance does
+        if (opcode == Opcode::SHR) // Bits up to the largest shift amount above the demanded ones shift down into them
+        {
+            long long largestShift = amountBits >= 31 ? width : (1LL << amountBits) - 1;
+            needed = (int)min((long long)width, needed + largestShift);
+        }
+        needed = max(needed, amountBits);
+    }
+    return needed;
+}
+
+void trimDemandedBits(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, WidthSavings& savings)
+{
+    size_t count = ops.size();
+    vector<int> widths = declaredWidths(symbols, useDefs);
+
+    // Only wires and registers can be declared narrower; outputs (and anything else) are observed whole
+    vector<int> demand(symbols.size(), 0);
+    for (size_t id = 0; id < symbols.size(); ++id)
+    {
+        const variableInfo& info = symbols.getInfo((int)id);
+        if (!isInternalNet(info))
+        {
+            demand[id] = widths[id];
+        }
+    }
+
+    // The drivers of each net, chained through nextDriver
+    vector<int> firstDriver(symbols.size(), -1);
+    vector<int> nextDriver(count, -1);
+    vector<int> currentWidths(count, 0); // DATAWIDTH before this pass
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::NONE || ops.getOperands(index).size() == 0)
+        {
+            continue;
+        }
+        int destination = ops.getOperands(index)[0];
+        nextDriver[index] = firstDriver[destination];
+        firstDriver[destination] = (int)index;
+        currentWidths[index] = ops.getDataWidth(index, symbols);
+    }
+
+    // Visit every operation from the last to the first, then again each driver of a net whose demand grew
+    vector<uint32_t> worklist(count);
+    vector<uint8_t> queued(count, 1);
+    for (size_t index = 0; index < count; ++index)
+    {
+        worklist[index] = (uint32_t)(count - 1 - index);
+    }
+
+    for (size_t next = 0; next < worklist.size(); ++next)
+    {
+        size_t index = worklist[next];
+        queued[index] = 0;
+        Opcode opcode = ops.getOpcode(index);
+        OperandRange operands = ops.getOperands(index);
+        if (opcode == Opcode::NONE || operands.size() == 0)
+        {
+            continue;
+        }
+
+        bool wellFormed = operands.size() == operandCountOf(opcode);
+        int width = demandedWidth(ops, index, currentWidths[index], widths, demand);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            int input = operands[slot];
+            int demanded = !wellFormed ? widths[input] : opcode == Opcode::MUX && slot == 1 ? 1 : min(width, widths[input]); // A narrower input is zero-extended, so it is read whole
+            if (demanded <= demand[input])
+            {
+                continue;
+            }
+
+            demand[input] = demanded;
+            for (int driver = firstDriver[input]; driver >= 0; driver = nextDriver[driver])
+            {
+                if (!queued[driver])
+                {
+                    queued[driver] = 1;
+                    worklist.push_back((uint32_t)driver);
+                }
+            }
+        }
+    }
+
+    // Narrow the instances, merging with what minimizeDataWidths() recorded (both lists are in operation order)
+    vector<NarrowedInstance> instances;
+    size_t earlier = 0;
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::NONE || ops.getOperands(index).size() == 0)
+        {
+            continue;
+        }
+
+        int before = currentWidths[index];
+        int width = demandedWidth(ops, index, before, widths, demand);
+        ops.setDataWidth(index, width); // Even when unchanged, since the width rules would read the narrowed declarations below
+
+        while (earlier < savings.instances.size() && savings.instances[earlier].operation < index)
+        {
+            instances.push_back(savings.instances[earlier++]);
+        }
+        if (earlier < savings.instances.size() && savings.instances[earlier].operation == index)
+        {
+            before = savings.instances[earlier++].before;
+        }
+        if (width < before && !ops.isWiring(index, symbols)) // Wiring has no instance to narrow
+        {
+            instances.push_back(NarrowedInstance{(uint32_t)index, before, width, ""});
+        }
+    }
+    while (earlier < savings.instances.size())
+    {
+        instances.push_back(savings.instances[earlier++]);
+    }
+    savings.instances.swap(instances);
+
+    // Declare the wires and registers with their demanded bits (a net nothing reads keeps one)
+    for (size_t id = 0; id < symbols.size(); ++id)
+    {
+        variableInfo& info = symbols.getInfo((int)id);
+        int width = max(1, demand[id]);
+        if (isInternalNet(info) && width < widths[id])
+        {
+            savings.nets.push_back(NarrowedNet{(int)id, widths[id], width});
+            info.bitWidth = width;
+        }
+    }
+
+    describeInstances(savings, ops, symbols);
+    return;
+}
+
+size_t WidthSavings::savedInstanceBits() const
+{
+    size_t bits = 0;
+    for (const NarrowedInstance& instance : this->instances)
+    {
+        bits += (size_t)(instance.before - instance.after);
+    }
+    return bits;
+}
+
+size_t WidthSavings::savedNetBits() const
+{
+    size_t bits = 0;
+    for (const NarrowedNet& net : this->nets)
+    {
+        bits += (size_t)(net.before - net.after);
+    }
+    return bits;
+}
+
+void WidthSavings::clear()
+{
+    this->instances.clear();
+    this->nets.clear();
+    return;
+}
+
+void printWidthReport(ostream& out, const NetParser& netParser)
+{
+    const WidthSavings& savings = netParser.getWidthSavings();
+    const SymbolTable& symbols = netParser.getSymbols();
+
+    out << "Width minimization narrowed " << savings.instances.size() << " instances (" << savings.savedInstanceBits() << " bits) and "
+        << savings.nets.size() << " nets (" << savings.savedNetBits() << " bits)" << "\n";
+    if (netParser.getSchedule().scheduled && !savings.instances.empty()) // The instances below were replaced by the shared units
+    {
+        out << "\tInstances as named before --resources bound them to shared units, each as wide as the widest of its operations" << "\n";
+    }
+
+    for (const NarrowedInstance& instance : savings.instances)
+    {
+        out << "\t" << instance.description << ": " << instance.before << " -> " << instance.after
+            << " bits (saves " << instance.before - instance.after << ")" << "\n";
+    }
+
+    for (const NarrowedNet& net : savings.nets)
+    {
+        out << "\t" << symbols.getInfo(net.symbol).netType << " " << symbols.getName(net.symbol) << ": " << net.before << " -> " << net.after
+            << " bits (saves " << net.before - net.after << ")" << "\n";
+    }
+    out.flush();
+    return;
+}
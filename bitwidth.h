@@ -0,0 +1,79 @@
+#ifndef BITWIDTH_H
+#define BITWIDTH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+class OpList;
+class SymbolTable;
+class UseDefIndex;
+class NetParser;
+
+// An instance given a smaller DATAWIDTH
+struct NarrowedInstance
+{
+    uint32_t operation; // Index in the operation list when it was narrowed
+    int before; // DATAWIDTH given by the width rule
+    int after;
+    string description; // e.g., "ADD3 (d = a + b)", kept since later passes (--retime, --resources) rewrite the operation list
+};
+
+// A wire or register declared with fewer bits
+struct NarrowedNet
+{
+    int symbol;
+    int before; // Declared width
+    int after;
+};
+
+// What the width passes of a conversion saved
+struct WidthSavings
+{
+    vector<NarrowedInstance> instances; // In operation order
+    vector<NarrowedNet> nets; // In symbol order
+
+    size_t savedInstanceBits() const; // DATAWIDTH bits the instances no longer have
+    size_t savedNetBits() const; // Bits the declarations no longer have
+    void clear();
+};
+
+/*
+    Forward value-range analysis. Every net gets the interval of the values it can hold, starting from the
+    declared range of the inputs (and of nets that nothing drives) and propagated through the operations the
+    way the emitted instances compute them: a narrower net is zero-extended into a wider port, a wider one is
+    truncated, the result wraps at DATAWIDTH, and a comparator drives 0 or 1. Registers also hold 0 after a reset.
+    Each operation is evaluated once in netlist order and again whenever the interval of one of its inputs grows;
+    a net that keeps growing (a loop through a register) is widened to its declared range.
+
+    Each instance then gets the smallest DATAWIDTH whose result, extended back to its destination, is the
+    same for every value in range: the low bits of a sum, difference, product, left shift, or selection only
+    depend on the low bits of the inputs, so only the result has to fit. A right shift also needs its input
+    to fit, a shift its shift amount, and a comparator both of its inputs. Nets wider than 64 bits are left alone
+*/
+void minimizeDataWidths(OpList& ops, const SymbolTable& symbols, const UseDefIndex& useDefs, WidthSavings& savings);
+
+/*
+    Backward demanded-bits analysis. Outputs demand all of their bits; every other net demands the low bits
+    that some reader observes, walking from the outputs through the registers toward the inputs. An ADD, SUB,
+    MUL, SHL, MUX, or REG only needs as many bits as its destination demands, and then demands that many low
+    bits of its inputs. A right shift needs as many more bits as its shift amount can move down, a shift keeps
+    its whole shift amount, a MUX demands one bit of its select, and a comparator demands its inputs whole.
+    Drivers are revisited whenever the demand on their net grows, so loops through registers settle.
+
+    Each instance is then narrowed to the bits its destination demands, and each wire and register is
+    declared with only its demanded bits. Run after minimizeDataWidths(), which needs the declared widths
+*/
+void trimDemandedBits(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, WidthSavings& savings);
+
+void printWidthReport(ostream& out, const NetParser& netParser); // The instances and nets the width passes of the last conversion narrowed
+
+#endif
@@ -0,0 +1,213 @@
+#include "cache.h"
+#include "emitter.h"
+#include "lexer.h"
+#include "parser.h"
+#include "dpir.h"
+
+#include <cstdlib> // Provides getenv()
+#include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
+#include <atomic>
+#include <thread>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+namespace fs = filesystem;
+
+const uint64_t FNV_OFFSET = 1469598103934665603ULL; // FNV-1a 64-bit offset basis
+const uint64_t FNV_PRIME = 1099511628211ULL; // FNV-1a 64-bit prime
+const char CACHE_ENTRY_FORMAT[] = "2"; // Part of every key, so entries of an older layout are never read
+
+static uint64_t hashBytes(uint64_t hash, string_view bytes) // Continue an FNV-1a hash over more bytes
+{
+    for (unsigned char c : bytes)
+    {
+        hash ^= c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool isSpace(char c) // Same whitespace set that the netlist reader trims
+{
+    return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\n' || c == '\r';
+}
+
+uint64_t hashNetlist(string_view netlistText)
+{
+    uint64_t hash = FNV_OFFSET;
+
+    while (!netlistText.empty())
+    {
+        size_t end = netlistText.find('\n');
+        string_view line = netlistText.substr(0, end);
+        netlistText.remove_prefix(end == string_view::npos ? netlistText.size() : end + 1);
+
+        // Trim the line
+        while (!line.empty() && isSpace(line.front()))
+        {
+            line.remove_prefix(1);
+        }
+        while (!line.empty() && isSpace(line.back()))
+        {
+            line.remove_suffix(1);
+        }
+
+        if (line.empty()) // Blank lines do not change the conversion
+        {
+            continue;
+        }
+
+        /*
+            Comment lines are hashed like any other line: "//" marks an error in the netlist,
+            so removing one changes the result of the conversion
+        */
+        hash = hashBytes(hash, line);
+        hash = hashBytes(hash, "\n");
+    }
+
+    return hash;
+}
+
+static string toHex(uint64_t value) // e.g., 255 -> "00000000000000ff"
+{
+    const char* digits = "0123456789abcdef";
+    string hex(16, '0');
+
+    for (int i = 15; i >= 0; --i)
+    {
+        hex[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+    return hex;
+}
+
+string ConversionCache::makeKey(string_view netlistText, const string& moduleName, const string& optionsFingerprint) const
+{
+    uint64_t settings = FNV_OFFSET; // Everything besides the netlist that changes the output
+
+    settings = hashBytes(settings, DPGEN_VERSION);
+    settings = hashBytes(settings, string_view("\0", 1));
+    settings = hashBytes(settings, CACHE_ENTRY_FORMAT);
+    settings = hashBytes(settings, string_view("\0", 1));
+    settings = hashBytes(settings, moduleName);
+    settings = hashBytes(settings, string_view("\0", 1));
+    settings = hashBytes(settings, optionsFingerprint);
+
+    // A precompiled netlist is binary, where the whitespace that hashNetlist() skips is part of the data
+    uint64_t netlist = NetlistImage::isImage(netlistText) ? hashBytes(FNV_OFFSET, netlistText) : hashNetlist(netlistText);
+
+    return toHex(netlist) + toHex(settings);
+}
+
+string ConversionCache::entryPath(const string& key) const // e.g., "<directory>/3f/3f8a....entry"
+{
+    return (fs::path(this->directory) / key.substr(0, 2) / (key + ".entry")).string();
+}
+
+/*
+    An entry is the length of the report on its own line, then the report, then the Verilog (e.g., "0\n`timescale...")
+*/
+bool ConversionCache::lookup(const string& key, string& verilogText, string& reportText) const
+{
+    MappedFile entry(this->entryPath(key));
+
+    if (!entry.isOpen())
+    {
+        return false;
+    }
+
+    string_view text = entry.text();
+    size_t newline = text.find('\n');
+    if (newline == string_view::npos || newline == 0 || newline > 20)
+    {
+        return false; // Not an entry of this layout, so the conversion runs and stores it again
+    }
+    size_t reportSize = 0;
+    for (char c : text.substr(0, newline))
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        reportSize = reportSize * 10 + (size_t)(c - '0');
+    }
+    text.remove_prefix(newline + 1);
+    if (reportSize > text.size())
+    {
+        return false; // Cut short
+    }
+
+    reportText.assign(text.substr(0, reportSize));
+    verilogText.assign(text.substr(reportSize));
+    return true;
+}
+
+void ConversionCache::store(const string& key, const string& verilogText, const string& reportText) const
+{
+    static atomic<unsigned> counter(0); // Keeps the temporary names of concurrent stores apart
+    error_code ec;
+    fs::path path = this->entryPath(key);
+
+    fs::create_directories(path.parent_path(), ec);
+    if (ec)
+    {
+        return;
+    }
+
+    // Write a temporary file first and rename it, so a reader never sees a half-written entry
+    fs::path temporary = path;
+    temporary += ".tmp" + to_string(hash<thread::id>()(this_thread::get_id())) + "_" + to_string(counter.fetch_add(1));
+
+    string contents = to_string(reportText.size()) + "\n";
+    contents.reserve(contents.size() + reportText.size() + verilogText.size());
+    contents.append(reportText).append(verilogText);
+    if (!writeWholeFile(temporary.string(), contents))
+    {
+        fs::remove(temporary, ec);
+        return;
+    }
+
+    fs::rename(temporary, path, ec);
+    if (ec)
+    {
+        fs::remove(temporary, ec);
+    }
+    return;
+}
+
+string defaultCacheDirectory()
+{
+    if (const char* dir = getenv("DPGEN_CACHE_DIR"))
+    {
+        return dir;
+    }
+    if (const char* dir = getenv("XDG_CACHE_HOME"))
+    {
+        return (fs::path(dir) / "dpgen").string();
+    }
+    if (const char* dir = getenv("HOME"))
+    {
+        return (fs::path(dir) / ".cache" / "dpgen").string();
+    }
+    return ".dpgen-cache";
+}
+
+bool writeFileIfChanged(const string& path, const string& contents)
+{
+    {
+        error_code ec;
+        if (fs::file_size(path, ec) == contents.size() && !ec) // Only files of the same size can be identical
+        {
+            MappedFile existing(path);
+            if (existing.isOpen() && existing.text() == contents)
+            {
+                return true; // Already up to date, so keep its mtime for downstream tools
+            }
+        }
+    }
+
+    return writeWholeFile(path, contents);
+}
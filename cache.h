@@ -0,0 +1,49 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    Hash the netlist the way the reader sees it: blank lines and leading/trailing whitespace of each line
+    do not change the result, so they do not change the hash either
+*/
+uint64_t hashNetlist(string_view netlistText);
+
+/*
+    Content-addressed store of generated Verilog, with the report the conversion printed. The key covers the normalized
+    netlist (a precompiled image byte for byte), the dpgen version, the module name, and the options that change the output, so a hit can skip parsing entirely
+*/
+class ConversionCache
+{
+    private:
+        string directory; // Root directory of the cache entries
+
+        string entryPath(const string& key) const;
+
+    public:
+
+        // Parameterized Constructor
+        explicit ConversionCache(const string& directory)
+        {
+            this->directory = directory;
+        }
+
+        string makeKey(string_view netlistText, const string& moduleName, const string& optionsFingerprint) const;
+
+        bool lookup(const string& key, string& verilogText, string& reportText) const; // Return false on a miss
+        void store(const string& key, const string& verilogText, const string& reportText) const; // Failures are ignored, the cache is only an accelerator
+};
+
+string defaultCacheDirectory(); // $DPGEN_CACHE_DIR, else $XDG_CACHE_HOME/dpgen, else $HOME/.cache/dpgen
+
+bool writeFileIfChanged(const string& path, const string& contents); // Leave the file (and its mtime) alone when it already holds contents
+
+#endif
@@ -0,0 +1,348 @@
+#include "checker.h"
+
+#include <algorithm> // Provides stable_sort()
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+static string quoted(string_view name) // e.g., "'a'"
+{
+    string text = "'";
+    text.append(name).append("'");
+    return text;
+}
+
+static bool isIdentifier(string_view name) // [A-Za-z_][A-Za-z0-9_]*, the names that are also valid Verilog identifiers
+{
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9'))
+    {
+        return false;
+    }
+    for (char c : name)
+    {
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        if (!letter && !(c >= '0' && c <= '9'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NetlistChecker::report(Severity severity, const NetLine& line, string_view at, string message)
+{
+    int column = 1;
+    if (at.data() != nullptr && at.data() >= line.text.data() && at.data() <= line.text.data() + line.text.size())
+    {
+        column = (int)(at.data() - line.text.data()) + 1;
+    }
+    this->diagnostics.push_back(Diagnostic{severity, line.number, column, move(message)});
+    return;
+}
+
+int NetlistChecker::symbolOf(string_view name)
+{
+    int id = this->symbols.intern(name);
+    if ((size_t)id >= this->facts.size())
+    {
+        this->facts.resize(id + 1);
+    }
+    return id;
+}
+
+const vector<Diagnostic>& NetlistChecker::check(string_view netlistText)
+{
+    NetLexer lexer(netlistText);
+    NetLine line;
+
+    while (lexer.nextLine(line))
+    {
+        this->checkLine(line);
+    }
+
+    this->checkWholeNetlist();
+
+    stable_sort(this->diagnostics.begin(), this->diagnostics.end(), [](const Diagnostic& a, const Diagnostic& b)
+    {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+    return this->diagnostics;
+}
+
+size_t NetlistChecker::count(Severity severity) const
+{
+    size_t total = 0;
+    for (const Diagnostic& diagnostic : this->diagnostics)
+    {
+        total += diagnostic.severity == severity;
+    }
+    return total;
+}
+
+void NetlistChecker::checkLine(const NetLine& line)
+{
+    if (line.kind == LineKind::COMMENT) // The converter rejects the whole netlist here, and the code before the "//" is checked as well
+    {
+        size_t commentPos = line.text.find("//");
+        string_view comment = line.comment;
+        while (!comment.empty() && (comment.front() == ' ' || comment.front() == '\t'))
+        {
+            comment.remove_prefix(1);
+        }
+        while (!comment.empty() && (comment.back() == ' ' || comment.back() == '\t' || comment.back() == '\r'))
+        {
+            comment.remove_suffix(1);
+        }
+
+        this->report(Severity::ERROR, line, line.text.substr(commentPos), comment.empty() ? "line is marked as an error by a comment" : "line is marked as an error by a comment: " + string(comment));
+
+        NetLexer code(line.text.substr(0, commentPos));
+        NetLine codeLine;
+        if (code.nextLine(codeLine))
+        {
+            codeLine.number = line.number;
+            this->checkLine(codeLine);
+        }
+        return;
+    }
+
+    if (line.kind == LineKind::OPERATION)
+    {
+        this->checkOperation(line);
+    }
+    else
+    {
+        this->checkDeclaration(line);
+    }
+    return;
+}
+
+void NetlistChecker::checkDeclaration(const NetLine& line)
+{
+    if (line.tokenCount < 2)
+    {
+        this->report(Severity::ERROR, line, line.tokens[0], "declaration has no type (expected Int<N> or UInt<N>)");
+        return;
+    }
+
+    char signType;
+    int bitWidth = 0;
+    string_view type = line.tokens[1];
+    if (!parseTypeToken(type, signType, bitWidth))
+    {
+        this->report(Severity::ERROR, line, type, "malformed type " + quoted(type) + " (expected Int<N> or UInt<N>)");
+        bitWidth = 0;
+    }
+    else if (bitWidth <= 0 || (bitWidth & (bitWidth - 1)) != 0)
+    {
+        this->report(Severity::ERROR, line, type, "width " + to_string(bitWidth) + " of " + quoted(type) + " is not a power of two");
+        bitWidth = 0;
+    }
+
+    if (line.tokenCount < 3)
+    {
+        this->report(Severity::ERROR, line, type, "declaration has no variables");
+        return;
+    }
+
+    string_view varList = line.varList;
+    string_view name;
+    while (nextVarName(varList, name))
+    {
+        if (!isIdentifier(name))
+        {
+            this->report(Severity::ERROR, line, name, "invalid variable name " + quoted(name));
+            continue;
+        }
+
+        int id = this->symbolOf(name);
+        SymbolFacts& fact = this->facts[id];
+        if (fact.declaredLine != 0)
+        {
+            this->report(Severity::ERROR, line, name, quoted(name) + " is already declared at line " + to_string(fact.declaredLine));
+            continue;
+        }
+
+        fact.declaredLine = line.number;
+        fact.declaredColumn = (int)(name.data() - line.text.data()) + 1;
+        fact.bitWidth = bitWidth;
+        fact.kind = line.kind;
+    }
+    return;
+}
+
+void NetlistChecker::checkOperation(const NetLine& line)
+{
+    const char* shapes = "expected 'x = a', 'x = a op b', or 'x = sel ? a : b'";
+
+    if (line.tokenCount > MAX_LINE_TOKENS || (line.tokenCount != 3 && line.tokenCount != 5 && line.tokenCount != 7))
+    {
+        this->report(Severity::ERROR, line, line.tokens[0], string("malformed operation (") + shapes + ")");
+        return;
+    }
+    if (line.tokens[1] != "=")
+    {
+        this->report(Severity::ERROR, line, line.tokens[1], "expected '=' after " + quoted(line.tokens[0]));
+        return;
+    }
+
+    CheckedOp op;
+    op.line = line.number;
+    string_view names[MAX_OPERANDS];
+    size_t nameCount = 0;
+
+    if (line.tokenCount == 3) // x = a
+    {
+        op.opcode = Opcode::REG;
+        names[nameCount++] = line.tokens[0];
+        names[nameCount++] = line.tokens[2];
+    }
+    else if (line.tokenCount == 5) // x = a op b
+    {
+        op.opcode = Opcode::NONE;
+        for (int code = 0; code < OPCODE_COUNT; ++code)
+        {
+            if ((Opcode)code != Opcode::MUX && (Opcode)code != Opcode::REG && line.tokens[3] == OP_DESCRIPTORS[code].symbol)
+            {
+                op.opcode = (Opcode)code;
+            }
+        }
+        if (op.opcode == Opcode::NONE)
+        {
+            this->report(Severity::ERROR, line, line.tokens[3], "unknown operator " + quoted(line.tokens[3]) + " (expected +, -, *, >, <, ==, >>, or <<)");
+            return;
+        }
+        names[nameCount++] = line.tokens[0];
+        names[nameCount++] = line.tokens[2];
+        names[nameCount++] = line.tokens[4];
+    }
+    else // x = sel ? a : b
+    {
+        if (line.tokens[3] != "?" || line.tokens[5] != ":")
+        {
+            this->report(Severity::ERROR, line, line.tokens[3] != "?" ? line.tokens[3] : line.tokens[5], "malformed multiplexer (expected 'x = sel ? a : b')");
+            return;
+        }
+        op.opcode = Opcode::MUX;
+        names[nameCount++] = line.tokens[0];
+        names[nameCount++] = line.tokens[2];
+        names[nameCount++] = line.tokens[4];
+        names[nameCount++] = line.tokens[6];
+    }
+
+    op.operandCount = (uint8_t)nameCount;
+    for (size_t i = 0; i < nameCount; ++i)
+    {
+        op.ids[i] = this->symbolOf(names[i]);
+        op.columns[i] = (int)(names[i].data() - line.text.data()) + 1;
+
+        if (names[i][0] < '0' || names[i][0] > '9') // A name never starts with a digit, so anything else is an integer literal
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            this->report(Severity::ERROR, line, names[i], "cannot assign to the literal " + quoted(names[i]));
+            return;
+        }
+        uint64_t value = 0;
+        if (!parseLiteral(names[i], value))
+        {
+            this->report(Severity::ERROR, line, names[i], "literal " + quoted(names[i]) + " is not a decimal integer of at most 64 bits");
+            return;
+        }
+        SymbolFacts& fact = this->facts[op.ids[i]];
+        fact.literal = true;
+        fact.bitWidth = getLiteralWidth(value);
+    }
+
+    SymbolFacts& output = this->facts[op.ids[0]];
+    if (output.assignedLine != 0)
+    {
+        this->report(Severity::WARNING, line, names[0], quoted(names[0]) + " is also assigned at line " + to_string(output.assignedLine) + " (the instances would drive the same net)");
+    }
+    else
+    {
+        output.assignedLine = line.number;
+    }
+
+    this->ops.push_back(op);
+    return;
+}
+
+void NetlistChecker::checkWholeNetlist()
+{
+    vector<bool> reported(this->facts.size(), false); // Report each undeclared name once, at its first use
+
+    for (const CheckedOp& op : this->ops)
+    {
+        Diagnostic at{Severity::ERROR, op.line, 0, ""};
+
+        for (size_t i = 0; i < op.operandCount; ++i)
+        {
+            int id = op.ids[i];
+            if (this->facts[id].declaredLine == 0 && !this->facts[id].literal && !reported[id])
+            {
+                reported[id] = true;
+                at.column = op.columns[i];
+                at.message = quoted(this->symbols.getName(id)) + " is not declared";
+                this->diagnostics.push_back(at);
+            }
+        }
+
+        const SymbolFacts& output = this->facts[op.ids[0]];
+        if (output.kind == LineKind::INPUT_DECL)
+        {
+            at.column = op.columns[0];
+            at.message = "assigns to input " + quoted(this->symbols.getName(op.ids[0]));
+            this->diagnostics.push_back(at);
+        }
+
+        // An arithmetic result, a multiplexer, a shift, or a register narrower than its data inputs drops their upper bits
+        if (output.bitWidth == 0 || getDescriptor(op.opcode).widthRule != WidthRule::OUTPUT_WIDTH)
+        {
+            continue;
+        }
+        for (size_t i = 1; i < op.operandCount; ++i)
+        {
+            if ((op.opcode == Opcode::MUX && i == 1) || ((op.opcode == Opcode::SHR || op.opcode == Opcode::SHL) && i == 2)) // Select and shift amount
+            {
+                continue;
+            }
+
+            int width = this->facts[op.ids[i]].bitWidth;
+            if (width > output.bitWidth)
+            {
+                at.severity = Severity::WARNING;
+                at.column = op.columns[i];
+                at.message = quoted(this->symbols.getName(op.ids[i])) + " (" + to_string(width) + " bits) is truncated to the " +
+                             to_string(output.bitWidth) + " bits of " + quoted(this->symbols.getName(op.ids[0]));
+                this->diagnostics.push_back(at);
+                at.severity = Severity::ERROR;
+            }
+        }
+    }
+
+    for (size_t id = 0; id < this->facts.size(); ++id)
+    {
+        const SymbolFacts& fact = this->facts[id];
+        if (fact.kind == LineKind::OUTPUT_DECL && fact.assignedLine == 0)
+        {
+            this->diagnostics.push_back(Diagnostic{Severity::WARNING, fact.declaredLine, fact.declaredColumn, "output " + quoted(this->symbols.getName((int)id)) + " is never assigned"});
+        }
+    }
+    return;
+}
+
+void printDiagnostics(ostream& out, const string& fileName, const vector<Diagnostic>& diagnostics)
+{
+    for (const Diagnostic& diagnostic : diagnostics)
+    {
+        out << fileName << ":" << diagnostic.line << ":" << diagnostic.column << ": "
+            << (diagnostic.severity == Severity::ERROR ? "error" : "warning") << ": " << diagnostic.message << "\n";
+    }
+    return;
+}
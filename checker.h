@@ -0,0 +1,89 @@
+#ifndef CHECKER_H
+#define CHECKER_H
+
+#include "parser.h"
+#include "lexer.h"
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+enum class Severity : uint8_t
+{
+    WARNING, // The netlist converts, but probably not into what was meant
+    ERROR // The netlist is rejected, or converts into invalid Verilog
+};
+
+// One finding of the checker, located at a line and column of the netlist (both start from 1)
+struct Diagnostic
+{
+    Severity severity;
+    int line;
+    int column;
+    string message;
+};
+
+/*
+    Lints a behavioral netlist without generating Verilog (dpgen --check). The text is lexed once; declarations
+    and operations are checked as they are read, and every check that needs the whole netlist (undeclared
+    operands, widths, assignments to inputs, unassigned outputs) runs afterwards over the compact list of
+    operations that the pass recorded. Every problem is collected instead of stopping at the first
+*/
+class NetlistChecker
+{
+    private:
+        // Everything the final checks need to know about one operation
+        struct CheckedOp
+        {
+            Opcode opcode;
+            int line;
+            uint8_t operandCount;
+            int ids[MAX_OPERANDS]; // Symbol IDs, operand 0 is the output (same order as OpList)
+            int columns[MAX_OPERANDS]; // Column of each operand token
+        };
+
+        // What the pass learned about one symbol
+        struct SymbolFacts
+        {
+            int declaredLine = 0; // 0 while undeclared
+            int declaredColumn = 0;
+            int bitWidth = 0; // 0 when the type was malformed
+            LineKind kind = LineKind::OPERATION; // Declaration kind (INPUT_DECL, ...), OPERATION while undeclared
+            int assignedLine = 0; // First operation that assigns it, 0 if none
+            bool literal = false; // An integer literal operand, which needs no declaration
+        };
+
+        Arena arena; // Storage of the names
+        SymbolTable symbols;
+        vector<SymbolFacts> facts; // Indexed by symbol ID
+        vector<CheckedOp> ops;
+        vector<Diagnostic> diagnostics;
+
+        void report(Severity severity, const NetLine& line, string_view at, string message); // at is a view into line.text
+        int symbolOf(string_view name); // Intern the name and make room for its facts
+        void checkLine(const NetLine& line);
+        void checkDeclaration(const NetLine& line);
+        void checkOperation(const NetLine& line);
+        void checkWholeNetlist(); // The checks that need every declaration
+
+    public:
+
+        // Default Constructor
+        NetlistChecker() : symbols(&arena)
+        {
+        }
+
+        const vector<Diagnostic>& check(string_view netlistText); // Diagnostics sorted by line and column
+        size_t count(Severity severity) const;
+};
+
+void printDiagnostics(ostream& out, const string& fileName, const vector<Diagnostic>& diagnostics); // As "file:line:column: error: message"
+
+#endif
@@ -0,0 +1,161 @@
+#include "cse.h"
+
+#include <algorithm> // Provides swap()
+#include <unordered_map>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// Everything that decides the value an operation computes and the instance it becomes
+struct ExpressionKey
+{
+    Opcode opcode;
+    char moduleSign; // 's' when the signed module variant is emitted
+    char destinationSign; // Sign type of the destination
+    int dataWidth; // DATAWIDTH of the instance
+    int destinationWidth; // Width of the destination
+    bool select; // The destination is a wire read as a MUX select, which printWire() declares with one bit
+    int inputs[3]; // Symbol IDs of the inputs (unused slots are -1)
+
+    bool operator==(const ExpressionKey& other) const
+    {
+        return this->opcode == other.opcode && this->moduleSign == other.moduleSign && this->destinationSign == other.destinationSign &&
+               this->dataWidth == other.dataWidth && this->destinationWidth == other.destinationWidth && this->select == other.select &&
+               this->inputs[0] == other.inputs[0] && this->inputs[1] == other.inputs[1] && this->inputs[2] == other.inputs[2];
+    }
+};
+
+struct ExpressionKeyHash
+{
+    size_t operator()(const ExpressionKey& key) const // Mix the fields with the 64-bit FNV-1a prime
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        int64_t fields[] = { (int64_t)key.opcode, key.moduleSign, key.destinationSign, key.dataWidth, key.destinationWidth, key.select, key.inputs[0], key.inputs[1], key.inputs[2] };
+
+        for (int64_t field : fields)
+        {
+            hash ^= (uint64_t)field;
+            hash *= 1099511628211ULL;
+        }
+        return (size_t)(hash ^ (hash >> 29));
+    }
+};
+
+static bool isCommutative(Opcode opcode)
+{
+    return opcode == Opcode::ADD || opcode == Opcode::MUL || opcode == Opcode::EQ;
+}
+
+size_t eliminateCommonSubexpressions(OpList& ops, const SymbolTable& symbols)
+{
+    size_t count = ops.size();
+    size_t removed = 0;
+
+    // Nets driven more than once keep every driver, since the copies would not agree on a single value
+    vector<uint8_t> driverCount(symbols.size(), 0);
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) != Opcode::NONE)
+        {
+            uint8_t& drivers = driverCount[ops.getOperands(index)[0]];
+            drivers = drivers < 2 ? drivers + 1 : 2;
+        }
+    }
+
+    /*
+        A wire read as a MUX select is declared with one bit, which its other readers see as well. Merging it with a copy
+        that is only read as data would narrow the readers of one of them, so such destinations only merge with each other
+    */
+    vector<uint8_t> readAsSelect(symbols.size(), 0);
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::MUX && ops.getOperands(index).size() == 4)
+        {
+            readAsSelect[ops.getOperands(index)[1]] = 1;
+        }
+    }
+
+    vector<int> replacement(symbols.size(), -1); // Destination of the kept copy for each dropped destination
+    unordered_map<ExpressionKey, size_t, ExpressionKeyHash> firstCopy; // First operation computing each expression
+    firstCopy.reserve(count);
+
+    auto rewriteInputs = [&](size_t index) // Point the inputs of an operation at the kept copies
+    {
+        OperandRange operands = ops.getOperands(index);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            int kept = replacement[operands[slot]];
+            if (kept >= 0)
+            {
+                ops.setOperand(index, slot, kept);
+            }
+        }
+    };
+
+    /*
+        One pass in netlist order. Inputs are rewritten before the key is built, so a chain of copies
+        (x1 = a + b, x2 = a + b, y1 = x1 + c, y2 = x2 + c) collapses in the same pass
+    */
+    for (size_t index = 0; index < count; ++index)
+    {
+        Opcode opcode = ops.getOpcode(index);
+        if (opcode == Opcode::NONE)
+        {
+            continue;
+        }
+
+        rewriteInputs(index);
+
+        OperandRange operands = ops.getOperands(index);
+        int destination = operands[0];
+        const variableInfo& destinationInfo = symbols.getInfo(destination);
+
+        if (opcode == Opcode::REG || destinationInfo.netType == "output" || driverCount[destination] != 1 || operands.size() > 4)
+        {
+            continue;
+        }
+
+        const OpDescriptor& desc = getDescriptor(opcode);
+        ExpressionKey key;
+        key.opcode = opcode;
+        key.moduleSign = (desc.signedModule != nullptr && isSigned(operands, symbols)) ? 's' : 'u';
+        key.destinationSign = destinationInfo.signType;
+        key.dataWidth = ops.getDataWidth(index, symbols);
+        key.destinationWidth = destinationInfo.bitWidth;
+        key.select = destinationInfo.netType == WIRE && readAsSelect[destination];
+        key.inputs[0] = key.inputs[1] = key.inputs[2] = -1;
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            key.inputs[slot - 1] = operands[slot];
+        }
+        if (isCommutative(opcode) && key.inputs[0] > key.inputs[1])
+        {
+            swap(key.inputs[0], key.inputs[1]);
+        }
+
+        auto found = firstCopy.emplace(key, index);
+        if (!found.second) // Computed before, so reuse the earlier destination
+        {
+            replacement[destination] = ops.getOperands(found.first->second)[0];
+            ops.setOpcode(index, Opcode::NONE);
+            removed++;
+        }
+    }
+
+    // Readers that come before the copy they read (the netlist does not have to be in dataflow order)
+    if (removed != 0)
+    {
+        for (size_t index = 0; index < count; ++index)
+        {
+            if (ops.getOpcode(index) != Opcode::NONE)
+            {
+                rewriteInputs(index);
+            }
+        }
+    }
+
+    return removed;
+}
@@ -0,0 +1,22 @@
+#ifndef CSE_H
+#define CSE_H
+
+#include "parser.h"
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    Common subexpression elimination. Operations with the same opcode, inputs, DATAWIDTH, signedness, and
+    destination type compute the same value, so every copy after the first is dropped (set to Opcode::NONE)
+    and its readers are rewired to the first copy's destination. The inputs of ADD, MUL, and == are compared
+    in either order. Registers, outputs, and nets with more than one driver are never merged, and a wire read as a
+    MUX select (declared with one bit) is only merged with another one.
+    Return the number of instances removed
+*/
+size_t eliminateCommonSubexpressions(OpList& ops, const SymbolTable& symbols);
+
+#endif
@@ -0,0 +1,560 @@
+#include "dataflow.h"
+
+#include <algorithm> // Provides reverse(), max(), and min()
+#include <cstdio> // Provides snprintf()
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+bool DataflowGraph::isCombinational(int operation) const
+{
+    Opcode opcode = this->ops->getOpcode((size_t)operation);
+    return opcode != Opcode::NONE && opcode != Opcode::REG;
+}
+
+int DataflowGraph::launchingDriver(int symbol) const
+{
+    const string& netType = this->symbols->getInfo(symbol).netType;
+
+    if (netType == "input" || netType == "output") // Paths are cut at the ports of the module
+    {
+        return -1;
+    }
+    return this->drivers[symbol];
+}
+
+void DataflowGraph::build(const OpList& ops, const SymbolTable& symbols)
+{
+    size_t count = ops.size();
+
+    this->ops = &ops;
+    this->symbols = &symbols;
+    this->drivers.assign(symbols.size(), -1);
+    this->delays.assign(count, 0);
+    this->areas.assign(count, 0);
+    this->instanceNumbers.assign(count, 0);
+
+    // Find the driver of every net, and the delay, area, and instance name of every operation
+    int instanceCounts[COUNTER_COUNT] = {};
+    for (size_t index = 0; index < count; ++index)
+    {
+        Opcode opcode = ops.getOpcode(index);
+        if (opcode == Opcode::NONE) // Not emitted, so it drives nothing
+        {
+            continue;
+        }
+
+        const OpDescriptor& desc = getDescriptor(opcode);
+        OperandRange operands = ops.getOperands(index);
+
+        this->drivers[operands[0]] = (int)index; // Operand 0 is the output (a later assignment overrides an earlier one, as in the emitted module)
+        if (ops.isWiring(index, symbols)) // An assign of bits, which takes no time, no area, and no instance name
+        {
+            continue;
+        }
+
+        int dataWidth = ops.getDataWidth(index, symbols);
+        bool signType = isSigned(operands, symbols); // The library charges a shift as its unsigned module, the only one emitted
+        this->delays[index] = componentDelay(opcode, dataWidth, signType);
+        this->areas[index] = componentArea(opcode, dataWidth, signType);
+        this->instanceNumbers[index] = ++instanceCounts[desc.counter];
+    }
+
+    // Count the combinational successors of every operation, then place them (a counting sort, so no per-node vectors)
+    this->successorStart.assign(count + 1, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        vector<uint32_t> fill; // Next free slot of each operation in the second pass
+        if (pass == 1)
+        {
+            for (size_t index = 0; index < count; ++index)
+            {
+                this->successorStart[index + 1] += this->successorStart[index];
+            }
+            this->successors.assign(this->successorStart[count], -1);
+            fill.assign(this->successorStart.begin(), this->successorStart.end() - 1);
+        }
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            if (ops.getOpcode(index) == Opcode::NONE)
+            {
+                continue;
+            }
+
+            OperandRange operands = ops.getOperands(index);
+            for (size_t i = 1; i < operands.size(); ++i)
+            {
+                int driver = this->launchingDriver(operands[i]);
+                if (driver < 0 || !this->isCombinational(driver)) // Registers launch new paths, so they have no outgoing edges
+                {
+                    continue;
+                }
+
+                if (pass == 0)
+                {
+                    this->successorStart[driver + 1]++;
+                }
+                else
+                {
+                    this->successors[fill[driver]++] = (int)index;
+                }
+            }
+        }
+    }
+
+    return;
+}
+
+size_t DataflowGraph::size() const
+{
+    return this->delays.size();
+}
+
+size_t DataflowGraph::edgeCount() const
+{
+    return this->successors.size();
+}
+
+int DataflowGraph::getDriver(int symbol) const
+{
+    return this->drivers[symbol];
+}
+
+double DataflowGraph::getDelay(size_t operation) const
+{
+    return this->delays[operation];
+}
+
+// Kahn's algorithm: an operation is ready once every combinational operation feeding it is done
+bool DataflowGraph::sortTopologically(vector<int>& order, vector<uint32_t>& pending) const
+{
+    size_t count = this->size();
+
+    pending.assign(count, 0);
+    for (int successor : this->successors)
+    {
+        pending[successor]++;
+    }
+
+    order.clear();
+    order.reserve(count);
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (pending[index] == 0)
+        {
+            order.push_back((int)index);
+        }
+    }
+    for (size_t next = 0; next < order.size(); ++next)
+    {
+        int operation = order[next];
+        for (uint32_t e = this->successorStart[operation]; e < this->successorStart[operation + 1]; ++e)
+        {
+            if (--pending[this->successors[e]] == 0)
+            {
+                order.push_back(this->successors[e]);
+            }
+        }
+    }
+
+    return order.size() == count;
+}
+
+bool DataflowGraph::topologicalOrder(vector<int>& order) const
+{
+    vector<uint32_t> pending;
+    return this->sortTopologically(order, pending);
+}
+
+TimingReport DataflowGraph::analyzeTiming() const
+{
+    TimingReport report;
+    size_t count = this->size();
+
+    vector<uint32_t> pending; // Unfinished predecessors of each operation
+    vector<int> order; // Topological order
+    if (!this->sortTopologically(order, pending)) // The operations never released lie on or behind a combinational loop
+    {
+        report.hasLoop = true;
+
+        // Walk backwards through unfinished operations; within at most count steps the walk repeats an operation
+        vector<int> unfinishedPredecessor(count, -1);
+        for (size_t index = 0; index < count; ++index)
+        {
+            if (pending[index] == 0)
+            {
+                continue;
+            }
+            for (uint32_t e = this->successorStart[index]; e < this->successorStart[index + 1]; ++e)
+            {
+                if (pending[this->successors[e]] != 0)
+                {
+                    unfinishedPredecessor[this->successors[e]] = (int)index;
+                }
+            }
+        }
+
+        int start = -1;
+        for (size_t index = 0; index < count && start < 0; ++index)
+        {
+            if (pending[index] != 0)
+            {
+                start = (int)index;
+            }
+        }
+
+        vector<int> visitedAt(count, -1); // Position of each operation in the walk
+        vector<int> walk;
+        int operation = start;
+        while (visitedAt[operation] < 0)
+        {
+            visitedAt[operation] = (int)walk.size();
+            walk.push_back(operation);
+            operation = unfinishedPredecessor[operation];
+        }
+        for (size_t i = walk.size(); i-- > (size_t)visitedAt[operation]; ) // The walk went backwards, so reverse the cycle
+        {
+            report.loop.push_back((size_t)walk[i]);
+        }
+        return report;
+    }
+
+    /*
+        One pass in topological order. The arrival of an operation is its delay plus the latest arrival among
+        its inputs: 0 for a primary input, the register delay for a register output, and the arrival of the
+        driving operation otherwise. A path ends at a register input, at an output, or at an unused result
+    */
+    vector<double> arrival(count, 0);
+    vector<int> predecessor(count, -1); // Driver of the latest input, which is where the path continues backwards
+    double worst = -1;
+    int worstEnd = -1;
+    bool worstAtRegisterInput = false; // Whether the path ends at the data input of worstEnd rather than its output
+
+    for (int operation : order)
+    {
+        Opcode opcode = this->ops->getOpcode((size_t)operation);
+        if (opcode == Opcode::NONE)
+        {
+            continue;
+        }
+
+        OperandRange operands = this->ops->getOperands((size_t)operation);
+        double start = 0;
+
+        for (size_t i = 1; i < operands.size(); ++i)
+        {
+            int driver = this->launchingDriver(operands[i]);
+            if (driver < 0)
+            {
+                continue;
+            }
+
+            double ready = this->isCombinational(driver) ? arrival[driver] : this->delays[driver]; // A register output settles after its own delay
+            if (ready > start)
+            {
+                start = ready;
+                predecessor[operation] = driver;
+            }
+        }
+
+        if (opcode == Opcode::REG) // Capture: the path into the register ends here, and the register launches a new one
+        {
+            arrival[operation] = this->delays[operation];
+            if (start > worst)
+            {
+                worst = start;
+                worstEnd = operation;
+                worstAtRegisterInput = true;
+            }
+            if (arrival[operation] > worst)
+            {
+                worst = arrival[operation];
+                worstEnd = operation;
+                worstAtRegisterInput = false;
+            }
+        }
+        else
+        {
+            arrival[operation] = start + this->delays[operation];
+            if (arrival[operation] > worst)
+            {
+                worst = arrival[operation];
+                worstEnd = operation;
+                worstAtRegisterInput = false;
+            }
+        }
+    }
+
+    if (worstEnd < 0) // No operations
+    {
+        return report;
+    }
+
+    report.criticalPath = worst;
+
+    // Follow the predecessors back to the launching register or primary input
+    int operation = worstAtRegisterInput ? predecessor[worstEnd] : worstEnd;
+    while (operation >= 0)
+    {
+        report.path.push_back(PathStep{(size_t)operation, this->delays[operation], arrival[operation]});
+        if (!this->isCombinational(operation)) // The launching register
+        {
+            break;
+        }
+        operation = predecessor[operation];
+    }
+    reverse(report.path.begin(), report.path.end());
+
+    return report;
+}
+
+bool DataflowGraph::computeArrivals(vector<double>& arrival) const
+{
+    vector<uint32_t> pending;
+    vector<int> order;
+    if (!this->sortTopologically(order, pending))
+    {
+        return false;
+    }
+
+    // Same pass as analyzeTiming(), without following the paths back
+    arrival.assign(this->size(), 0);
+    for (int operation : order)
+    {
+        Opcode opcode = this->ops->getOpcode((size_t)operation);
+        if (opcode == Opcode::NONE)
+        {
+            continue;
+        }
+        if (opcode == Opcode::REG)
+        {
+            arrival[operation] = this->delays[operation];
+            continue;
+        }
+
+        OperandRange operands = this->ops->getOperands((size_t)operation);
+        double start = 0;
+        for (size_t i = 1; i < operands.size(); ++i)
+        {
+            int driver = this->launchingDriver(operands[i]);
+            if (driver >= 0)
+            {
+                start = max(start, this->isCombinational(driver) ? arrival[driver] : this->delays[driver]);
+            }
+        }
+        arrival[operation] = start + this->delays[operation];
+    }
+    return true;
+}
+
+CostReport DataflowGraph::analyzeCost(double clockPeriod) const
+{
+    CostReport report;
+
+    // Area per module: the signed variant of a counter is its second slot
+    vector<ModuleCost> modules(2 * COUNTER_COUNT);
+    for (size_t index = 0; index < this->size(); ++index)
+    {
+        Opcode opcode = this->ops->getOpcode(index);
+        if (opcode == Opcode::NONE || this->instanceNumbers[index] == 0) // Not an instance
+        {
+            continue;
+        }
+
+        const OpDescriptor& desc = getDescriptor(opcode);
+        bool signedModule = desc.signedModule != nullptr && isSigned(this->ops->getOperands(index), *this->symbols);
+        ModuleCost& module = modules[2 * desc.counter + (signedModule ? 1 : 0)];
+        module.module = signedModule ? desc.signedModule : desc.module;
+        module.instances++;
+        module.area += this->areas[index];
+        report.area += this->areas[index];
+        report.instances++;
+    }
+    for (ModuleCost& module : modules)
+    {
+        if (module.instances != 0)
+        {
+            report.modules.push_back(move(module));
+        }
+    }
+
+    TimingReport timing = this->analyzeTiming();
+    vector<double> arrival;
+    if (timing.hasLoop || !this->computeArrivals(arrival))
+    {
+        report.hasLoop = true;
+        return report;
+    }
+    report.criticalPath = timing.criticalPath;
+    report.requiredFromClockPeriod = clockPeriod > 0;
+    report.requiredTime = clockPeriod > 0 ? clockPeriod : timing.criticalPath;
+
+    for (size_t symbol = 0; symbol < this->symbols->size(); ++symbol)
+    {
+        if (this->symbols->getInfo((int)symbol).netType != OUTPUT)
+        {
+            continue;
+        }
+        int driver = this->drivers[symbol];
+        double settled = driver >= 0 ? arrival[driver] : 0; // An undriven output is constant
+        report.outputs.push_back(OutputTiming{(int)symbol, settled, report.requiredTime - settled});
+    }
+    return report;
+}
+
+string DataflowGraph::describe(size_t operation) const
+{
+    Opcode opcode = this->ops->getOpcode(operation);
+    if (opcode == Opcode::NONE)
+    {
+        return "(unrecognized operation)";
+    }
+
+    const OpDescriptor& desc = getDescriptor(opcode);
+    OperandRange operands = this->ops->getOperands(operation);
+    const SymbolTable& symbols = *this->symbols;
+    string text = this->instanceNumbers[operation] == 0 ? string("assign (") : string(desc.name) + to_string(this->instanceNumbers[operation]) + " ("; // e.g., "assign (d = a >> 3)" for wiring
+    text.append(symbols.getName(operands[0])).append(" = ");
+
+    if (opcode == Opcode::REG) // e.g., "z = zwire"
+    {
+        text.append(symbols.getName(operands[1]));
+    }
+    else if (opcode == Opcode::MUX) // e.g., "g = dLTe ? d : e"
+    {
+        text.append(symbols.getName(operands[1])).append(" ? ").append(symbols.getName(operands[2])).append(" : ").append(symbols.getName(operands[3]));
+    }
+    else // e.g., "d = a + b"
+    {
+        text.append(symbols.getName(operands[1])).append(" ").append(desc.symbol).append(" ").append(symbols.getName(operands[2]));
+    }
+
+    return text + ")";
+}
+
+void printTimingReport(ostream& out, const DataflowGraph& graph, const TimingReport& report)
+{
+    char line[64];
+
+    if (report.hasLoop)
+    {
+        out << "Combinational loop through:";
+        for (size_t operation : report.loop)
+        {
+            out << "\n\t" << graph.describe(operation);
+        }
+        out << endl;
+        return;
+    }
+
+    snprintf(line, sizeof(line), "%.3f", report.criticalPath);
+    out << "Critical Path : " << line << " ns" << "\n";
+
+    for (const PathStep& step : report.path)
+    {
+        snprintf(line, sizeof(line), "%8.3f ns %8.3f ns", step.delay, step.arrival);
+        out << "\t" << line << "  " << graph.describe(step.operation) << "\n";
+    }
+    out.flush();
+    return;
+}
+
+void printCostReport(ostream& out, const CostReport& report, const SymbolTable& symbols)
+{
+    char line[96];
+
+    snprintf(line, sizeof(line), "%.1f", report.area);
+    out << "Area : " << line << " gates (NAND2 equivalents) in " << report.instances << (report.instances == 1 ? " instance" : " instances") << "\n";
+    for (const ModuleCost& module : report.modules)
+    {
+        snprintf(line, sizeof(line), "%-6s %6zu x %10.1f", module.module.c_str(), module.instances, module.area);
+        out << "\t" << line << "\n";
+    }
+
+    if (report.hasLoop)
+    {
+        out << "Output arrival times are undefined: the netlist has a combinational loop" << endl;
+        return;
+    }
+
+    snprintf(line, sizeof(line), "%.3f", report.requiredTime);
+    out << "Output arrival and slack against " << line << " ns (" << (report.requiredFromClockPeriod ? "the clock period" : "the critical path") << ")" << "\n";
+    for (const OutputTiming& output : report.outputs)
+    {
+        snprintf(line, sizeof(line), "%8.3f ns %8.3f ns", output.arrival, output.slack);
+        out << "\t" << line << "  " << symbols.getName(output.symbol) << (output.slack < 0 ? " (late)" : "") << "\n";
+    }
+    out.flush();
+    return;
+}
+
+static void appendJsonString(Emitter& out, string_view text) // Quote a string for JSON
+{
+    out.append('"');
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out.append('\\').append(c);
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            out.append(' ');
+        }
+        else
+        {
+            out.append(c);
+        }
+    }
+    out.append('"');
+    return;
+}
+
+void appendCostJson(Emitter& json, const CostReport& report, const SymbolTable& symbols, string_view moduleName)
+{
+    char number[64];
+
+    json.append("{\n  \"module\": ");
+    appendJsonString(json, moduleName);
+    snprintf(number, sizeof(number), "%.3f", report.area);
+    json.append(",\n  \"area\": ").append(number);
+    json.append(",\n  \"instances\": ").appendInt((long long)report.instances);
+    json.append(",\n  \"modules\": [");
+    for (size_t i = 0; i < report.modules.size(); ++i)
+    {
+        const ModuleCost& module = report.modules[i];
+        json.append(i == 0 ? "\n    {\"module\": " : ",\n    {\"module\": ");
+        appendJsonString(json, module.module);
+        snprintf(number, sizeof(number), "%.3f", module.area);
+        json.append(", \"instances\": ").appendInt((long long)module.instances).append(", \"area\": ").append(number).append("}");
+    }
+    json.append(report.modules.empty() ? "]" : "\n  ]");
+
+    json.append(",\n  \"combinational_loop\": ").append(report.hasLoop ? "true" : "false");
+    snprintf(number, sizeof(number), "%.3f", report.criticalPath);
+    json.append(",\n  \"critical_path_ns\": ").append(number);
+    snprintf(number, sizeof(number), "%.3f", report.requiredTime);
+    json.append(",\n  \"required_ns\": ").append(number);
+    json.append(",\n  \"required_from\": ").append(report.requiredFromClockPeriod ? "\"clock_period\"" : "\"critical_path\"");
+
+    double worstSlack = 0;
+    json.append(",\n  \"outputs\": [");
+    for (size_t i = 0; i < report.outputs.size(); ++i)
+    {
+        const OutputTiming& output = report.outputs[i];
+        worstSlack = i == 0 ? output.slack : min(worstSlack, output.slack);
+        json.append(i == 0 ? "\n    {\"name\": " : ",\n    {\"name\": ");
+        appendJsonString(json, symbols.getName(output.symbol));
+        snprintf(number, sizeof(number), ", \"arrival_ns\": %.3f, \"slack_ns\": %.3f}", output.arrival, output.slack);
+        json.append(number);
+    }
+    json.append(report.outputs.empty() ? "]" : "\n  ]");
+    snprintf(number, sizeof(number), "%.3f", worstSlack);
+    json.append(",\n  \"worst_slack_ns\": ").append(number);
+    json.append("\n}\n");
+    return;
+}
@@ -0,0 +1,112 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include "parser.h"
+#include "library.h" // Provides componentDelay() and componentArea()
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// One operation on the critical path
+struct PathStep
+{
+    size_t operation; // Index in the operation list
+    double delay; // Delay of the component (ns)
+    double arrival; // Time its output settles, counted from the clock edge (ns)
+};
+
+// Result of the timing analysis of a dataflow graph
+struct TimingReport
+{
+    bool hasLoop = false; // A combinational loop makes the critical path undefined
+    vector<size_t> loop; // Operations around one combinational loop (when hasLoop is set)
+    double criticalPath = 0; // Longest delay between registers, inputs, and outputs (ns)
+    vector<PathStep> path; // Operations on the critical path, from launch to capture
+};
+
+// The instances of one module (e.g., SMUL) in a netlist
+struct ModuleCost
+{
+    string module; // Emitted module name, which tells the signed variant apart
+    size_t instances = 0;
+    double area = 0; // Sum over the instances, each at its own DATAWIDTH
+};
+
+// When one output settles
+struct OutputTiming
+{
+    int symbol; // The output port
+    double arrival; // Time it settles, counted from the clock edge (ns)
+    double slack; // Required time minus arrival (ns), negative if the output is late
+};
+
+// Result of the cost analysis of a dataflow graph, with the costs of the component library
+struct CostReport
+{
+    bool hasLoop = false; // A combinational loop leaves the arrival times undefined (the area is still counted)
+    double area = 0; // Total area of the instances (equivalent NAND2 gates)
+    size_t instances = 0;
+    vector<ModuleCost> modules; // Per module used, in the order of the instance counters (unsigned variant first)
+    double criticalPath = 0;
+    double requiredTime = 0; // Clock period the slacks are measured against (ns)
+    bool requiredFromClockPeriod = false; // Whether requiredTime is the requested clock period, rather than the critical path
+    vector<OutputTiming> outputs; // Every output, in declaration order
+};
+
+/*
+    Dependency graph of the operations: an edge runs from the operation that drives a net to every operation
+    that reads it. Paths are cut at registers (REG operations) and at inputs and outputs, so every path in the
+    graph is combinational. Edges are stored in compressed arrays, so building and analyzing the graph take
+    time and memory linear in the number of operands
+*/
+class DataflowGraph
+{
+    private:
+        const OpList* ops; // Operations of the netlist (not owned)
+        const SymbolTable* symbols; // Symbols of the netlist (not owned)
+        vector<int> drivers; // Operation that drives each symbol (indexed by symbol ID), or -1 for inputs and undriven nets
+        vector<uint32_t> successorStart; // Index of the first successor of each operation in successors (plus one past the last)
+        vector<int> successors; // Combinational users of each operation, packed back to back
+        vector<double> delays; // Component delay of each operation (ns)
+        vector<double> areas; // Component area of each operation
+        vector<int> instanceNumbers; // The N of the emitted instance name (e.g., 2 for ADD2), 0 for operations that are not emitted as instances (wiring)
+
+        bool isCombinational(int operation) const; // Emitted and not a register
+        int launchingDriver(int symbol) const; // Driver whose output starts a path into a reader of symbol, or -1 for a primary input
+        bool sortTopologically(vector<int>& order, vector<uint32_t>& pending) const; // Leaves the unfinished predecessor count of the operations left out
+
+    public:
+
+        // Default Constructor
+        DataflowGraph()
+        {
+            this->ops = nullptr;
+            this->symbols = nullptr;
+        }
+
+        void build(const OpList& ops, const SymbolTable& symbols);
+
+        size_t size() const; // Number of operations
+        size_t edgeCount() const;
+        int getDriver(int symbol) const;
+        double getDelay(size_t operation) const;
+
+        bool topologicalOrder(vector<int>& order) const; // Every operation after the combinational operations feeding it, false if a combinational loop leaves some out
+        TimingReport analyzeTiming() const; // Detect combinational loops and find the critical path in one topological pass
+        bool computeArrivals(vector<double>& arrival) const; // When the output of each operation settles (the launch delay for a REG), false on a combinational loop
+        CostReport analyzeCost(double clockPeriod) const; // Total area, and the arrival and slack of every output against clockPeriod (the critical path if 0)
+        string describe(size_t operation) const; // e.g., "ADD2 (d = a + b)"
+};
+
+void printTimingReport(ostream& out, const DataflowGraph& graph, const TimingReport& report);
+void printCostReport(ostream& out, const CostReport& report, const SymbolTable& symbols);
+void appendCostJson(Emitter& json, const CostReport& report, const SymbolTable& symbols, string_view moduleName); // One JSON object, for dashboards
+
+#endif
@@ -1,8 +1,21 @@
 #include "parser.h"
+#include "batch.h"
+#include "server.h"
+#include "cache.h"
+#include "dataflow.h"
+#include "library.h"
+#include "schedule.h"
+#include "dpir.h"
+#include "checker.h"
+#include "watch.h"
+#include "lexer.h"
 
 #include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
 #include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., std::cin and std::cout)
 #include <fstream> // Provides functionality for working with files in C++ (e.g., std::ifstream, std::ofstream, and std::fstream)
+#include <cstdio> // Provides fread() to read a netlist from standard input
+#include <cstdlib> // Provides strtod() to read a clock period
+#include <cmath> // Provides isfinite()
 #include <vector> // Provides a dynamic array-like container that stores elements in contiguous memory, allowing for fast access to elements using iterators or indices. Also, it automatically handles memory allocation and resizing, making it a flexible and efficient choice for storing and manipulating collections of objects.
 
 /*
@@ -37,34 +50,476 @@ bool check_conditions(const string& filename)
     return true;
 }
 
-int main(int argc, char* argv[])
+// Read the whole standard input (a netlist given as "-")
+bool read_stdin(string& text)
+{
+    char buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+    {
+        text.append(buffer, count);
+    }
+    return !ferror(stdin);
+}
+
+// Read a clock period in ns (e.g., the "2.5" of --clock-period 2.5), returning false unless it is a positive number
+bool parse_period(const string& text, double& period)
+{
+    char* end = nullptr;
+    period = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && isfinite(period) && period > 0;
+}
+
+// Read a thread count (e.g., the "4" of --jobs 4 or --emit-threads=4), returning false unless it is a whole number of at most 6 digits
+bool parse_count(const string& text, size_t& count)
+{
+    if (text.empty() || text.size() > 6 || text.find_first_not_of("0123456789") != string::npos)
+    {
+        return false;
+    }
+    count = (size_t)stoul(text);
+    return true;
+}
+
+// Print how to use the program
+void print_usage()
+{
+    cout << "Usage: dpgen [options] netlistFile verilogFile" << endl;
+    cout << "       dpgen [options] --batch source [outputDir] [--jobs N]" << endl;
+    cout << "       dpgen [options] --serve socket [--jobs N]" << endl;
+    cout << "       dpgen --client socket netlistFile verilogFile [--text]" << endl;
+    cout << "       dpgen --compile-ir netlistFile imageFile" << endl;
+    cout << "       dpgen --check netlistFile..." << endl;
+    cout << "       dpgen [options] --watch netlistFile verilogFile [netlistFile verilogFile]..." << endl;
+    cout << "\t-    dpgen   : Directory to the dpgen of the CMake build file. (commonly located in ./src/dpgen)" << endl;
+    cout << "\t- netlistFile: Directory to the Behavioral Netlist to be converted. (e.g., [netlist-file-name].txt), or - for standard input" << endl;
+    cout << "\t- verilogFile: Directory to store the output of the Verilog code conversion file. (e.g., [verilog-file-name].v), or - for standard output" << endl;
+    cout << "\t- source     : A directory (every *.txt in it), a glob pattern (e.g., \"circuits/*.txt\"), or a manifest file with one \"netlistFile [verilogFile]\" per line" << endl;
+    cout << "\t- outputDir  : Directory to store the Verilog files that the source does not name (default: current directory)" << endl;
+    cout << "\t- --jobs N   : Number of worker threads (default: one per core)" << endl;
+    cout << "\t- socket     : Path of the Unix domain socket that a dpgen server listens on" << endl;
+    cout << "\t- --text     : Send the netlist text to the server instead of its path" << endl;
+    cout << "\t- --check    : Report every problem of each netlist as file:line:column without generating Verilog (exit status 1 if any has errors)" << endl;
+    cout << "\t- --watch    : Convert each netlist, then update its Verilog file whenever the netlist is saved, reparsing only the edited operation lines (Ctrl+C to stop)" << endl;
+    cout << "\t- imageFile  : Precompiled netlist (e.g., [netlist-file-name].dpir) that every mode accepts in place of a netlistFile, skipping the parse" << endl;
+    cout << "Options:" << endl;
+    cout << "\t- --cache[=dir]: Reuse the Verilog of netlists converted before (default dir: $DPGEN_CACHE_DIR, else ~/.cache/dpgen)" << endl;
+    cout << "\t- --cse        : Merge operations that compute the same value into one instance" << endl;
+    cout << "\t- --clock-period ns: Insert pipeline registers (balanced, so every output gains the same latency) until no stage is slower than ns" << endl;
+    cout << "\t- --critical-path: Print the longest register-to-register delay and the operations on it" << endl;
+    cout << "\t- --cost       : Print the total area of the instances and the arrival time and slack of each output (against --clock-period, else the critical path)" << endl;
+    cout << "\t- --cost-json=file: Also write that report as JSON" << endl;
+    cout << "\t- --library=file: Override delays and areas of the component library, one \"module width delay area\" per line (e.g., SMUL 32 13.1 8400)" << endl;
+    cout << "\t- --retime     : Move the registers of the netlist across the operations to the places that give the shortest clock period, and print the critical path before and after" << endl;
+    cout << "\t- --resources kind=N,...: Share at most N functional units of each kind (add, sub, mul, comp, mux, shr, shl; e.g., mul=2,add=3) over a schedule of several clock cycles per netlist cycle, with a controller, and print the schedule length and unit utilization" << endl;
+    cout << "\t- --min-width  : Give each instance, wire, and register the fewest bits that produce the same outputs (from the range of values of each net and the bits its readers use), and list them" << endl;
+    cout << "\t- --emit-threads=N: Threads that format the instances of one module (default: one per core, one per file in --batch and --serve)" << endl;
+    cout << "\t- --stats      : Print the time of each conversion phase, line/operation/signal counts, heap allocations, and output size" << endl;
+    cout << "\t- --trace=file : Record the conversion phases as Chrome trace-event JSON (open in chrome://tracing or Perfetto)" << endl;
+    return;
+}
+
+// Apply an option shared by every mode, returning false if the argument is not one (and setting error if its value is invalid)
+bool parse_option(const string& arg, ConvertOptions& options, string& error)
 {
+    if (arg == "--cache")
+    {
+        options.cacheDir = defaultCacheDirectory();
+    }
+    else if (arg.rfind("--cache=", 0) == 0)
+    {
+        options.cacheDir = arg.substr(8);
+    }
+    else if (arg == "--cse")
+    {
+        options.eliminateCommonSubexpressions = true;
+    }
+    else if (arg == "--min-width")
+    {
+        options.minimizeWidths = true;
+    }
+    else if (arg == "--retime")
+    {
+        options.retime = true;
+    }
+    else if (arg == "--critical-path")
+    {
+        options.criticalPath = true;
+    }
+    else if (arg == "--cost")
+    {
+        options.costReport = true;
+    }
+    else if (arg.rfind("--cost-json=", 0) == 0)
+    {
+        options.costReport = true;
+        options.costJsonFile = arg.substr(12);
+    }
+    else if (arg.rfind("--emit-threads=", 0) == 0)
+    {
+        size_t threads = 0;
+        if (!parse_count(arg.substr(15), threads))
+        {
+            error = arg + " needs a number of threads";
+        }
+        options.emitThreads = (unsigned)threads;
+    }
+    else if (arg == "--stats")
+    {
+        options.collectStats = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// Convert many netlists in one process: dpgen --batch source [outputDir] [--jobs N]
+int batch_main(const vector<string>& args, size_t threadCount, const ConvertOptions& options)
+{
+    if (args.empty() || args.size() > 2)
+    {
+        print_usage();
+        return 1;
+    }
+
+    string source = args[0];
+    string outputDir = args.size() == 2 ? args[1] : ".";
+    vector<BatchJob> jobs;
+    string error;
+
+    if (!collectBatchJobs(source, outputDir, jobs, error))
+    {
+        cerr << "Error: " << error << endl;
+        return 1;
+    }
+
+    error_code ec;
+    filesystem::create_directories(outputDir, ec); // Make sure the default output directory exists
+
+    return runBatch(jobs, threadCount, options);
+}
+
+// Parse a netlist once and save the result for later conversions: dpgen --compile-ir netlistFile imageFile
+int compile_ir_main(const vector<string>& args, const ConvertOptions& options)
+{
+    if (args.size() != 2)
+    {
+        print_usage();
+        return 1;
+    }
+
+    MappedFile netlistFile(args[0]);
+    if (!netlistFile.isOpen())
+    {
+        cerr << "Error: Unable to open the text file of " << args[0] << endl;
+        return 1;
+    }
+
+    NetParser netParser;
+    netParser.setOptions(options);
+    string error;
+
+    // The image holds the netlist as parsed; options such as --cse apply when it is converted
+    bool loaded = NetlistImage::isImage(netlistFile.text()) ? NetlistImage::load(netlistFile.text(), netParser, error) : netParser.parseText(netlistFile.text());
+    if (!loaded)
+    {
+        cout << "ERROR FOUND: " << (error.empty() ? netParser.getErrorMessage() : error) << endl;
+        cout << "Precompiled netlist failed to be created" << endl;
+        return 1;
+    }
+
+    if (!writeFileIfChanged(args[1], NetlistImage::save(netParser)))
+    {
+        cerr << "Error: Unable to write the precompiled netlist " << args[1] << endl;
+        return 1;
+    }
+
+    cout << "Precompiled netlist successfully created (" << netParser.getOperations().size() << " operations, " << netParser.getSymbols().size() << " signals)" << endl;
+    return 0;
+}
+
+// Lint netlists without generating Verilog: dpgen --check netlistFile...
+int check_main(const vector<string>& args)
+{
+    if (args.empty())
+    {
+        print_usage();
+        return 1;
+    }
+
+    size_t errors = 0;
+    size_t warnings = 0;
+
+    for (const string& netlistFile : args)
+    {
+        MappedFile file(netlistFile);
+        if (!file.isOpen())
+        {
+            cout << netlistFile << ": error: unable to open the file" << endl;
+            errors++;
+            continue;
+        }
+
+        if (NetlistImage::isImage(file.text())) // A precompiled netlist was checked when it was compiled, so only its integrity is left
+        {
+            NetParser netParser;
+            string error;
+            if (!NetlistImage::load(file.text(), netParser, error))
+            {
+                cout << netlistFile << ": error: " << error << endl;
+                errors++;
+            }
+            continue;
+        }
+
+        NetlistChecker checker;
+        printDiagnostics(cout, netlistFile, checker.check(file.text()));
+        errors += checker.count(Severity::ERROR);
+        warnings += checker.count(Severity::WARNING);
+    }
+
+    cout << errors << (errors == 1 ? " error" : " errors") << " and " << warnings << (warnings == 1 ? " warning" : " warnings")
+         << " in " << args.size() << (args.size() == 1 ? " file" : " files") << endl;
+    return errors == 0 ? 0 : 1;
+}
+
+// The cost report of the last conversion as JSON (--cost-json), for dashboards
+bool write_cost_json(ostream& out, const NetParser& netParser, const ConvertOptions& options, const string& moduleName)
+{
+    DataflowGraph graph;
+    graph.build(netParser.getOperations(), netParser.getSymbols());
+    Emitter json;
+    appendCostJson(json, graph.analyzeCost(options.clockPeriod), netParser.getSymbols(), moduleName);
+    if (!writeWholeFile(options.costJsonFile, json.text()))
+    {
+        out << "Error: Unable to write the cost report " << options.costJsonFile << endl;
+        return false;
+    }
+    return true;
+}
+
+// Run the mode selected on the command line
+int run_mode(const string& mode, const vector<string>& args, size_t threadCount, bool sendText, const ConvertOptions& options)
+{
+    if ( mode == "--batch" ) // Batch mode: dpgen --batch source [outputDir] [--jobs N]
+    {
+        return batch_main(args, threadCount, options);
+    }
+
+    if ( mode == "--serve" ) // Keep a warm process that converts netlists for clients: dpgen --serve socket [--jobs N]
+    {
+        if ( args.size() != 1 )
+        {
+            print_usage();
+            return 1;
+        }
+        return runServer(args[0], threadCount, options);
+    }
+
+    if ( mode == "--check" ) // Lint only: dpgen --check netlistFile...
+    {
+        return check_main(args);
+    }
+
+    if ( mode == "--watch" ) // Keep the Verilog up to date while the netlists are edited: dpgen --watch netlistFile verilogFile...
+    {
+        return runWatch(args, options);
+    }
+
+    if ( mode == "--compile-ir" ) // Save the parsed netlist: dpgen --compile-ir netlistFile imageFile
+    {
+        return compile_ir_main(args, options);
+    }
+
+    if ( mode == "--client" ) // Hand one conversion to a server: dpgen --client socket netlistFile verilogFile [--text]
+    {
+        if ( args.size() != 3 )
+        {
+            print_usage();
+            return 1;
+        }
+        return runClient(args[0], args[1], args[2], sendText);
+    }
+
     /*
         Output warning for invalid usage
     */
-    if ( argc != 3 ) // User is expected to provide three arguments in the terminal following the usage statement below
+    if ( args.size() != 2 ) // User is expected to provide two file names in the terminal following the usage statement below
 	{
-		cout << "Usage: dpgen netlistFile verilogFile" << endl;
-        cout << "\t-    dpgen   : Directory to the dpgen of the CMake build file. (commonly located in ./src/dpgen)" << endl;
-		cout << "\t- netlistFile: Directory to the Behavioral Netlist to be converted. (e.g., [netlist-file-name].txt)" << endl;
-		cout << "\t- verilogFile: Directory to store the output of the Verilog code conversion file. (e.g., [verilog-file-name].v) " << endl;
+		print_usage();
 		return 0;
 	}
 
-    string netlistFile = argv[1];
-    string verilogFile = argv[2];
+    string netlistFile = args[0];
+    string verilogFile = args[1];
+    bool toStdout = verilogFile == "-";
+    ostream& report = toStdout ? cerr : cout; // Keep the messages out of a Verilog stream
 
     // Check additional conditions before opening the file
-    if (!check_conditions(argv[1])) {
+    if (netlistFile != "-" && !check_conditions(netlistFile)) {
         return 1; // Exit the program if conditions are not met
     }
 
     NetParser netParser; // Create an instance of the NetParser class
+    netParser.setOptions(options);
+
+    string moduleName = !toStdout ? verilogFile : netlistFile != "-" ? netlistFile : "top"; // Named after the output file, or else the input
+    bool converted;
+    if (netlistFile == "-") // Part of a pipeline: the netlist never touches the disk
+    {
+        string netlistText;
+        if (!read_stdin(netlistText))
+        {
+            cerr << "Error: Unable to read the netlist from standard input" << endl;
+            return 1;
+        }
+        converted = toStdout ? netParser.convertText(netlistText, moduleName, cout) : netParser.convertTextToVerilog(netlistText, verilogFile, moduleName);
+    }
+    else if (toStdout)
+    {
+        MappedFile netlistText(netlistFile);
+        converted = netParser.convertText(netlistText.text(), moduleName, cout);
+    }
+    else
+    {
+        converted = netParser.convertToVerilog(netlistFile, verilogFile); // Perform the conversion from behavioral netlist text format to Verilog code
+    }
 
-    if(netParser.convertToVerilog(netlistFile, verilogFile)) // Perform the conversion from behavioral netlist text format to Verilog code
+    if(converted)
     {
-        cout << "Verilog file successfully created" << endl;
-    } else { cout << "Verilog file failed to be created due to incomplete Behavioral Netlist" << endl;} // IF the conversion is unsuccessful, this error message is displayed instead
+        report << (toStdout ? "Verilog successfully written to standard output" : "Verilog file successfully created") << endl;
+
+        report << netParser.getReport(); // Also on a cache hit, which skips the passes
+
+        if (!options.costJsonFile.empty() && !write_cost_json(report, netParser, options, moduleName))
+        {
+            return 1;
+        }
+    } else {
+        if (!netParser.getErrorMessage().empty())
+        {
+            report << "ERROR FOUND: " << netParser.getErrorMessage() << endl; // Output the reason of the failure (e.g., the text after "//")
+        }
+        report << "Verilog file failed to be created due to incomplete Behavioral Netlist" << endl; // IF the conversion is unsuccessful, this error message is displayed instead
+    }
+
+    if (options.collectStats)
+    {
+        printStats(report, netParser.getStats());
+    }
 
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[])
+{
+    string mode; // "--batch", "--serve", "--client", "--compile-ir", "--check", "--watch", or empty for a single conversion
+    vector<string> args; // Positional arguments
+    size_t threadCount = 0; // One worker per core
+    bool sendText = false;
+    ConvertOptions options;
+    string traceFile; // --trace=<file>
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+
+        if (arg == "--batch" || arg == "--serve" || arg == "--client" || arg == "--compile-ir" || arg == "--check" || arg == "--watch")
+        {
+            mode = arg;
+        }
+        else if (arg == "--clock-period" && i + 1 < argc)
+        {
+            if (!parse_period(argv[++i], options.clockPeriod))
+            {
+                cerr << "Error: --clock-period \"" << argv[i] << "\" needs a clock period in ns greater than 0" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--resources" && i + 1 < argc)
+        {
+            string error;
+            if (!parseUnitLimits(argv[++i], options.unitLimits, error))
+            {
+                cerr << "Error: --resources " << error << endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--library=", 0) == 0)
+        {
+            MappedFile libraryFile(arg.substr(10));
+            ComponentLibrary library;
+            string error;
+            if (!libraryFile.isOpen())
+            {
+                cerr << "Error: Unable to read the component library " << arg.substr(10) << endl;
+                return 1;
+            }
+            if (!library.load(libraryFile.text(), arg.substr(10), error))
+            {
+                cerr << "Error: --library " << error << endl;
+                return 1;
+            }
+            setComponentLibrary(library); // Before any conversion or worker thread starts
+        }
+        else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], threadCount))
+            {
+                cerr << "Error: " << arg << " \"" << argv[i] << "\" needs a number of worker threads" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--text")
+        {
+            sendText = true;
+        }
+        else if (arg.rfind("--trace=", 0) == 0)
+        {
+            traceFile = arg.substr(8);
+        }
+        else if (string error; parse_option(arg, options, error))
+        {
+            if (!error.empty())
+            {
+                cerr << "Error: " << error << endl;
+                return 1;
+            }
+        }
+        else if (arg.size() > 2 && arg.rfind("--", 0) == 0)
+        {
+            cerr << "Error: Unknown option " << arg << endl;
+            print_usage();
+            return 1;
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+#if !DPGEN_INSTRUMENTATION
+    if (options.collectStats || !traceFile.empty())
+    {
+        cerr << "Warning: this dpgen was built without DPGEN_INSTRUMENTATION, so --stats and --trace report nothing" << endl;
+    }
+#endif
+
+    if (!traceFile.empty())
+    {
+        startTrace(traceFile);
+    }
+
+    int status = run_mode(mode, args, threadCount, sendText, options);
+
+    string error;
+    if (!finishTrace(error))
+    {
+        cerr << "Error: " << error << endl;
+    }
+
+    return status;
+}
@@ -0,0 +1,315 @@
+#include "dpir.h"
+#include "stats.h"
+
+#include <cstdint>
+#include <cstring> // Provides memcpy() and memcmp()
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+static const char DPIR_MAGIC[8] = { '\x89', 'D', 'P', 'I', 'R', '\r', '\n', '\x1a' }; // Binary-looking, so no netlist text starts with it
+static const uint32_t DPIR_BYTE_ORDER = 0x01020304; // Reads back differently on a host of the other byte order
+
+struct DpirHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t symbolCount;
+    uint64_t slotCount;
+    uint64_t netCount;
+    uint64_t operationCount;
+    uint64_t operandCount;
+    uint64_t stringBytes;
+    uint64_t symbolOffset;
+    uint64_t slotOffset;
+    uint64_t netOffset;
+    uint64_t opcodeOffset;
+    uint64_t operandStartOffset;
+    uint64_t operandOffset;
+    uint64_t stringOffset;
+    uint64_t fileSize;
+};
+
+struct DpirSymbol
+{
+    uint32_t nameOffset; // Into the string pool
+    uint32_t nameLength;
+    uint32_t hash; // Hash cached by the symbol table
+    int32_t bitWidth;
+    uint8_t netType; // Index into NET_TYPE_NAMES
+    char signType; // 'u' or 's'
+    uint8_t padding[2];
+};
+
+struct DpirNet
+{
+    uint8_t list; // 0 inputs, 1 outputs, 2 wires, 3 registers
+    uint8_t netType; // Index into NET_TYPE_NAMES
+    uint8_t padding[2];
+    int32_t bitWidth;
+    uint32_t varOffset; // Into the string pool
+    uint32_t varLength;
+};
+
+// Net types of the symbol table and of SetNet, stored as indexes
+static const char* const NET_TYPE_NAMES[] = { EMPTY, INPUT, OUTPUT, WIRE, "reg", CONSTANT };
+static const int NET_TYPE_COUNT = 6;
+
+static uint8_t netTypeCode(string_view netType)
+{
+    for (int code = 1; code < NET_TYPE_COUNT; ++code)
+    {
+        if (netType == NET_TYPE_NAMES[code])
+        {
+            return (uint8_t)code;
+        }
+    }
+    return 0;
+}
+
+static uint64_t alignSection(uint64_t offset) // Round up to the next 8-byte boundary
+{
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+bool NetlistImage::isImage(string_view bytes)
+{
+    return bytes.size() >= sizeof(DPIR_MAGIC) && memcmp(bytes.data(), DPIR_MAGIC, sizeof(DPIR_MAGIC)) == 0;
+}
+
+string NetlistImage::save(const NetParser& netParser)
+{
+    const SymbolTable& symbols = netParser.symbols;
+    const OpList& ops = netParser.operations;
+    const vector<SetNet>* lists[4] = { &netParser.inputs, &netParser.outputs, &netParser.wires, &netParser.registers };
+
+    DpirHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DPIR_MAGIC, sizeof(DPIR_MAGIC));
+    header.version = DPIR_VERSION;
+    header.byteOrder = DPIR_BYTE_ORDER;
+    header.symbolCount = symbols.names.size();
+    header.slotCount = symbols.slots.size();
+    header.operationCount = ops.opcodes.size();
+    header.operandCount = ops.operandIds.size();
+    for (const vector<SetNet>* list : lists)
+    {
+        header.netCount += list->size();
+    }
+
+    // Names first, then the variable lists of the nets
+    string strings;
+    vector<DpirSymbol> symbolRecords(header.symbolCount);
+    for (size_t id = 0; id < header.symbolCount; ++id)
+    {
+        const variableInfo& info = symbols.infos[id];
+        DpirSymbol& record = symbolRecords[id];
+        memset(&record, 0, sizeof(record));
+        record.nameOffset = (uint32_t)strings.size();
+        record.nameLength = (uint32_t)symbols.names[id].size();
+        record.hash = symbols.hashes[id];
+        record.bitWidth = info.bitWidth;
+        record.netType = netTypeCode(info.netType);
+        record.signType = info.signType;
+        strings.append(symbols.names[id]);
+    }
+
+    vector<DpirNet> netRecords;
+    netRecords.reserve(header.netCount);
+    for (uint8_t list = 0; list < 4; ++list)
+    {
+        for (const SetNet& net : *lists[list])
+        {
+            DpirNet record;
+            memset(&record, 0, sizeof(record));
+            record.list = list;
+            record.netType = netTypeCode(net.getNetType());
+            record.bitWidth = net.getBitWidth();
+            record.varOffset = (uint32_t)strings.size();
+            record.varLength = (uint32_t)net.getVarNames().size();
+            strings.append(net.getVarNames());
+            netRecords.push_back(record);
+        }
+    }
+    header.stringBytes = strings.size();
+
+    // Lay out the sections
+    header.symbolOffset = alignSection(sizeof(DpirHeader));
+    header.slotOffset = alignSection(header.symbolOffset + header.symbolCount * sizeof(DpirSymbol));
+    header.netOffset = alignSection(header.slotOffset + header.slotCount * sizeof(int32_t));
+    header.opcodeOffset = alignSection(header.netOffset + header.netCount * sizeof(DpirNet));
+    header.operandStartOffset = alignSection(header.opcodeOffset + header.operationCount);
+    header.operandOffset = alignSection(header.operandStartOffset + (header.operationCount + 1) * sizeof(uint32_t));
+    header.stringOffset = alignSection(header.operandOffset + header.operandCount * sizeof(int32_t));
+    header.fileSize = header.stringOffset + header.stringBytes;
+
+    string image(header.fileSize, '\0');
+    char* base = &image[0];
+    memcpy(base, &header, sizeof(header));
+    memcpy(base + header.symbolOffset, symbolRecords.data(), symbolRecords.size() * sizeof(DpirSymbol));
+    memcpy(base + header.slotOffset, symbols.slots.data(), header.slotCount * sizeof(int32_t));
+    memcpy(base + header.netOffset, netRecords.data(), netRecords.size() * sizeof(DpirNet));
+    memcpy(base + header.opcodeOffset, ops.opcodes.data(), header.operationCount);
+    memcpy(base + header.operandStartOffset, ops.operandStart.data(), (header.operationCount + 1) * sizeof(uint32_t));
+    memcpy(base + header.operandOffset, ops.operandIds.data(), header.operandCount * sizeof(int32_t));
+    memcpy(base + header.stringOffset, strings.data(), header.stringBytes);
+
+    return image;
+}
+
+// Whether count elements of elementSize bytes at offset lie inside a file of fileSize bytes
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize)
+{
+    return offset <= fileSize && (offset & 7) == 0 && count <= (fileSize - offset) / elementSize;
+}
+
+bool NetlistImage::load(string_view bytes, NetParser& netParser, string& error)
+{
+    DPGEN_PHASE(loadTimer, Phase::READ); // Loading the image takes the place of both parsing phases
+    DPGEN_SPAN(loadSpan, "load image");
+
+    DpirHeader header;
+    if (!isImage(bytes) || bytes.size() < sizeof(header))
+    {
+        error = "Not a precompiled netlist (.dpir)";
+        return false;
+    }
+    memcpy(&header, bytes.data(), sizeof(header));
+
+    if (header.byteOrder != DPIR_BYTE_ORDER)
+    {
+        error = "The precompiled netlist was written on a machine of the other byte order";
+        return false;
+    }
+    if (header.version != DPIR_VERSION)
+    {
+        error = "The precompiled netlist has format version " + to_string(header.version) + ", this dpgen reads version " + to_string(DPIR_VERSION) + " (recompile it with --compile-ir)";
+        return false;
+    }
+
+    uint64_t fileSize = bytes.size();
+    if (header.fileSize != fileSize ||
+        !sectionFits(header.symbolOffset, header.symbolCount, sizeof(DpirSymbol), fileSize) ||
+        !sectionFits(header.slotOffset, header.slotCount, sizeof(int32_t), fileSize) ||
+        !sectionFits(header.netOffset, header.netCount, sizeof(DpirNet), fileSize) ||
+        !sectionFits(header.opcodeOffset, header.operationCount, 1, fileSize) ||
+        !sectionFits(header.operandStartOffset, header.operationCount + 1, sizeof(uint32_t), fileSize) ||
+        !sectionFits(header.operandOffset, header.operandCount, sizeof(int32_t), fileSize) ||
+        header.stringOffset > fileSize || header.stringBytes > fileSize - header.stringOffset ||
+        header.symbolCount > (uint64_t)INT32_MAX || header.operandCount > (uint64_t)UINT32_MAX ||
+        (header.slotCount & (header.slotCount - 1)) != 0 || header.slotCount < 2 * header.symbolCount)
+    {
+        error = "The precompiled netlist is truncated or corrupt";
+        return false;
+    }
+
+    netParser.clear();
+
+    const char* base = bytes.data();
+    SymbolTable& symbols = netParser.symbols;
+    OpList& ops = netParser.operations;
+    string& corrupt = error;
+    auto fail = [&netParser, &corrupt]()
+    {
+        netParser.clear();
+        corrupt = "The precompiled netlist is truncated or corrupt";
+        return false;
+    };
+
+    // One copy of the string pool into the arena; every name and variable list is a view into it
+    char* strings = (char*)netParser.arena.allocate(header.stringBytes == 0 ? 1 : header.stringBytes, 1);
+    memcpy(strings, base + header.stringOffset, header.stringBytes);
+
+    // Symbol table
+    const char* symbolBytes = base + header.symbolOffset;
+    symbols.names.resize(header.symbolCount);
+    symbols.hashes.resize(header.symbolCount);
+    symbols.infos.resize(header.symbolCount);
+    for (size_t id = 0; id < header.symbolCount; ++id)
+    {
+        DpirSymbol record;
+        memcpy(&record, symbolBytes + id * sizeof(DpirSymbol), sizeof(record));
+        if (record.nameOffset > header.stringBytes || record.nameLength > header.stringBytes - record.nameOffset || record.netType >= NET_TYPE_COUNT)
+        {
+            return fail();
+        }
+
+        symbols.names[id] = string_view(strings + record.nameOffset, record.nameLength);
+        symbols.hashes[id] = record.hash;
+        variableInfo& info = symbols.infos[id];
+        info.netType = NET_TYPE_NAMES[record.netType];
+        info.signType = record.signType;
+        info.bitWidth = record.bitWidth;
+        netParser.literalCount += info.netType == CONSTANT; // So optimize() folds the literals of the image
+    }
+
+    symbols.slots.resize(header.slotCount);
+    memcpy(symbols.slots.data(), base + header.slotOffset, header.slotCount * sizeof(int32_t));
+    size_t occupied = 0;
+    for (int id : symbols.slots)
+    {
+        if (id < -1 || id >= (int64_t)header.symbolCount)
+        {
+            return fail();
+        }
+        occupied += id >= 0;
+    }
+    if (occupied != header.symbolCount) // Otherwise a lookup could probe forever
+    {
+        return fail();
+    }
+
+    // Nets
+    const char* netBytes = base + header.netOffset;
+    vector<SetNet>* lists[4] = { &netParser.inputs, &netParser.outputs, &netParser.wires, &netParser.registers };
+    for (size_t i = 0; i < header.netCount; ++i)
+    {
+        DpirNet record;
+        memcpy(&record, netBytes + i * sizeof(DpirNet), sizeof(record));
+        if (record.list >= 4 || record.netType >= NET_TYPE_COUNT || record.varOffset > header.stringBytes || record.varLength > header.stringBytes - record.varOffset)
+        {
+            return fail();
+        }
+
+        lists[record.list]->push_back(SetNet(NET_TYPE_NAMES[record.netType], record.bitWidth, string_view(strings + record.varOffset, record.varLength)));
+    }
+
+    // Operations
+    ops.opcodes.resize(header.operationCount);
+    ops.operandStart.resize(header.operationCount + 1);
+    ops.operandIds.resize(header.operandCount);
+    memcpy(ops.opcodes.data(), base + header.opcodeOffset, header.operationCount);
+    memcpy(ops.operandStart.data(), base + header.operandStartOffset, (header.operationCount + 1) * sizeof(uint32_t));
+    memcpy(ops.operandIds.data(), base + header.operandOffset, header.operandCount * sizeof(int32_t));
+
+    if (ops.operandStart[0] != 0 || ops.operandStart[header.operationCount] != header.operandCount)
+    {
+        return fail();
+    }
+    for (size_t index = 0; index < header.operationCount; ++index)
+    {
+        if ((uint8_t)ops.opcodes[index] > (uint8_t)Opcode::NONE || ops.operandStart[index] > ops.operandStart[index + 1] ||
+            ops.operandStart[index + 1] - ops.operandStart[index] > (uint32_t)MAX_OPERANDS ||
+            (ops.opcodes[index] != Opcode::NONE && ops.operandStart[index + 1] - ops.operandStart[index] != getOperandCount(ops.opcodes[index])))
+        {
+            return fail();
+        }
+    }
+    for (int id : ops.operandIds)
+    {
+        if (id < 0 || id >= (int64_t)header.symbolCount)
+        {
+            return fail();
+        }
+    }
+
+    netParser.useDefs.build(ops, symbols.size());
+
+    DPGEN_COUNT(operations, header.operationCount);
+    DPGEN_COUNT(signals, header.symbolCount);
+    return true;
+}
@@ -0,0 +1,82 @@
+#include "emitter.h"
+
+#include <charconv> // Provides to_chars()
+#include <cerrno> // Provides errno and EINTR
+#include <fstream> // Provides functionality for working with files in C++ (e.g., ifstream, ofstream, and fstream)
+
+#if !defined(_WIN32)
+#include <fcntl.h> // Provides open()
+#include <unistd.h> // Provides write() and close()
+#endif
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+void Emitter::reserve(size_t bytes)
+{
+    this->buffer.reserve(bytes);
+    return;
+}
+
+Emitter& Emitter::appendInt(long long value)
+{
+    char digits[24]; // Enough for any 64-bit value with its sign
+    to_chars_result result = to_chars(digits, digits + sizeof(digits), value);
+
+    this->buffer.append(digits, result.ptr - digits);
+    return *this;
+}
+
+size_t Emitter::size() const
+{
+    return this->buffer.size();
+}
+
+const string& Emitter::text() const
+{
+    return this->buffer;
+}
+
+string Emitter::release()
+{
+    string text;
+    text.swap(this->buffer);
+    return text;
+}
+
+bool writeWholeFile(const string& path, string_view contents)
+{
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // A regular file normally takes the whole buffer in one call, the loop only covers partial writes
+    size_t written = 0;
+    while (written < contents.size())
+    {
+        ssize_t count = write(fd, contents.data() + written, contents.size() - written);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            close(fd);
+            return false;
+        }
+        written += (size_t)count;
+    }
+
+    return close(fd) == 0;
+#else
+    ofstream file(path, ios::binary);
+    file.write(contents.data(), (streamsize)contents.size());
+    return file.good();
+#endif
+}
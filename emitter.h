@@ -0,0 +1,53 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <string>
+#include <string_view>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    Growable contiguous output buffer for the generated Verilog. Nothing is flushed while the module is
+    generated, so the whole file is written afterwards with a few large writes instead of one per line
+*/
+class Emitter
+{
+    private:
+        string buffer; // Everything emitted so far
+
+    public:
+
+        // Default Constructor
+        Emitter()
+        {
+        }
+
+        void reserve(size_t bytes); // Preallocate for a module of about this size
+
+        // The appends are defined here so that the emitting loops can inline them
+        Emitter& append(string_view text)
+        {
+            this->buffer.append(text.data(), text.size());
+            return *this;
+        }
+
+        Emitter& append(char c)
+        {
+            this->buffer.push_back(c);
+            return *this;
+        }
+
+        Emitter& appendInt(long long value); // Decimal digits of value, formatted with to_chars
+
+        size_t size() const;
+        const string& text() const;
+        string release(); // Move the buffer out, leaving the emitter empty
+};
+
+bool writeWholeFile(const string& path, string_view contents); // Write contents with as few write calls as the platform allows
+
+#endif
@@ -0,0 +1,313 @@
+#include "fold.h"
+#include "parser.h"
+
+#include <cstdint>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const int MAX_FOLDED_WIDTH = 64; // Values are computed in 64 bits
+
+static uint64_t lowBits(int width) // Mask of the low width bits
+{
+    return width >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+}
+
+static int64_t signedValue(uint64_t value, int width) // The two's complement value of width bits
+{
+    if (width < 64 && ((value >> (width - 1)) & 1) != 0)
+    {
+        return (int64_t)(value | ~lowBits(width));
+    }
+    return (int64_t)value;
+}
+
+static int log2Exact(uint64_t value) // k if value is 2^k, else -1
+{
+    if (value == 0 || (value & (value - 1)) != 0)
+    {
+        return -1;
+    }
+    return 63 - __builtin_clzll(value);
+}
+
+// What the instance computes from its port values a, b (and the MUX select), all already DATAWIDTH bits
+static uint64_t evaluate(Opcode opcode, int dataWidth, bool moduleSigned, uint64_t select, uint64_t a, uint64_t b)
+{
+    uint64_t mask = lowBits(dataWidth);
+    switch (opcode)
+    {
+        case Opcode::ADD: return (a + b) & mask;
+        case Opcode::SUB: return (a - b) & mask;
+        case Opcode::MUL: return (a * b) & mask; // The low bits of a product do not depend on the sign
+        case Opcode::GT: return moduleSigned ? signedValue(a, dataWidth) > signedValue(b, dataWidth) : a > b;
+        case Opcode::LT: return moduleSigned ? signedValue(a, dataWidth) < signedValue(b, dataWidth) : a < b;
+        case Opcode::EQ: return a == b;
+        case Opcode::MUX: return (select & 1) != 0 ? a : b; // The select port is one bit
+        case Opcode::SHR: return b >= (uint64_t)dataWidth ? 0 : a >> b;
+        case Opcode::SHL: return b >= (uint64_t)dataWidth ? 0 : (a << b) & mask;
+        default: return 0;
+    }
+}
+
+// How an operation is replaced: a shift of source by amount (a constant), at dataWidth
+struct Replacement
+{
+    Opcode opcode = Opcode::NONE; // NONE while the operation stays
+    int source = -1;
+    int amount = -1;
+    int dataWidth = 0;
+};
+
+FoldResult foldConstants(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs)
+{
+    FoldResult result;
+    size_t count = ops.size();
+
+    // The value of every constant, and of every wire that folding makes constant (a wire with one driver only)
+    vector<uint8_t> known(symbols.size(), 0);
+    vector<uint64_t> values(symbols.size(), 0);
+    vector<uint32_t> driverCount(symbols.size(), 0);
+    bool anyConstant = false;
+    for (size_t id = 0; id < symbols.size(); ++id)
+    {
+        if (symbols.getInfo((int)id).netType == CONSTANT)
+        {
+            known[id] = 1;
+            values[id] = getConstantValue((int)id, symbols);
+            anyConstant = true;
+        }
+    }
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) != Opcode::NONE && ops.getOperands(index).size() != 0)
+        {
+            driverCount[ops.getOperands(index)[0]]++;
+        }
+    }
+
+    auto constantOf = [&](uint64_t value) // Intern a constant, which may be new to the symbol table
+    {
+        int id = internConstant(symbols, value);
+        if ((size_t)id >= known.size())
+        {
+            known.resize(id + 1, 0);
+            values.resize(id + 1, 0);
+            driverCount.resize(id + 1, 0);
+        }
+        known[id] = 1;
+        values[id] = value;
+        return id;
+    };
+
+    vector<Replacement> replacements(count);
+    if (anyConstant)
+    {
+        int zero = constantOf(0);
+
+        // Netlist order first, then again each reader of a wire that became constant
+        vector<uint32_t> worklist(count);
+        vector<uint8_t> queued(count, 1);
+        for (size_t index = 0; index < count; ++index)
+        {
+            worklist[index] = (uint32_t)index;
+        }
+
+        for (size_t next = 0; next < worklist.size(); ++next)
+        {
+            size_t index = worklist[next];
+            queued[index] = 0;
+            Opcode opcode = ops.getOpcode(index);
+            OperandRange operands = ops.getOperands(index);
+            bool isMux = opcode == Opcode::MUX;
+            if (opcode == Opcode::NONE || opcode == Opcode::REG || operands.size() != (isMux ? 4u : 3u) || replacements[index].opcode != Opcode::NONE)
+            {
+                continue; // A register delays its constant, so it stays
+            }
+
+            const OpDescriptor& desc = getDescriptor(opcode);
+            int destination = operands[0];
+            int destinationWidth = symbols.getInfo(destination).bitWidth; // Copied, since interning a constant may grow the table
+            bool destinationIsWire = symbols.getInfo(destination).netType == WIRE;
+            int dataWidth = ops.getDataWidth(index, symbols);
+            bool moduleSigned = desc.signedModule != nullptr && isSigned(operands, symbols);
+            bool widthsFit = dataWidth >= 1 && dataWidth <= MAX_FOLDED_WIDTH && destinationWidth >= 1 && destinationWidth <= MAX_FOLDED_WIDTH;
+            for (size_t slot = 1; slot < operands.size(); ++slot)
+            {
+                widthsFit = widthsFit && symbols.getInfo(operands[slot]).bitWidth <= MAX_FOLDED_WIDTH;
+            }
+
+            // The result goes into the net as the module drives it: sign-extended from a signed module narrower than the net
+            bool extends = moduleSigned && dataWidth < destinationWidth && desc.widthRule == WidthRule::OUTPUT_WIDTH;
+            if (!widthsFit || extends)
+            {
+                continue;
+            }
+
+            // Port values: a narrower net is zero-extended into the port and a wider one truncated
+            uint64_t ports[4] = {};
+            bool portKnown[4] = {};
+            for (size_t slot = 1; slot < operands.size(); ++slot)
+            {
+                portKnown[slot] = known[operands[slot]] != 0;
+                ports[slot] = values[operands[slot]] & (isMux && slot == 1 ? 1 : lowBits(dataWidth));
+            }
+            int dataSlots[2] = { isMux ? 2 : 1, isMux ? 3 : 2 };
+
+            Replacement& replacement = replacements[index];
+            int identity = -1; // The operand the result equals, if an identity
+            bool constant = false;
+            uint64_t value = 0;
+
+            if (isMux && portKnown[1])
+            {
+                int chosen = (ports[1] & 1) != 0 ? 2 : 3;
+                constant = portKnown[chosen];
+                value = ports[chosen];
+                identity = constant ? -1 : operands[chosen];
+            }
+            else if (!isMux && portKnown[1] && portKnown[2])
+            {
+                constant = true;
+                value = evaluate(opcode, dataWidth, moduleSigned, 0, ports[1], ports[2]);
+            }
+            else if (opcode == Opcode::ADD || opcode == Opcode::SUB || opcode == Opcode::MUL)
+            {
+                for (int side = 0; side < 2 && identity < 0 && !constant; ++side)
+                {
+                    int slot = dataSlots[side];
+                    int other = operands[dataSlots[1 - side]];
+                    if (!portKnown[slot] || (opcode == Opcode::SUB && side == 0)) // Only x - 0 is an identity of a subtraction
+                    {
+                        continue;
+                    }
+
+                    if (ports[slot] == (opcode == Opcode::MUL ? 1u : 0u)) // x + 0, x - 0, x * 1
+                    {
+                        identity = other;
+                    }
+                    else if (opcode == Opcode::MUL && ports[slot] == 0) // x * 0
+                    {
+                        constant = true;
+                        value = 0;
+                    }
+                    else if (opcode == Opcode::MUL && log2Exact(ports[slot]) > 0) // x * 2^k, the low bits of x << k
+                    {
+                        replacement = Replacement{Opcode::SHL, other, constantOf((uint64_t)log2Exact(ports[slot])), dataWidth};
+                    }
+                }
+            }
+
+            if (identity == destination)
+            {
+                continue; // A loop through the operation itself, which folding cannot settle
+            }
+            if (identity >= 0)
+            {
+                replacement = Replacement{Opcode::SHR, identity, zero, dataWidth};
+            }
+            else if (constant)
+            {
+                int written = desc.widthRule == WidthRule::OUTPUT_WIDTH ? dataWidth : 1; // A comparator drives one bit
+                value &= lowBits(written);
+                replacement = Replacement{Opcode::SHR, constantOf(value), zero, destinationWidth};
+
+                if (destinationIsWire && driverCount[destination] == 1) // Its readers may fold in turn
+                {
+                    known[destination] = 1;
+                    values[destination] = useDefs.isUsedAs(destination, PortRole::SELECT) ? value & 1 : value; // A select is declared with one bit
+                    for (const SignalUse& use : useDefs.getUses(destination))
+                    {
+                        if (!queued[use.operation])
+                        {
+                            queued[use.operation] = 1;
+                            worklist.push_back(use.operation);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+        A wire read as a MUX select is declared with one bit (see SetNet::printWire()), which its other readers see as
+        well, so one MUX keeps reading it as a select when folding would remove all of them
+    */
+    vector<uint8_t> selects(symbols.size(), 0);
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::MUX && ops.getOperands(index).size() == 4 && replacements[index].opcode == Opcode::NONE)
+        {
+            selects[ops.getOperands(index)[1]] = 1;
+        }
+    }
+    for (size_t index = 0; index < count; ++index)
+    {
+        int select = ops.getOperands(index).size() == 4 ? ops.getOperands(index)[1] : -1;
+        if (ops.getOpcode(index) != Opcode::MUX || replacements[index].opcode == Opcode::NONE || selects[select] ||
+            symbols.getInfo(select).netType != WIRE || symbols.getInfo(select).bitWidth == 1)
+        {
+            continue;
+        }
+        for (const SignalUse& use : useDefs.getUses(select))
+        {
+            if (use.role != PortRole::SELECT) // Read as data somewhere, at the width of its declaration
+            {
+                replacements[index] = Replacement();
+                selects[select] = 1;
+                break;
+            }
+        }
+    }
+
+    // Rebuild the operations with the replacements in place, each a single operation, so the netlist lines stay aligned
+    bool replaced = false;
+    for (const Replacement& replacement : replacements)
+    {
+        replaced = replaced || replacement.opcode != Opcode::NONE;
+        if (replacement.opcode == Opcode::SHL)
+        {
+            result.strengthReduced++;
+        }
+        else if (replacement.opcode == Opcode::SHR && symbols.getInfo(replacement.source).netType == CONSTANT)
+        {
+            result.folded++;
+        }
+        else if (replacement.opcode == Opcode::SHR)
+        {
+            result.simplified++;
+        }
+    }
+    if (replaced)
+    {
+        OpList rebuilt;
+        for (size_t index = 0; index < count; ++index)
+        {
+            OperandRange operands = ops.getOperands(index);
+            const Replacement& replacement = replacements[index];
+            if (replacement.opcode == Opcode::NONE)
+            {
+                rebuilt.push(SetOp(ops.getOpcode(index), operands.begin(), operands.size()));
+                continue;
+            }
+
+            int shift[3] = { operands[0], replacement.source, replacement.amount };
+            rebuilt.push(SetOp(replacement.opcode, shift, 3));
+            if (rebuilt.getDataWidth(index, symbols) != replacement.dataWidth) // e.g., the sum of a wider operand and 0 keeps the width of the sum
+            {
+                rebuilt.setDataWidth(index, replacement.dataWidth);
+            }
+        }
+        ops = move(rebuilt);
+    }
+
+    for (size_t index = 0; index < ops.size(); ++index)
+    {
+        result.wired += ops.isWiring(index, symbols) ? 1 : 0;
+    }
+    return result;
+}
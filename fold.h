@@ -0,0 +1,30 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <cstddef>
+
+class OpList;
+class SymbolTable;
+class UseDefIndex;
+
+// What constant folding and strength reduction did to a netlist
+struct FoldResult
+{
+    size_t folded = 0; // Operations of constants only, replaced by their value
+    size_t simplified = 0; // Identities (x + 0, x - 0, x * 1, a MUX with a constant select), replaced by their operand
+    size_t strengthReduced = 0; // Multiplications by a power of two, replaced by shifts left
+    size_t wired = 0; // Instances left as wiring: every shift by a constant, with the replacements above
+
+    bool changed() const { return this->wired != 0; }
+};
+
+/*
+    Fold the operations on integer literals (and on wires that earlier folding made constant) at the DATAWIDTH
+    and sign of their instance, so the result is the one the module would compute. Every replacement is a shift
+    by a constant, which is wiring rather than an instance (OpList::isWiring()): a value or an identity becomes a
+    shift by 0, and a multiplication by 2^k a shift left by k. Each replaced operation keeps its place, so the
+    operations still line up with the netlist lines; run it before the passes that set DATAWIDTH
+*/
+FoldResult foldConstants(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs);
+
+#endif
@@ -0,0 +1,40 @@
+#include "stats.h"
+
+#include <cstdlib> // Provides malloc() and free()
+#include <new> // Provides bad_alloc and the replaceable operator new
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    The allocation counters of --stats. The global operator new is replaced here, in the dpgen executable, rather than
+    in the library, so a program that links libdpgen keeps its own allocator
+*/
+#if DPGEN_INSTRUMENTATION
+
+void* operator new(size_t size)
+{
+    countAllocation(size);
+
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+#endif
@@ -0,0 +1,260 @@
+#include "lexer.h"
+
+#include <fstream> // Provides functionality for working with files in C++ (e.g., ifstream, ofstream, and fstream)
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h> // Provides open()
+#include <sys/mman.h> // Provides mmap() and munmap()
+#include <sys/stat.h> // Provides fstat()
+#include <unistd.h> // Provides close()
+#endif
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+static bool isSpace(char c) // Same whitespace set that the netlist reader has always trimmed
+{
+    return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\n' || c == '\r';
+}
+
+static string_view trim(string_view text) // Remove leading and trailing whitespace
+{
+    while (!text.empty() && isSpace(text.front()))
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isSpace(text.back()))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+
+/*
+    Map the whole file into memory so that the lexer can hand out views without copying any line
+*/
+MappedFile::MappedFile(const string& path)
+{
+    this->data = nullptr;
+    this->length = 0;
+    this->mapped = false;
+    this->opened = false;
+
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED)
+            {
+                madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL); // The lexer reads the file front to back once
+                this->data = static_cast<const char*>(address);
+                this->length = (size_t)info.st_size;
+                this->mapped = true;
+                this->opened = true;
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    if (!this->mapped) // Empty files, pipes, and platforms without mmap are read into a buffer instead
+    {
+        ifstream file(path, ios::binary);
+        if (file.is_open())
+        {
+            ostringstream contents;
+            contents << file.rdbuf();
+            this->buffer = contents.str();
+            this->data = this->buffer.data();
+            this->length = this->buffer.size();
+            this->opened = true;
+        }
+    }
+}
+
+MappedFile::~MappedFile()
+{
+#if !defined(_WIN32)
+    if (this->mapped)
+    {
+        munmap(const_cast<char*>(this->data), this->length);
+    }
+#endif
+}
+
+bool MappedFile::isOpen() const // Check whether the file could be read
+{
+    return this->opened;
+}
+
+string_view MappedFile::text() const // Getter for the whole contents of the file
+{
+    return string_view(this->data, this->length);
+}
+
+
+/*
+    Split off the next non-blank line, tokenize it on whitespace, and classify it by its first token
+*/
+bool NetLexer::nextLine(NetLine& line)
+{
+    while (!this->input.empty())
+    {
+        size_t end = this->input.find('\n');
+        string_view raw = this->input.substr(0, end); // The line without its newline
+        this->input.remove_prefix(end == string_view::npos ? this->input.size() : end + 1);
+        this->lineNumber++;
+
+        line.number = this->lineNumber;
+        line.tokenCount = 0;
+        line.comment = string_view();
+        line.varList = string_view();
+
+        size_t commentPos = raw.find("//");
+        if (commentPos != string_view::npos) // A comment marks an error in the netlist, so the rest of the line is the message
+        {
+            line.kind = LineKind::COMMENT;
+            line.text = raw;
+            line.comment = raw.substr(commentPos + 2);
+            return true;
+        }
+
+        line.text = raw;
+        while (!line.text.empty() && isSpace(line.text.back())) // Remove the trailing whitespace
+        {
+            line.text.remove_suffix(1);
+        }
+
+        // Tokenize on whitespace
+        size_t pos = 0;
+        while (pos < line.text.size())
+        {
+            while (pos < line.text.size() && isSpace(line.text[pos]))
+            {
+                pos++;
+            }
+            if (pos >= line.text.size())
+            {
+                break;
+            }
+
+            size_t start = pos;
+            while (pos < line.text.size() && !isSpace(line.text[pos]))
+            {
+                pos++;
+            }
+
+            if (line.tokenCount < MAX_LINE_TOKENS)
+            {
+                line.tokens[line.tokenCount] = line.text.substr(start, pos - start);
+            }
+            line.tokenCount++;
+        }
+
+        if (line.tokenCount == 0) // Skip blank lines
+        {
+            continue;
+        }
+
+        // Classify the line by its first token
+        string_view first = line.tokens[0];
+        if (first == "input")
+        {
+            line.kind = LineKind::INPUT_DECL;
+        }
+        else if (first == "output")
+        {
+            line.kind = LineKind::OUTPUT_DECL;
+        }
+        else if (first == "wire")
+        {
+            line.kind = LineKind::WIRE_DECL;
+        }
+        else if (first == "register")
+        {
+            line.kind = LineKind::REGISTER_DECL;
+        }
+        else
+        {
+            line.kind = LineKind::OPERATION;
+        }
+
+        if (line.kind != LineKind::OPERATION && line.tokenCount >= 3) // The variable list of a declaration runs from the third token to the end of the line
+        {
+            size_t listStart = (size_t)(line.tokens[2].data() - line.text.data());
+            line.varList = line.text.substr(listStart);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+/*
+    Parse a type token such as "Int32" or "UInt8"
+*/
+bool parseTypeToken(string_view token, char& signType, int& bitWidth)
+{
+    if (token.substr(0, 4) == "UInt")
+    {
+        signType = 'u'; // Unsigned datatype
+        token.remove_prefix(4);
+    }
+    else if (token.substr(0, 3) == "Int")
+    {
+        signType = 's'; // Signed datatype
+        token.remove_prefix(3);
+    }
+    else
+    {
+        return false;
+    }
+
+    if (token.empty() || token.size() > 9) // Needs at least one digit, and must not overflow an int
+    {
+        return false;
+    }
+
+    bitWidth = 0;
+    for (char c : token)
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        bitWidth = bitWidth * 10 + (c - '0');
+    }
+
+    return true;
+}
+
+/*
+    Pop the next name of a variable list such as "a, b, c"
+*/
+bool nextVarName(string_view& varList, string_view& name)
+{
+    while (!varList.empty())
+    {
+        size_t comma = varList.find(',');
+        name = trim(varList.substr(0, comma));
+        varList.remove_prefix(comma == string_view::npos ? varList.size() : comma + 1);
+
+        if (!name.empty()) // Skip empty entries (e.g., a trailing comma)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,85 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <string>
+#include <string_view>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const int MAX_LINE_TOKENS = 8; // No valid line has more tokens than this (e.g., "z = g ? d : e" has seven)
+
+// Kind of each line in the behavioral netlist, decided once by the lexer
+enum class LineKind
+{
+    INPUT_DECL, // "input Int8 a, b, c"
+    OUTPUT_DECL, // "output Int8 z"
+    WIRE_DECL, // "wire Int16 f, g"
+    REGISTER_DECL, // "register Int64 greg, hreg"
+    OPERATION, // "d = a + b"
+    COMMENT // Any line containing "//", which marks an error in the netlist
+};
+
+// A single classified line of the netlist; every view points into the mapped input
+struct NetLine
+{
+    LineKind kind; // Kind of the line
+    int number; // Line number, starting from 1
+    string_view text; // The line with trailing whitespace removed
+    string_view tokens[MAX_LINE_TOKENS]; // Whitespace-separated tokens (only the first MAX_LINE_TOKENS are kept)
+    int tokenCount; // Number of tokens in the line (may exceed MAX_LINE_TOKENS)
+    string_view comment; // Text after "//" for COMMENT lines
+    string_view varList; // Variable list of a declaration (e.g., "a, b, c")
+};
+
+// Read-only view of a whole input file, memory-mapped when the platform supports it
+class MappedFile
+{
+    private:
+        const char* data; // Start of the file contents
+        size_t length; // Number of bytes in the file
+        bool mapped; // Whether data must be unmapped (otherwise it points into buffer)
+        string buffer; // Fallback storage when the file cannot be mapped
+        bool opened; // Whether the file could be read at all
+
+    public:
+
+        // Parameterized Constructor
+        explicit MappedFile(const string& path);
+
+        // Destructor
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const;
+        string_view text() const;
+};
+
+// Single-pass lexer that splits the netlist into classified lines of string_view tokens
+class NetLexer
+{
+    private:
+        string_view input; // Remaining unread text
+        int lineNumber; // Number of the last returned line
+
+    public:
+
+        // Parameterized Constructor
+        explicit NetLexer(string_view input)
+        {
+            this->input = input;
+            this->lineNumber = 0;
+        }
+
+        bool nextLine(NetLine& line); // Return false once the input is exhausted (blank lines are skipped)
+};
+
+bool parseTypeToken(string_view token, char& signType, int& bitWidth); // Parse "Int<N>" or "UInt<N>" without regex
+bool nextVarName(string_view& varList, string_view& name); // Pop the next comma-separated, trimmed name from a variable list
+
+#endif
@@ -0,0 +1,216 @@
+#include "library.h"
+
+#include <cstdio> // Provides snprintf()
+#include <cstdlib> // Provides strtod() and strtol()
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+constexpr int DELAY_WIDTHS[DELAY_WIDTH_COUNT] = { 1, 2, 8, 16, 32, 64 };
+
+/*
+    Delays (ns) of the ECE 474a datapath components, indexed by the instance counter of the descriptor
+    (ADD, SUB, MUL, COMP, MUX, SHR, SHL, REG) and by the characterized width. The characterization does not
+    tell the signed modules apart, so both variants start from the same delays
+*/
+constexpr double DEFAULT_DELAYS[COUNTER_COUNT][DELAY_WIDTH_COUNT] =
+{
+    { 2.704, 3.713, 4.924, 5.638, 7.270, 9.566 }, // ADD
+    { 3.024, 3.412, 4.890, 5.569, 7.253, 9.566 }, // SUB
+    { 2.438, 3.651, 7.453, 7.811, 12.395, 15.354 }, // MUL
+    { 3.031, 3.934, 5.949, 6.256, 7.264, 8.416 }, // COMP
+    { 4.083, 4.115, 4.815, 5.623, 8.079, 8.766 }, // MUX
+    { 3.644, 4.007, 5.178, 6.460, 8.819, 11.095 }, // SHR
+    { 3.614, 3.980, 5.152, 6.549, 8.565, 11.220 }, // SHL
+    { 2.616, 2.644, 2.879, 3.061, 3.602, 3.966 } // REG
+};
+
+/*
+    Areas (equivalent NAND2 gates) of the unsigned and the signed variant: 7 gates per bit of a ripple-carry adder
+    (8 with the inverted operand of a subtractor), 8 per partial-product bit of an array multiplier (a Baugh-Wooley
+    multiplier adds 2 per bit for the sign), 6 per bit of a comparator (2 more for the sign bits), 3 per bit of a
+    2:1 multiplexer, 3 per bit and level of a barrel shifter, and 6 per bit of a flip-flop with reset
+*/
+constexpr double DEFAULT_AREAS[COUNTER_COUNT][2][DELAY_WIDTH_COUNT] =
+{
+    { { 7, 14, 56, 112, 224, 448 }, { 7, 14, 56, 112, 224, 448 } }, // ADD, SADD
+    { { 8, 16, 64, 128, 256, 512 }, { 8, 16, 64, 128, 256, 512 } }, // SUB, SSUB
+    { { 8, 32, 512, 2048, 8192, 32768 }, { 10, 36, 528, 2080, 8256, 32896 } }, // MUL, SMUL
+    { { 6, 12, 48, 96, 192, 384 }, { 8, 14, 50, 98, 194, 386 } }, // COMP, SCOMP
+    { { 3, 6, 24, 48, 96, 192 }, { 3, 6, 24, 48, 96, 192 } }, // MUX, SMUX
+    { { 3, 6, 72, 192, 480, 1152 }, { 3, 6, 72, 192, 480, 1152 } }, // SHR (no signed variant)
+    { { 3, 6, 72, 192, 480, 1152 }, { 3, 6, 72, 192, 480, 1152 } }, // SHL (no signed variant)
+    { { 6, 12, 48, 96, 192, 384 }, { 6, 12, 48, 96, 192, 384 } } // REG, SREG
+};
+
+static ComponentLibrary currentLibrary; // The built-in costs until setComponentLibrary()
+
+static int widthColumn(int bitWidth) // Characterized width that a component of bitWidth bits is charged as
+{
+    for (int i = 0; i < DELAY_WIDTH_COUNT; ++i)
+    {
+        if (bitWidth <= DELAY_WIDTHS[i])
+        {
+            return i;
+        }
+    }
+    return DELAY_WIDTH_COUNT - 1; // Anything wider than 64 bits is charged as 64 bits
+}
+
+static int variantOf(Opcode opcode, bool isSigned) // 1 for the signed module, which shifts do not have
+{
+    return isSigned && getDescriptor(opcode).signedModule != nullptr ? 1 : 0;
+}
+
+ComponentLibrary::ComponentLibrary()
+{
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+    {
+        for (int variant = 0; variant < 2; ++variant)
+        {
+            for (int column = 0; column < DELAY_WIDTH_COUNT; ++column)
+            {
+                this->delays[counter][variant][column] = DEFAULT_DELAYS[counter][column];
+                this->areas[counter][variant][column] = DEFAULT_AREAS[counter][variant][column];
+            }
+        }
+    }
+}
+
+bool ComponentLibrary::load(string_view text, const string& source, string& error)
+{
+    size_t lineNumber = 0;
+    while (!text.empty())
+    {
+        size_t end = text.find('\n');
+        string_view line = text.substr(0, end);
+        text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+        lineNumber++;
+
+        size_t comment = line.find("//"); // Comments run to the end of the line, as in the netlists
+        string entry(line.substr(0, comment));
+        vector<string> fields;
+        size_t start = entry.find_first_not_of(" \t\r");
+        while (start != string::npos)
+        {
+            size_t stop = entry.find_first_of(" \t\r", start);
+            fields.push_back(entry.substr(start, stop == string::npos ? string::npos : stop - start));
+            start = stop == string::npos ? stop : entry.find_first_not_of(" \t\r", stop);
+        }
+        if (fields.empty())
+        {
+            continue;
+        }
+
+        string where = source + ":" + to_string(lineNumber) + ": ";
+        if (fields.size() != 4)
+        {
+            error = where + "expected \"module width delay area\"";
+            return false;
+        }
+
+        int counter = -1;
+        int variant = 0;
+        for (int code = 0; code < OPCODE_COUNT && counter < 0; ++code)
+        {
+            const OpDescriptor& desc = OP_DESCRIPTORS[code];
+            if (fields[0] == desc.module || (desc.signedModule != nullptr && fields[0] == desc.signedModule))
+            {
+                counter = desc.counter;
+                variant = fields[0] == desc.module ? 0 : 1;
+            }
+        }
+        if (counter < 0)
+        {
+            error = where + "unknown module " + fields[0];
+            return false;
+        }
+
+        char* stop = nullptr;
+        long width = strtol(fields[1].c_str(), &stop, 10);
+        int column = -1;
+        for (int i = 0; i < DELAY_WIDTH_COUNT && *stop == '\0'; ++i)
+        {
+            column = width == DELAY_WIDTHS[i] ? i : column;
+        }
+        if (column < 0)
+        {
+            error = where + "width " + fields[1] + " is not one of 1, 2, 8, 16, 32, 64";
+            return false;
+        }
+
+        double delay = strtod(fields[2].c_str(), &stop);
+        if (*stop != '\0' || !(delay >= 0))
+        {
+            error = where + "delay " + fields[2] + " is not a number of ns";
+            return false;
+        }
+        double area = strtod(fields[3].c_str(), &stop);
+        if (*stop != '\0' || !(area >= 0))
+        {
+            error = where + "area " + fields[3] + " is not a number";
+            return false;
+        }
+
+        this->delays[counter][variant][column] = delay;
+        this->areas[counter][variant][column] = area;
+        if (counter == getDescriptor(Opcode::SHR).counter || counter == getDescriptor(Opcode::SHL).counter)
+        {
+            this->delays[counter][1][column] = delay; // Keep the unused signed row equal, so it never shows
+            this->areas[counter][1][column] = area;
+        }
+
+        char value[96];
+        snprintf(value, sizeof(value), "/%ld=%.17g,%.17g;", width, delay, area);
+        this->overrides += fields[0] + value;
+    }
+    return true;
+}
+
+double ComponentLibrary::getDelay(Opcode opcode, int bitWidth, bool isSigned) const
+{
+    if (opcode == Opcode::NONE)
+    {
+        return 0;
+    }
+    return this->delays[getDescriptor(opcode).counter][variantOf(opcode, isSigned)][widthColumn(bitWidth)];
+}
+
+double ComponentLibrary::getArea(Opcode opcode, int bitWidth, bool isSigned) const
+{
+    if (opcode == Opcode::NONE)
+    {
+        return 0;
+    }
+    return this->areas[getDescriptor(opcode).counter][variantOf(opcode, isSigned)][widthColumn(bitWidth)];
+}
+
+const string& ComponentLibrary::fingerprint() const
+{
+    return this->overrides;
+}
+
+const ComponentLibrary& componentLibrary()
+{
+    return currentLibrary;
+}
+
+void setComponentLibrary(const ComponentLibrary& library)
+{
+    currentLibrary = library;
+    return;
+}
+
+double componentDelay(Opcode opcode, int bitWidth, bool isSigned)
+{
+    return currentLibrary.getDelay(opcode, bitWidth, isSigned);
+}
+
+double componentArea(Opcode opcode, int bitWidth, bool isSigned)
+{
+    return currentLibrary.getArea(opcode, bitWidth, isSigned);
+}
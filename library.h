@@ -0,0 +1,60 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include "parser.h"
+
+#include <string>
+#include <string_view>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const int DELAY_WIDTH_COUNT = 6; // Widths with a characterized delay and area: 1, 2, 8, 16, 32, and 64 bits
+
+/*
+    Delay (ns) and area (equivalent two-input NAND gates) of every datapath module at each characterized width,
+    for the unsigned and the signed variant (SHR and SHL have one variant, since they are always emitted unsigned).
+    A width between two characterized widths is charged as the larger one, and a width above 64 bits as 64.
+
+    The built-in costs are the ECE 474a delays with gate-count estimates of the usual structures (ripple-carry
+    adders, array multipliers, barrel shifters). A library file overrides some of them, one entry per line:
+
+        // module width delay area
+        SMUL 32 13.100 8400
+        ADD 8 4.924 56
+
+    where module is the emitted module name (e.g., ADD, SADD, COMP, SCOMP, SHR, REG, SREG)
+*/
+class ComponentLibrary
+{
+    private:
+        double delays[COUNTER_COUNT][2][DELAY_WIDTH_COUNT]; // Indexed by instance counter, signed variant, and width column
+        double areas[COUNTER_COUNT][2][DELAY_WIDTH_COUNT];
+        string overrides; // The entries a library file changed, as "module/width=delay,area;" (empty for the built-in costs)
+
+    public:
+
+        // Default Constructor: the built-in costs
+        ComponentLibrary();
+
+        bool load(string_view text, const string& source, string& error); // Apply a library file (source names it in the error, e.g., "lib.txt:3: unknown module FOO")
+
+        double getDelay(Opcode opcode, int bitWidth, bool isSigned) const; // 0 for NONE
+        double getArea(Opcode opcode, int bitWidth, bool isSigned) const; // 0 for NONE
+        const string& fingerprint() const; // Changes the delays that --clock-period and --retime use, so it is part of the cache key
+};
+
+/*
+    The library every conversion of the process uses, set once by the command line (--library) before any
+    conversion or worker thread starts
+*/
+const ComponentLibrary& componentLibrary();
+void setComponentLibrary(const ComponentLibrary& library);
+
+double componentDelay(Opcode opcode, int bitWidth, bool isSigned); // Delay in ns of a datapath component in the current library
+double componentArea(Opcode opcode, int bitWidth, bool isSigned); // Area of a datapath component in the current library
+
+#endif
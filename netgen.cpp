@@ -0,0 +1,327 @@
+#include "netgen.h"
+#include "emitter.h"
+
+#include <random> // Provides mt19937_64
+#include <sstream>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const size_t NAMES_PER_DECLARATION = 16; // Split long declarations over several lines, like the hand-written circuits
+
+// Kinds of generated operation lines
+enum class GenOp
+{
+    ADD, SUB, MUL, COMP, MUX, SHR, SHL
+};
+
+static const char* GEN_OP_NAMES[] = { "add", "sub", "mul", "comp", "mux", "shr", "shl" }; // Indexed by GenOp
+static const char* GEN_OP_SYMBOLS[] = { "+", "-", "*", nullptr, nullptr, ">>", "<<" }; // COMP and MUX are written specially
+
+// A generated net and how often it may still be read
+struct GenNet
+{
+    string name; // e.g., "n42"
+    int width; // Bit width
+    bool isSigned; // Declared as "Int" (true) or "UInt" (false)
+    int usesLeft; // Reads left before the net is retired from the pool
+};
+
+// Deterministic random numbers; mt19937_64 gives the same sequence on every standard library
+class GenRandom
+{
+    private:
+        mt19937_64 engine;
+
+    public:
+
+        // Parameterized Constructor
+        explicit GenRandom(uint64_t seed)
+        {
+            this->engine.seed(seed);
+        }
+
+        size_t below(size_t bound) // Uniform in [0, bound)
+        {
+            return (size_t)(this->engine() % bound);
+        }
+
+        double unit() // Uniform in [0, 1)
+        {
+            return (double)(this->engine() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        size_t pick(const vector<double>& weights, double total) // Index chosen in proportion to its weight
+        {
+            double r = this->unit() * total;
+            for (size_t i = 0; i < weights.size(); ++i)
+            {
+                if (r < weights[i])
+                {
+                    return i;
+                }
+                r -= weights[i];
+            }
+            return weights.size() - 1;
+        }
+};
+
+/*
+    Parse a mix such as "add=4,mul=1" into weights; keys must be one of names (or numbers when names is empty)
+*/
+static bool parseMix(const string& spec, const vector<string>& names, vector<string>& keys, vector<double>& weights, double& total, string& error)
+{
+    istringstream ss(spec);
+    string entry;
+    total = 0;
+
+    while (getline(ss, entry, ','))
+    {
+        size_t equals = entry.find('=');
+        string key = entry.substr(0, equals);
+        double weight = 1;
+
+        if (equals != string::npos)
+        {
+            try
+            {
+                weight = stod(entry.substr(equals + 1));
+            }
+            catch (const exception&)
+            {
+                error = "Invalid weight in \"" + entry + "\"";
+                return false;
+            }
+        }
+
+        bool known = names.empty();
+        for (const string& name : names)
+        {
+            known = known || name == key;
+        }
+        if (!known || key.empty() || weight < 0)
+        {
+            error = "Invalid mix entry \"" + entry + "\"";
+            return false;
+        }
+
+        keys.push_back(key);
+        weights.push_back(weight);
+        total += weight;
+    }
+
+    if (total <= 0)
+    {
+        error = "The mix \"" + spec + "\" has no positive weight";
+        return false;
+    }
+    return true;
+}
+
+static void appendType(Emitter& out, const GenNet& net) // e.g., "Int16" or "UInt8"
+{
+    out.append(net.isSigned ? "Int" : "UInt").appendInt(net.width);
+    return;
+}
+
+// Write the declarations of one net type, grouping names of the same type onto shared lines
+static void appendDeclarations(Emitter& out, const char* netType, const vector<GenNet>& nets)
+{
+    vector<vector<const GenNet*>> groups; // Nets of each distinct type, in order of first appearance
+
+    for (const GenNet& net : nets)
+    {
+        bool placed = false;
+        for (vector<const GenNet*>& group : groups)
+        {
+            if (group.front()->width == net.width && group.front()->isSigned == net.isSigned)
+            {
+                group.push_back(&net);
+                placed = true;
+                break;
+            }
+        }
+        if (!placed)
+        {
+            groups.push_back({&net});
+        }
+    }
+
+    for (const vector<const GenNet*>& group : groups)
+    {
+        for (size_t i = 0; i < group.size(); ++i)
+        {
+            if (i % NAMES_PER_DECLARATION == 0)
+            {
+                if (i != 0)
+                {
+                    out.append('\n');
+                }
+                out.append(netType).append(' ');
+                appendType(out, *group[i]);
+                out.append(' ');
+            }
+            else
+            {
+                out.append(", ");
+            }
+            out.append(group[i]->name);
+        }
+        out.append('\n');
+    }
+    return;
+}
+
+bool generateNetlist(const NetgenOptions& options, string& netlistText, string& error)
+{
+    vector<string> opKeys;
+    vector<double> opWeights;
+    double opTotal;
+    vector<string> widthKeys;
+    vector<double> widthWeights;
+    double widthTotal;
+
+    if (!parseMix(options.opMix, vector<string>(begin(GEN_OP_NAMES), end(GEN_OP_NAMES)), opKeys, opWeights, opTotal, error) ||
+        !parseMix(options.widthMix, {"1", "2", "8", "16", "32", "64"}, widthKeys, widthWeights, widthTotal, error))
+    {
+        return false;
+    }
+
+    GenRandom random(options.seed);
+    int fanout = options.fanout < 1 ? 1 : options.fanout;
+
+    auto randomNet = [&](const string& name) // A net with a random width and sign
+    {
+        return GenNet{name, stoi(widthKeys[random.pick(widthWeights, widthTotal)]), random.unit() < options.signedDensity, fanout};
+    };
+
+    vector<GenNet> inputs;
+    vector<GenNet> outputs;
+    vector<GenNet> wires;
+    vector<GenNet> registers;
+    vector<GenNet> selects; // One-bit comparator results (declared as wires too)
+
+    for (size_t i = 0; i < max<size_t>(options.inputCount, 1); ++i)
+    {
+        inputs.push_back(randomNet("in" + to_string(i)));
+    }
+
+    /*
+        Operands are drawn from the pool of nets that still have reads left, falling back to the inputs,
+        so every operand is driven by an input or an earlier line
+    */
+    vector<GenNet*> pool;
+    vector<GenNet*> selectPool;
+    wires.reserve(options.opCount);
+    registers.reserve(options.opCount);
+    selects.reserve(options.opCount);
+
+    auto take = [&](vector<GenNet*>& from) -> const GenNet& // Read a net from a pool, retiring it once it is used up
+    {
+        if (from.empty())
+        {
+            return inputs[random.below(inputs.size())];
+        }
+        size_t index = random.below(from.size());
+        GenNet* net = from[index];
+        if (--net->usesLeft == 0)
+        {
+            from[index] = from.back();
+            from.pop_back();
+        }
+        return *net;
+    };
+
+    Emitter body; // The operation lines, written after the declarations
+    body.reserve(options.opCount * 24);
+
+    for (size_t i = 0; i < options.opCount; ++i)
+    {
+        if (random.unit() < options.registerDensity) // A register assignment, e.g., "r5 = n3"
+        {
+            const GenNet& source = take(pool);
+            registers.push_back(GenNet{"r" + to_string(i), source.width, source.isSigned, fanout});
+            body.append(registers.back().name).append(" = ").append(source.name).append('\n');
+            pool.push_back(&registers.back());
+            continue;
+        }
+
+        GenOp op = GenOp::ADD;
+        const string& key = opKeys[random.pick(opWeights, opTotal)];
+        for (int code = 0; code < 7; ++code)
+        {
+            if (key == GEN_OP_NAMES[code])
+            {
+                op = (GenOp)code;
+            }
+        }
+
+        if (op == GenOp::MUX && selectPool.empty()) // A mux needs a one-bit select, so compare first
+        {
+            op = GenOp::COMP;
+        }
+
+        if (op == GenOp::COMP) // e.g., "c7 = n1 < n4"
+        {
+            const GenNet& left = take(pool);
+            const GenNet& right = take(pool);
+            static const char* COMPARATORS[] = { ">", "<", "==" };
+
+            selects.push_back(GenNet{"c" + to_string(i), 1, false, fanout});
+            body.append(selects.back().name).append(" = ").append(left.name).append(' ').append(COMPARATORS[random.below(3)]).append(' ').append(right.name).append('\n');
+            selectPool.push_back(&selects.back());
+            continue;
+        }
+
+        wires.push_back(randomNet("n" + to_string(i)));
+        GenNet& dest = wires.back();
+        body.append(dest.name).append(" = ");
+
+        if (op == GenOp::MUX) // e.g., "n9 = c7 ? n1 : n4"
+        {
+            const GenNet& select = take(selectPool);
+            const GenNet& left = take(pool);
+            const GenNet& right = take(pool);
+            body.append(select.name).append(" ? ").append(left.name).append(" : ").append(right.name).append('\n');
+        }
+        else // e.g., "n3 = n1 + in2"
+        {
+            const GenNet& left = take(pool);
+            const GenNet& right = take(pool);
+            body.append(left.name).append(' ').append(GEN_OP_SYMBOLS[(int)op]).append(' ').append(right.name).append('\n');
+        }
+
+        pool.push_back(&dest);
+    }
+
+    // The newest nets drive the outputs, so the deepest logic stays live
+    for (size_t i = 0; i < max<size_t>(options.outputCount, 1); ++i)
+    {
+        const GenNet* source = &inputs[i % inputs.size()];
+        if (i < wires.size())
+        {
+            source = &wires[wires.size() - 1 - i];
+        }
+        outputs.push_back(GenNet{"out" + to_string(i), source->width, source->isSigned, 0});
+        body.append(outputs.back().name).append(" = ").append(source->name).append('\n');
+    }
+
+    Emitter out;
+    out.reserve(body.size() + (wires.size() + registers.size() + selects.size()) * 10 + 256);
+
+    appendDeclarations(out, "input", inputs);
+    out.append('\n');
+    appendDeclarations(out, "output", outputs);
+    out.append('\n');
+    appendDeclarations(out, "wire", selects);
+    appendDeclarations(out, "wire", wires);
+    appendDeclarations(out, "register", registers);
+    out.append('\n');
+    out.append(body.text());
+
+    netlistText = out.release();
+    return true;
+}
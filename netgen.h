@@ -0,0 +1,35 @@
+#ifndef NETGEN_H
+#define NETGEN_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// Shape of a synthetic behavioral netlist
+struct NetgenOptions
+{
+    size_t opCount = 1000; // Number of operation lines (not counting the assignments of the outputs)
+    string opMix = "add=4,sub=2,mul=1,comp=1,mux=1,shr=1,shl=1"; // Relative weight of each operator
+    string widthMix = "8=2,16=2,32=1,64=1"; // Relative weight of each bit width
+    int fanout = 2; // Number of times each generated net is read before it is retired
+    double registerDensity = 0.1; // Fraction of the operation lines that are register assignments ("r = x")
+    double signedDensity = 0.5; // Fraction of the nets declared with a signed type ("Int" rather than "UInt")
+    size_t inputCount = 8; // Number of primary inputs
+    size_t outputCount = 4; // Number of primary outputs
+    uint64_t seed = 1; // The same options and seed always give the same netlist
+};
+
+/*
+    Generate a netlist in the format of circuits/474a_circuit*.txt. Every operand is declared before it is
+    used, comparators drive one-bit wires that the muxes use as selects, and the last nets drive the outputs.
+    Return false (with error set) if a mix cannot be parsed
+*/
+bool generateNetlist(const NetgenOptions& options, string& netlistText, string& error);
+
+#endif
@@ -1,10 +1,21 @@
 #include "parser.h"
+#include "lexer.h"
+#include "cache.h"
+#include "stats.h"
+#include "cse.h"
+#include "bitwidth.h"
+#include "pipeline.h"
+#include "dpir.h"
+#include "report.h"
+#include "library.h" // Provides componentLibrary() for the cache key
 
 #include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., cin and cout)
 #include <fstream> // Provides functionality for working with files in C++ (e.g., ifstream, ofstream, and fstream)
 #include <vector> // Provides a dynamic array-like container that stores elements in contiguous memory, allowing for fast access to elements using iterators or indices. Also, it automatically handles memory allocation and resizing, making it a flexible and efficient choice for storing and manipulating collections of objects.
-#include <regex> // Provides operations for regular expressions
 #include <sstream>
+#include <cstdio> // Provides snprintf()
+#include <array>
+#include <thread>
 
 /*
     A directive that allows you to use names from the std namespace without prefixing them with ''
@@ -50,28 +61,158 @@ void NetParser::setRegister(SetNet reg) // Store a single register of SetNet obj
 	return;
 }
 
-void NetParser::setOperation(SetOp op) // Store a single operation of SetOp object into the "operations" vector
+void NetParser::setOperation(SetOp op) // Store a single operation of SetOp object into the "operations" list
 {
-	this->operations.push_back(op);
+	this->operations.push(op);
 	return;
 }
 
+void OpList::push(const SetOp& op) // Append the opcode and the operand IDs of a single operation
+{
+    OperandRange operands = op.getOperands();
+    this->opcodes.push_back(op.getOpcode());
+    this->operandIds.insert(this->operandIds.end(), operands.begin(), operands.end());
+    this->operandStart.push_back((uint32_t)this->operandIds.size());
+    if (!this->dataWidths.empty())
+    {
+        this->dataWidths.push_back(0);
+    }
+    return;
+}
+
 /*
     Store variables with their corresponding bit value
 */
-void NetParser::setVarBit(string netType, char signType, int bit, string var)
+void NetParser::setVarBit(string_view netType, char signType, int bit, string_view var)
 {
-    variableInfo info;
+    variableInfo& info = this->symbols.getInfo(this->symbols.intern(var)); // Find or create the record of the variable
     info.netType = netType;
     info.signType = signType;
     info.bitWidth = bit;
-    this->variableBits[var] = info;
     return;
 }
 
 void NetParser::setBitWidthToOne(string var)
 {
-    this->variableBits[var].bitWidth = 1;
+    this->symbols.getInfo(this->symbols.intern(var)).bitWidth = 1;
+    return;
+}
+
+int NetParser::internVar(string_view var) // Get the symbol ID of a variable used as an operand
+{
+    return this->symbols.intern(var);
+}
+
+int NetParser::internVar(string_view var, string_view suffix) // Get the symbol ID of a variable name followed by a suffix
+{
+    return this->symbols.intern(var, suffix);
+}
+
+int NetParser::internLiteral(uint64_t value) // Get the symbol ID of an integer literal used as an operand
+{
+    this->literalCount++;
+    return internConstant(this->symbols, value);
+}
+
+string_view NetParser::keepText(string_view text) // The copy lives until the next conversion starts
+{
+    return this->arena.copy(text);
+}
+
+/*
+    Store a name into the symbol table
+*/
+static uint32_t hashName(string_view first, string_view second) // 32-bit FNV-1a over the concatenation of both parts
+{
+    uint32_t hash = 2166136261u;
+    for (char c : first)
+    {
+        hash = (hash ^ (unsigned char)c) * 16777619u;
+    }
+    for (char c : second)
+    {
+        hash = (hash ^ (unsigned char)c) * 16777619u;
+    }
+    return hash;
+}
+
+static bool nameEquals(string_view name, string_view first, string_view second) // Whether name is first followed by second
+{
+    return name.size() == first.size() + second.size() &&
+           name.compare(0, first.size(), first) == 0 && name.compare(first.size(), second.size(), second) == 0;
+}
+
+size_t SymbolTable::findSlot(string_view name, uint32_t hash) const
+{
+    size_t mask = this->slots.size() - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) // Linear probing; the table is never more than half full
+    {
+        int id = this->slots[slot];
+        if (id < 0 || (this->hashes[id] == hash && this->names[id] == name))
+        {
+            return slot;
+        }
+    }
+}
+
+void SymbolTable::grow()
+{
+    size_t capacity = this->slots.empty() ? 1024 : this->slots.size() * 2;
+    size_t mask = capacity - 1;
+
+    this->slots.assign(capacity, -1);
+    for (size_t id = 0; id < this->names.size(); ++id)
+    {
+        size_t slot = this->hashes[id] & mask;
+        while (this->slots[slot] >= 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        this->slots[slot] = (int)id;
+    }
+    return;
+}
+
+int SymbolTable::intern(string_view name)
+{
+    return this->intern(name, string_view());
+}
+
+int SymbolTable::intern(string_view name, string_view suffix)
+{
+    if ((this->names.size() + 1) * 2 > this->slots.size()) // Keep the load factor at most one half
+    {
+        this->grow();
+    }
+
+    uint32_t hash = hashName(name, suffix);
+    size_t mask = this->slots.size() - 1;
+    size_t slot = hash & mask;
+    for (; this->slots[slot] >= 0; slot = (slot + 1) & mask)
+    {
+        int id = this->slots[slot];
+        if (this->hashes[id] == hash && nameEquals(this->names[id], name, suffix)) // The name is already interned
+        {
+            return id;
+        }
+    }
+
+    // The name is new, so give it an undeclared record (no net type, unsigned, zero bits)
+    int id = (int)this->names.size();
+    this->names.push_back(suffix.empty() ? this->arena->copy(name) : this->arena->concat(name, suffix));
+    this->hashes.push_back(hash);
+    this->infos.push_back(variableInfo{"", 'u', 0});
+    this->slots[slot] = id;
+
+    return id;
+}
+
+void SymbolTable::clear() // Forget every name (the arena that holds them is reset by its owner)
+{
+    this->names.clear();
+    this->hashes.clear();
+    this->slots.clear();
+    this->infos.clear();
     return;
 }
 
@@ -89,7 +230,7 @@ void NetParser::setBitWidthToOne(string var)
 /*
     The getters below are specifically for net types of input, output, wire, and register
 */
-string SetNet::getNetType() const // Getter for net type
+string_view SetNet::getNetType() const // Getter for net type
 {
     return this->netType;
 }
@@ -99,7 +240,7 @@ int SetNet::getBitWidth() const // Getter for bit-width
     return this->bitWidth;
 }
 
-string SetNet::getVarNames() const // Getter for variable names
+string_view SetNet::getVarNames() const // Getter for variable names
 {
     return this->varNames;
 }
@@ -108,14 +249,202 @@ string SetNet::getVarNames() const // Getter for variable names
 /*
     The getters below are specifically for operations
 */
-string SetOp::getOpName() const // Getter for the operator's type name
+Opcode SetOp::getOpcode() const // Getter for the operator's type
+{
+	return this->opcode;
+}
+
+OperandRange SetOp::getOperands() const // Getter for the operator's involved operands
+{
+	return OperandRange{this->operands, this->operands + this->operandCount};
+}
+
+void OpList::clear()
+{
+    this->opcodes.clear();
+    this->operandStart.assign(1, 0);
+    this->operandIds.clear();
+    this->dataWidths.clear();
+    return;
+}
+
+size_t OpList::size() const // Getter for the number of stored operations
+{
+    return this->opcodes.size();
+}
+
+bool OpList::empty() const // Check whether no operation is stored
 {
-	return this->netOperator;
+    return this->opcodes.empty();
 }
 
-vector<string> SetOp::getOperands() const // Getter for the operator's involved operands
+Opcode OpList::getOpcode(size_t index) const // Getter for the type of a single operation
 {
-	return this->operands;
+    return this->opcodes[index];
+}
+
+OperandRange OpList::getOperands(size_t index) const // Getter for the operands of a single operation without copying them
+{
+    const int* base = this->operandIds.data();
+    return OperandRange{base + this->operandStart[index], base + this->operandStart[index + 1]};
+}
+
+void OpList::setOpcode(size_t index, Opcode opcode) // Setter for the type of a single operation (Opcode::NONE drops it from the module)
+{
+    this->opcodes[index] = opcode;
+    return;
+}
+
+void OpList::setOperand(size_t index, size_t slot, int id) // Setter for a single operand of an operation
+{
+    this->operandIds[this->operandStart[index] + slot] = id;
+    return;
+}
+
+int OpList::getDataWidth(size_t index, const SymbolTable& symbols) const // Getter for the DATAWIDTH of an operation
+{
+    if (!this->dataWidths.empty() && this->dataWidths[index] != 0)
+    {
+        return this->dataWidths[index];
+    }
+    return getMaxBitWidth(getDescriptor(this->getOpcode(index)).widthRule, this->getOperands(index), symbols);
+}
+
+void OpList::setDataWidth(size_t index, int width) // Setter for the DATAWIDTH of an operation (0 restores its width rule)
+{
+    if (this->dataWidths.empty())
+    {
+        this->dataWidths.resize(this->size(), 0);
+    }
+    this->dataWidths[index] = width;
+    return;
+}
+
+void OpList::replace(size_t first, size_t last, const OpList& replacement) // Replace operations [first, last) with every operation of replacement
+{
+    uint32_t operandFirst = this->operandStart[first];
+    uint32_t operandLast = this->operandStart[last];
+    int64_t shift = (int64_t)replacement.operandIds.size() - (int64_t)(operandLast - operandFirst); // How far the operands after the range move
+
+    this->opcodes.erase(this->opcodes.begin() + first, this->opcodes.begin() + last);
+    this->opcodes.insert(this->opcodes.begin() + first, replacement.opcodes.begin(), replacement.opcodes.end());
+
+    if (!this->dataWidths.empty()) // The new operations follow their width rules
+    {
+        this->dataWidths.erase(this->dataWidths.begin() + first, this->dataWidths.begin() + last);
+        this->dataWidths.insert(this->dataWidths.begin() + first, replacement.size(), 0);
+    }
+
+    this->operandIds.erase(this->operandIds.begin() + operandFirst, this->operandIds.begin() + operandLast);
+    this->operandIds.insert(this->operandIds.begin() + operandFirst, replacement.operandIds.begin(), replacement.operandIds.end());
+
+    // The start of operation first stays, the starts of the replacement follow it, and every later start moves by shift
+    this->operandStart.erase(this->operandStart.begin() + first + 1, this->operandStart.begin() + last + 1);
+    this->operandStart.insert(this->operandStart.begin() + first + 1, replacement.operandStart.begin() + 1, replacement.operandStart.end());
+    for (size_t index = first + 1; index < first + 1 + replacement.size(); ++index)
+    {
+        this->operandStart[index] += operandFirst;
+    }
+    for (size_t index = first + 1 + replacement.size(); index < this->operandStart.size(); ++index)
+    {
+        this->operandStart[index] = (uint32_t)(this->operandStart[index] + shift);
+    }
+    return;
+}
+
+PortRole getPortRole(Opcode opcode, size_t slot)
+{
+    switch (opcode)
+    {
+        case Opcode::MUX: return slot == 1 ? PortRole::SELECT : PortRole::DATA; // sel ? a : b
+        case Opcode::SHR:
+        case Opcode::SHL: return slot == 2 ? PortRole::SHIFT_AMOUNT : PortRole::DATA; // a >> sa
+        case Opcode::REG: return PortRole::REGISTER_INPUT;
+        default: return PortRole::DATA;
+    }
+}
+
+void UseDefIndex::clear()
+{
+    this->definitions.clear();
+    this->roleMasks.clear();
+    this->useStart.clear();
+    this->uses.clear();
+    return;
+}
+
+void UseDefIndex::build(const OpList& ops, size_t symbolCount)
+{
+    size_t count = ops.size();
+
+    this->definitions.assign(symbolCount, -1);
+    this->roleMasks.assign(symbolCount, 0);
+    this->useStart.assign(symbolCount + 1, 0);
+
+    // Count the uses of every symbol, then place them (a counting sort, so no per-symbol vectors)
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::NONE) // Not emitted, so it neither drives nor reads anything
+        {
+            continue;
+        }
+
+        OperandRange operands = ops.getOperands(index);
+        this->definitions[operands[0]] = (int)index; // A later assignment overrides an earlier one, as in the emitted module
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            this->useStart[operands[slot] + 1]++;
+        }
+    }
+
+    for (size_t symbol = 0; symbol < symbolCount; ++symbol)
+    {
+        this->useStart[symbol + 1] += this->useStart[symbol];
+    }
+    this->uses.resize(this->useStart[symbolCount]);
+
+    vector<uint32_t> fill(this->useStart.begin(), this->useStart.end() - 1); // Next free slot of each symbol
+    for (size_t index = 0; index < count; ++index)
+    {
+        Opcode opcode = ops.getOpcode(index);
+        if (opcode == Opcode::NONE)
+        {
+            continue;
+        }
+
+        OperandRange operands = ops.getOperands(index);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            int symbol = operands[slot];
+            PortRole role = getPortRole(opcode, slot);
+
+            this->uses[fill[symbol]++] = SignalUse{(uint32_t)index, (uint8_t)slot, role};
+            this->roleMasks[symbol] |= (uint8_t)(1 << (int)role);
+        }
+    }
+
+    return;
+}
+
+size_t UseDefIndex::size() const
+{
+    return this->definitions.size();
+}
+
+int UseDefIndex::getDefinition(int symbol) const
+{
+    return this->definitions[symbol];
+}
+
+UseRange UseDefIndex::getUses(int symbol) const
+{
+    const SignalUse* base = this->uses.data();
+    return UseRange{base + this->useStart[symbol], base + this->useStart[symbol + 1]};
+}
+
+bool UseDefIndex::isUsedAs(int symbol, PortRole role) const
+{
+    return (this->roleMasks[symbol] & (1 << (int)role)) != 0;
 }
 
 
@@ -142,52 +471,211 @@ const vector<SetNet>& NetParser::getRegisters() const // Getter for the set of s
     return this->registers;
 }
 
-const vector<SetOp>& NetParser::getOperations() const // Getter for the set of stored operations
+const UseDefIndex& NetParser::getUseDefs() const // Getter for the use-def index of the stored operations
+{
+    return this->useDefs;
+}
+
+const OpList& NetParser::getOperations() const // Getter for the set of stored operations
 {
     return this->operations;
 }
 
 /*
-    The getter below is to retrieve the unordered map of NetParser
+    The getter below is to retrieve the symbol table of NetParser
 */
-const unordered_map<string, variableInfo>& NetParser::getVariableBits() const {
-    return variableBits;
+const SymbolTable& NetParser::getSymbols() const {
+    return symbols;
+}
+
+/*
+    The getter below is to retrieve why the last conversion failed
+*/
+const string& NetParser::getErrorMessage() const {
+    return errorMessage;
+}
+
+/*
+    The setter and getter below are for the options of the conversions
+*/
+void NetParser::setOptions(const ConvertOptions& options)
+{
+    this->options = options;
+    return;
+}
+
+const ConvertOptions& NetParser::getOptions() const
+{
+    return this->options;
+}
+
+size_t NetParser::getRemovedInstances() const // Getter for the number of instances the optimization passes removed
+{
+    return this->removedInstances;
+}
+
+const WidthSavings& NetParser::getWidthSavings() const // Getter for the instances and nets the optimization passes narrowed
+{
+    return this->widthSavings;
+}
+
+size_t NetParser::getPipelineRegisters() const // Getter for the number of registers pipelining inserted
+{
+    return this->pipelineRegisters;
+}
+
+size_t NetParser::getPipelineRegistersNeeded() const // Getter for the number of registers the pipeline stages would take
+{
+    return this->pipelineRegistersNeeded;
+}
+
+int NetParser::getPipelineLatency() const // Getter for the clock cycles pipelining added
+{
+    return this->pipelineLatency;
+}
+
+bool NetParser::isPipelineBalanced() const // Getter for whether pipelining could put every output in the last stage
+{
+    return this->pipelineBalanced;
+}
+
+const RetimeResult& NetParser::getRetiming() const // Getter for what retiming did to the registers
+{
+    return this->retiming;
+}
+
+const ScheduleResult& NetParser::getSchedule() const // Getter for the steps and units of scheduling
+{
+    return this->schedule;
+}
+
+const FoldResult& NetParser::getFolding() const // Getter for what constant folding did
+{
+    return this->folding;
+}
+
+const string& NetParser::getReport() const // Getter for the report of the last conversion
+{
+    return this->report;
+}
+
+const vector<uint32_t>& NetParser::getOperationLines() const // Getter for the netlist line of each operation
+{
+    return this->operationLines;
+}
+
+int NetParser::getLastDeclarationLine() const // Getter for the line of the last declaration (0 if there is none)
+{
+    return this->lastDeclarationLine;
+}
+
+size_t NetParser::getLiteralCount() const // Getter for the number of integer literal operands
+{
+    return this->literalCount;
+}
+
+string ConvertOptions::fingerprint() const // The cache directory itself does not change the output
+{
+    string fingerprint;
+    if (this->eliminateCommonSubexpressions)
+    {
+        fingerprint += "cse;";
+    }
+    if (this->minimizeWidths)
+    {
+        fingerprint += "width;";
+    }
+    if (this->clockPeriod > 0)
+    {
+        char text[48];
+        snprintf(text, sizeof(text), "clock=%.17g;", this->clockPeriod);
+        fingerprint += text;
+    }
+    if (this->retime)
+    {
+        fingerprint += "retime;";
+    }
+    if (this->criticalPath)
+    {
+        fingerprint += "critical;";
+    }
+    if (this->costReport)
+    {
+        fingerprint += "cost;";
+    }
+    if ((this->clockPeriod > 0 || this->retime || this->criticalPath || this->costReport) && !componentLibrary().fingerprint().empty()) // Only these read the delays and areas
+    {
+        fingerprint += "library=" + componentLibrary().fingerprint();
+    }
+    if (!this->unitLimits.empty())
+    {
+        fingerprint += "units=";
+        for (int limit : this->unitLimits)
+        {
+            fingerprint += to_string(limit) + ",";
+        }
+        fingerprint += ";";
+    }
+    return fingerprint;
+}
+
+/*
+    The getters below are specifically for the symbol table
+*/
+int SymbolTable::find(string_view name) const // Getter for the ID of a name (-1 if it was never interned)
+{
+    if (this->slots.empty())
+    {
+        return -1;
+    }
+    return this->slots[this->findSlot(name, hashName(name, string_view()))];
+}
+
+string_view SymbolTable::getName(int id) const // Getter for the name of an ID
+{
+    return this->names[id];
+}
+
+const variableInfo& SymbolTable::getInfo(int id) const // Getter for the record of an ID
+{
+    return this->infos[id];
+}
+
+variableInfo& SymbolTable::getInfo(int id) // Getter for the modifiable record of an ID
+{
+    return this->infos[id];
+}
+
+size_t SymbolTable::size() const // Getter for the number of interned names
+{
+    return this->names.size();
 }
 
 /*
     The getter below is to retrieve the largest bit width based on either the input or output
 */
-int getMaxBitWidth(int option, vector<string> operands, unordered_map<string, variableInfo> varBits)
+int getMaxBitWidth(WidthRule rule, OperandRange operands, const SymbolTable& symbols)
 {
     /*
         The width of a datapath component (except comparators) should be determined 
         by the size of the output, register, or wire to which the output of the component connects.
     */
-    if(option == 1)
+    if(rule == WidthRule::OUTPUT_WIDTH)
     {
-        for ( const auto& var : varBits ) // Iterate through the content of the unordered_map
-        {
-            if (var.first == operands[0]) // Check if the key is equal to the output alias (e.g., the "z" from "z = x + y")
-            {
-                return var.second.bitWidth; // Return the bit width of the matching operand
-            }
-        }
+        return symbols.getInfo(operands[0]).bitWidth; // Return the bit width of the output alias (e.g., the "z" from "z = x + y")
     }
     /*
         The width of comparators should be determined by the size of the largest input.
     */
-    else if(option == 2)
+    else if(rule == WidthRule::LARGEST_INPUT)
     {
         int maxBitWidth = 0;
         
-        for (const string& operand : operands) // Iterate over each element using a ranged-based for loop
+        for (size_t i = 1; i < operands.size(); ++i) // Iterate over the inputs (operand 0 is the output)
         {
-            for ( const auto& var : varBits ) // Iterate through the content of the unordered_map
-            {
-                if (var.first == operand && var.second.bitWidth > maxBitWidth) // Check if the key is equal to the current operand
-                {                    
-                    maxBitWidth = var.second.bitWidth;
-                }
+            if (symbols.getInfo(operands[i]).bitWidth > maxBitWidth) // Check the bit width of the current operand
+            {                    
+                maxBitWidth = symbols.getInfo(operands[i]).bitWidth;
             }
         }
 
@@ -203,14 +691,9 @@ int getMaxBitWidth(int option, vector<string> operands, unordered_map<string, va
 /*
     Checking Functions
 */
-bool checkBitWidth(const string& input) // Check if the bitwidth is valid
+bool checkBitWidth(string_view input, char& signType, int& numBits) // Check if the bitwidth is valid, and extract its sign type and number of bits
 {
-    regex pattern("(Int|UInt)([0-9]+)"); // Define the pattern to match
-    smatch matches; // Store any matches from the regex
-
-    if (regex_search(input, matches, pattern)) { // Check whether the input matches the pattern
-
-        int numBits = stoi(matches[2].str()); // Extract the number of bits as an integer
+    if (parseTypeToken(input, signType, numBits)) { // Check whether the input is "Int<N>" or "UInt<N>"
 
         if (numBits == 1) {
             // Handle the special case when numBits is 1
@@ -231,85 +714,118 @@ bool checkBitWidth(const string& input) // Check if the bitwidth is valid
         }
     }
 
-    cout << "No match found. Please use correct the format in the behavioral netlist." << endl;
+    cout << "No match found. Please use correct the format in the behavioral netlist." << endl;
+    return false;
+}
+
+bool checkOutput(const NetLine& line, NetParser& netParser) // Check whether the current line of operation requires additional wire and register to be created
+{
+    // A plain assignment (e.g., "x = xwire") has exactly three tokens and becomes a register by itself
+    if( line.tokenCount != 3 )
+    {
+        string_view outputVar = line.tokens[0];
+        int id = netParser.getSymbols().find(outputVar); // Look up the first token of the line
+
+        // Check if the first token was declared as an "output"
+        if (id >= 0 && netParser.getSymbols().getInfo(id).netType == "output")
+        {
+            variableInfo var = netParser.getSymbols().getInfo(id); // Copy the record since setVarBit may grow the symbol table
+            int wireId = netParser.internVar(outputVar, "wire");
+            string_view wireName = netParser.getSymbols().getName(wireId); // Stored in the arena, so the SetNet can keep the view
+
+            /*
+                the bit width is subtracted by 1 because that is how it will be used in the Verilog code (e.g., Int64 becomes [63:0] in Verilog)
+
+                the variable is concatenated with a string called "wire" to differentiate between the wire and register aliases
+                the wire takes the sign type of the output that it drives
+            */
+            netParser.setVarBit("wire", var.signType, var.bitWidth, wireName);
+            netParser.setWire(SetNet("wire", var.bitWidth, wireName));
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool isSigned(OperandRange operands, const SymbolTable& symbols) // Check whether any of the inputs are signed
+{
+    for (size_t i = 1; i < operands.size(); ++i)
+    {
+        if (symbols.getInfo(operands[i]).signType == 's') // Check the sign type of the input (e.g., the "x" and "y" from "z = x + y")
+        {
+            return true;
+        }
+    }
+
     return false;
 }
 
-bool checkOutput(string line, NetParser& netParser) // Check whether the current line of operation requires additional wire and register to be created
+/*
+    Integer literal operands, e.g., the "8" of "d = a * 8". Each value is a symbol of its own, which reads like an
+    unsigned net of the smallest declarable width that holds it, and is named as that Verilog literal (e.g., "4'd8"),
+    so an instance port that reads it needs no change, and every use of a value shares its symbol
+*/
+bool parseLiteral(string_view token, uint64_t& value) // Check whether the token is all decimal digits, and extract its value
 {
-    istringstream ss(line); // Create a string stream to read
-    string outputVar;
-    string token; // Store the token
-    char signType; // Store the sign type
-
-    ss >> outputVar;
-
-    int tokenCount = 0; // Count the tokens inside the string
-    while (getline(ss, token, ' '))
+    if (token.empty())
     {
-        tokenCount++;
+        return false;
     }
 
-    // Check the number of tokens
-    if( tokenCount != 3 )
+    value = 0;
+    for (char c : token)
     {
-        for ( const auto& var : netParser.getVariableBits() ) // Iterate through the content of the unordered_map
+        if (c < '0' || c > '9' || value > (UINT64_MAX - (uint64_t)(c - '0')) / 10) // Not a digit, or the value would overflow
         {
-            // Check if the key is equal to the first token "output"
-            if (var.first == outputVar && var.second.netType == "output")
-            {
-                /*
-                    the bit width is subtracted by 1 because that is how it will be used in the Verilog code (e.g., Int64 becomes [63:0] in Verilog)
-
-                    the variable is concatenated with a string called "wire" to differentiate between the wire and register aliases
-                */
-                netParser.setVarBit("wire", signType, var.second.bitWidth, var.first+"wire");
-                netParser.setWire(SetNet("wire", var.second.bitWidth, var.first+"wire"));
-
-                return true;
-            }
+            return false;
         }
+        value = value * 10 + (uint64_t)(c - '0');
     }
-
-    return false;
+    return true;
 }
 
-bool isSigned(vector<string> operands, unordered_map<string, variableInfo> varBits) // Check whether any of the inputs are signed
+int getLiteralWidth(uint64_t value) // The fewest bits that hold value, rounded up to a power of two like every declared width
 {
-    for (size_t i = 1; i < operands.size(); ++i)
+    int bitWidth = 1;
+    while (bitWidth < 64 && (value >> bitWidth) != 0)
     {
-        for ( const auto& var : varBits ) // Iterate through the content of the unordered_map
-        {
-            if (var.first == operands[i] && var.second.signType == 's') // Check if the key is equal to the output alias (e.g., the "z" from "z = x + y")
-            {
-                return true; // Return the bit width of the matching operand
-            }
-        }
+        bitWidth *= 2;
     }
+    return bitWidth;
+}
 
-    return false;
+int internConstant(SymbolTable& symbols, uint64_t value)
+{
+    char name[32];
+    int bitWidth = getLiteralWidth(value);
+    snprintf(name, sizeof(name), "%d'd%llu", bitWidth, (unsigned long long)value);
+
+    int id = symbols.intern(name);
+    variableInfo& info = symbols.getInfo(id);
+    info.netType = CONSTANT;
+    info.signType = 'u'; // A literal is unsigned, like every net that an instance reads
+    info.bitWidth = bitWidth;
+    return id;
+}
+
+uint64_t getConstantValue(int id, const SymbolTable& symbols)
+{
+    string_view name = symbols.getName(id);
+    uint64_t value = 0;
+    parseLiteral(name.substr(name.find('d') + 1), value); // The digits after "'d"
+    return value;
 }
 
 /*
     Create Functions
 */
-void createRegister(string line, NetParser& np)
+void createRegister(const NetLine& line, NetParser& np)
 {
-    istringstream opStream(line); // Initialize a stream from a string and then parse it (purposely for >>)
-	string tempOp; // Declare string variable to store token
-	vector<string> tempOps; // Vector to store dynamically created string variables
-    int tokenCount = 0; // Count number of tokens
-
-	while(opStream >> tempOp) // Loop while opStream is not empty
-	{
-		if(tempOp != "=" && tempOp != ":") // Skip over any token that is an equal sign
-		{
-        	tempOps.push_back(tempOp); // Store the token in the vector
-		}
-        tokenCount++; // Increment the counter
-    }
-    vector<string> tempVec {tempOps[0], tempOps[0]+"wire"}; // Temporary vector
-    np.setOperation(SetOp("REG",tempVec)); // Create the register operation
+    string_view outputVar = line.tokens[0]; // The output that the register drives
+    int ids[2] = {np.internVar(outputVar), np.internVar(outputVar, "wire")}; // Symbol IDs of the register output and input
+    np.setOperation(SetOp(Opcode::REG, ids, 2)); // Create the register operation
 
     return;
 }
@@ -326,27 +842,144 @@ void createRegister(string line, NetParser& np)
 
 */
 
+const size_t EMIT_CHUNK_OPERATIONS = 32768; // Fewest operations worth a formatting thread of their own
+
+// Format the instances of operations [first, last); operationCounts holds the number of instances emitted before first
+static void printInstanceRange(Emitter& file, const OpList& operations, size_t first, size_t last, int* operationCounts, const SymbolTable& symbols, const UseDefIndex& useDefs)
+{
+    for (size_t index = first; index < last; ++index) // Loop through each operation
+    {
+        Opcode opcode = operations.getOpcode(index);
+
+        if (opcode != Opcode::NONE && operations.isWiring(index, symbols)) // A shift by a constant takes no instance, and no instance number
+        {
+            operations.printWiring(file, index, symbols, useDefs);
+        }
+        else if(opcode != Opcode::NONE) // Unrecognized operations are not emitted
+        {
+            int& count = operationCounts[getDescriptor(opcode).counter];
+            count += 1;
+            // The count is used as a unique ID for the created module
+            operations.printOperation(file, index, count, symbols); // Write each operation to the output file
+        }
+    }
+    return;
+}
+
+/*
+    Format the instances, split into contiguous chunks that are formatted concurrently into buffers of their own.
+    The instance numbers of each chunk start where the previous chunks leave off (a prefix sum of the per-chunk
+    counts), and the buffers are appended in chunk order, so the text is identical to a serial pass
+*/
+static void printInstances(Emitter& file, const OpList& operations, const SymbolTable& symbols, const UseDefIndex& useDefs, unsigned threadCount)
+{
+    size_t count = operations.size();
+    if (threadCount == 0)
+    {
+        threadCount = thread::hardware_concurrency() == 0 ? 1 : thread::hardware_concurrency();
+    }
+
+    size_t chunkCount = min((size_t)threadCount, (count + EMIT_CHUNK_OPERATIONS - 1) / EMIT_CHUNK_OPERATIONS);
+    if (chunkCount <= 1)
+    {
+        int operationCounts[COUNTER_COUNT] = {}; // Number of instances emitted so far for each instance name
+        printInstanceRange(file, operations, 0, count, operationCounts, symbols, useDefs);
+        return;
+    }
+
+    vector<size_t> chunkStart(chunkCount + 1);
+    for (size_t chunk = 0; chunk <= chunkCount; ++chunk)
+    {
+        chunkStart[chunk] = count * chunk / chunkCount;
+    }
+
+    // The instances named before each chunk (an exclusive prefix sum of the instances in each chunk)
+    vector<array<int, COUNTER_COUNT>> startCounts(chunkCount);
+    array<int, COUNTER_COUNT> running = {};
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        startCounts[chunk] = running;
+        for (size_t index = chunkStart[chunk]; index < chunkStart[chunk + 1]; ++index)
+        {
+            Opcode opcode = operations.getOpcode(index);
+            if (opcode != Opcode::NONE && !operations.isWiring(index, symbols))
+            {
+                running[getDescriptor(opcode).counter]++;
+            }
+        }
+    }
+
+    // The first chunk goes straight into the file, the others into their own buffers
+    vector<Emitter> buffers(chunkCount);
+    vector<thread> workers;
+    workers.reserve(chunkCount - 1);
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+    {
+        workers.emplace_back([&operations, &symbols, &useDefs, &chunkStart, &startCounts, &buffers, chunk]
+        {
+            DPGEN_SPAN(chunkSpan, "instances chunk");
+            buffers[chunk].reserve(96 * (chunkStart[chunk + 1] - chunkStart[chunk]));
+            printInstanceRange(buffers[chunk], operations, chunkStart[chunk], chunkStart[chunk + 1], startCounts[chunk].data(), symbols, useDefs);
+        });
+    }
+
+    printInstanceRange(file, operations, chunkStart[0], chunkStart[1], startCounts[0].data(), symbols, useDefs);
+
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+    {
+        workers[chunk - 1].join();
+        file.append(buffers[chunk].text());
+    }
+    return;
+}
+
 /*
     Creates the Verilog file given the results from the convertExpression
     convertDeclaration functions.
 */
-void writeToOutput(string verilogFile, NetParser &netParser)
+string writeToOutput(const string& moduleName, NetParser &netParser)
 {
-	ofstream file(verilogFile); // Open the output file
+	Emitter file; // Generate the whole file in memory, so an unchanged output does not have to be rewritten
+    const OpList& operations = netParser.getOperations();
+
+    file.reserve(256 + 96 * operations.size()); // An instance line is rarely longer than this, so the buffer seldom grows
+
+    printModuleHead(file, moduleName, netParser); // Everything up to the first instance
+
+    DPGEN_SPAN(sectionSpan, "instances");
+    if(!operations.empty())
+    {
+        printInstances(file, operations, netParser.getSymbols(), netParser.getUseDefs(), netParser.getOptions().emitThreads); // Write each operation to the output file
+    }
+
+    if (netParser.getSchedule().scheduled) // The controller that steps the shared units through the schedule
+    {
+        printStateMachine(file, netParser.getSchedule(), netParser.getSymbols());
+    }
+
+	file.append("\nendmodule");
 
+	return file.release();
+}
+
+/*
+    Write the time unit, the ports, the wires, and the registers of the module, which come before the instances
+*/
+void printModuleHead(Emitter& file, const string& moduleName, const NetParser& netParser)
+{
     // Create a reference to a vector of object corresponding to its net type using the referenced "netParser" instance
     const vector<SetNet>& inputs = netParser.getInputs();
     const vector<SetNet>& outputs = netParser.getOutputs();
     const vector<SetNet>& wires = netParser.getWires();
     const vector<SetNet>& registers = netParser.getRegisters();
-    const vector<SetOp>& operations = netParser.getOperations();
 
-    unordered_map<string, variableInfo> varBits = netParser.getVariableBits(); // Get the collection of variables
+    const SymbolTable& symbols = netParser.getSymbols(); // Get the collection of variables
 
     // Write the time unit and module header to the output file 
-	file << "`timescale 1ns / 1ps" << "\n" << endl;
-	file << "module " << verilogFile << " (" << endl;
-    file << "\t" << "input Clk, Rst," << endl;
+    DPGEN_SPAN(sectionSpan, "ports");
+	file.append("`timescale 1ns / 1ps\n\n");
+	file.append("module ").append(moduleName).append(" (\n");
+    file.append("\tinput Clk, Rst,\n");
 
     if(!inputs.empty())
     {
@@ -372,373 +1005,384 @@ void writeToOutput(string verilogFile, NetParser &netParser)
             */
             if ( outputs.size() != 1 || &output != &outputs.back() )
             { // Check whether current output is the last element of outputs
-                file << "," << endl;
+                file.append(",\n");
             }
             
         }
     }
-    file << "\n" << ");" << endl;
+    file.append("\n);\n");
 
+    DPGEN_SPAN_RESTART(sectionSpan, "wires");
     if(!wires.empty())
     {
         for (const SetNet& wire : wires) // Loop through each wire object
         {
-            // cout << "NetType: " << wire.getNetType() << ", Bitwidth: " << wire.getBitWidth() << ", VarNames: " << wire.getVarNames() << endl;
-            wire.printWire(file, operations); // Write each wire to the output file
+            wire.printWire(file, netParser.getUseDefs(), symbols); // Write each wire to the output file
         }
-        file << endl;
+        file.append('\n');
     }
 
+    DPGEN_SPAN_RESTART(sectionSpan, "registers");
     if(!registers.empty())
     {
         for (const SetNet& reg : registers) // Loop through each register object
         {
-            reg.printRegister(file); // Write each register to the output file
-        }
-        file << endl;
-    }
-    
-    if(!operations.empty())
-    {
-        unordered_map<string, int> operationCounts = {
-            {"ADD", 0},
-            {"SUB", 0},
-            {"MUL", 0},
-            {"COMP", 0},
-            {"MUX", 0},
-            {"SHR", 0},
-            {"SHL", 0},
-            {"REG", 0}
-        };
-
-        for (size_t index = 0; index < operations.size(); ++index) // Loop through each operation object
-        {
-            const SetOp& operation = operations[index]; // Store a single operation object
-
-            if(operation.getOpName() == "ADD")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "SUB")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "MUL")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "GT")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "LT")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "EQ")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "MUX")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "SHR")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "SHL")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
-            else if(operation.getOpName() == "REG")
-            {
-                operationCounts[operation.getOpName()] += 1;
-                // The 'index' is used as a unique ID for the created module
-                operation.printOperation(file, operationCounts[operation.getOpName()], varBits); // Write each operation to the output file
-            }
+            reg.printRegister(file, symbols); // Write each register to the output file
         }
+        file.append('\n');
     }
 
-	file << "\n" << "endmodule";
-
-	return;
+    return;
 }
 
 
 /*
     Print each net types to the output file
 */
-void SetNet::printInput(ofstream& file) const
+static void printRange(Emitter& file, int bitWidth) // e.g., " [7:0] " for 8 bits
 {
-    file << "\t" << this->getNetType() << " [" << this->getBitWidth()-1 << ":0] " << this->getVarNames() << "," << endl;
+    file.append(" [").appendInt(bitWidth - 1).append(":0] ");
     return;
 }
 
-void SetNet::printOutput(ofstream& file) const
+void SetNet::printInput(Emitter& file) const
 {
-    file << "\t" << this->getNetType() << " [" << this->getBitWidth()-1 << ":0] " << this->getVarNames();
+    file.append('\t').append(this->getNetType());
+    printRange(file, this->getBitWidth());
+    file.append(this->getVarNames()).append(",\n");
     return;
 }
 
-void SetNet::printWire(ofstream& file, vector<SetOp> ops) const
+void SetNet::printOutput(Emitter& file) const
 {
-    istringstream ss(this->getVarNames());
-    vector<string> vars; // Vector to store dynamically created string variables
-    string var; // Store a single variable
-    vector<string> oneBitVars; // Store variables that only require a single bit
-    string str1; // Store the one bit variables
-    string str2; // Store the multi-bit variables
-    bool isOneBit = false;
+    file.append('\t').append(this->getNetType());
+    printRange(file, this->getBitWidth());
+    file.append(this->getVarNames());
+    return;
+}
 
-    while ( getline(ss, var, ',') ) // Loop the variables
+static void appendNames(Emitter& file, const vector<string_view>& names) // e.g., "a, b, c"
+{
+    for (size_t i = 0; i < names.size(); ++i)
     {
-        // Trim leading and trailing whitespaces from var
-        var.erase(0, var.find_first_not_of(" \t\r\n"));
-        var.erase(var.find_last_not_of(" \t\r\n") + 1);
-
-        vars.push_back(var); // Store the token in the vector
+        if (i != 0)
+        {
+            file.append(", ");
+        }
+        file.append(names[i]);
     }
+    return;
+}
 
-    for ( auto it = vars.begin(); it != vars.end(); ) // Separate any wire that is only required one bit of width from the multi-bit width
+static void splitNames(string_view names, vector<string_view>& vars) // Split "a, b, c" into the trimmed variable names
+{
+    while (!names.empty())
     {
-        const string& currentVar = *it; // Assigns a constant reference to the current string element pointed to by the iterator 
+        size_t comma = names.find(',');
+        string_view var = names.substr(0, comma);
+        names = comma == string_view::npos ? string_view() : names.substr(comma + 1);
 
-        for (const SetOp& operation : ops) // Iterate through the referenced 'operations' vector
-        {
-            const vector<string>& operands = operation.getOperands(); // Access the vector of operands for each SetOp object
-
-            if (operands[1] == currentVar && operation.getOpName() == "MUX")
-            {
-                oneBitVars.push_back(currentVar); // Store 'currentVar' to the 'oneBitVars' vector
-                it = vars.erase(it);  // Remove 'currentVar' from 'vars' and update the iterator
-                isOneBit = true;
-                break;
-            }
-        }
-        if(isOneBit)
+        size_t first = var.find_first_not_of(" \t\r\n");
+        if (first == string_view::npos)
         {
-            break;
+            continue;
         }
-        ++it;
+        vars.push_back(var.substr(first, var.find_last_not_of(" \t\r\n") + 1 - first));
     }
+    return;
+}
 
-    // for (const auto& token : vars) {
-    //     cout << "Variable: " << token << endl;
-    // }
-
-    // for (const auto& token : oneBitVars) {
-    //     cout << "Variable: " << token << endl;
-    // }
-
+// Declare vars with the width of each in the symbol table, one declaration per width (in order of first appearance)
+static void printByWidth(Emitter& file, string_view netType, const vector<string_view>& vars, const SymbolTable& symbols)
+{
+    vector<int> widths;
+    for (string_view var : vars)
+    {
+        int id = symbols.find(var);
+        widths.push_back(id >= 0 ? symbols.getInfo(id).bitWidth : 0);
+    }
 
-    if (!oneBitVars.empty())
+    vector<uint8_t> printed(vars.size(), 0);
+    for (size_t i = 0; i < vars.size(); ++i)
     {
-        for (size_t i = 0; i < oneBitVars.size(); ++i) // Store the one bit variables into a single string
+        if (printed[i])
         {
-            str1 += oneBitVars[i];
-            if (i != oneBitVars.size() - 1) { // Add comma if not the last element
-                str1 += ",";
-            }
+            continue;
         }
 
-        file << "\t" << this->getNetType() << str1 << ";" << endl; // Write the one bit variable into the output file
-
-        for (size_t i = 0; i < vars.size(); ++i) // Store the multi-bit variables into a single string
+        vector<string_view> group;
+        for (size_t j = i; j < vars.size(); ++j)
         {
-            str2 += vars[i];
-            if (i != vars.size() - 1) { // Add comma if not the last element
-                str2 += ",";
+            if (!printed[j] && widths[j] == widths[i])
+            {
+                group.push_back(vars[j]);
+                printed[j] = 1;
             }
         }
 
-        file << "\t" << this->getNetType() << " [" << this->getBitWidth()-1 << ":0] " << str2 << ";" << endl; // Write the multi-bit variable into the output file
-    } else
-    {
-        file << "\t" << this->getNetType() << " [" << this->getBitWidth()-1 << ":0] " << this->getVarNames() << ";" << endl; // Write the multi-bit variable into the output file
+        file.append('\t').append(netType);
+        printRange(file, widths[i]);
+        appendNames(file, group);
+        file.append(";\n");
     }
-
     return;
 }
 
-void SetNet::printRegister(ofstream& file) const
+static bool isNarrowed(string_view var, int bitWidth, const SymbolTable& symbols) // Declared narrower than its group (dpgen --min-width)
 {
-    file << "\t" << this->getNetType() << " [" << this->getBitWidth()-1 << ":0] " << this->getVarNames() << ";" << endl;
-    return;
+    int id = symbols.find(var);
+    return id >= 0 && symbols.getInfo(id).bitWidth != bitWidth;
 }
 
-void SetOp::printOperation(ofstream& file, int indexOp, unordered_map<string, variableInfo> varBits) const
+void SetNet::printWire(Emitter& file, const UseDefIndex& useDefs, const SymbolTable& symbols) const
 {
-    int maxBitWidth;
-    bool signType = false;
+    vector<string_view> names;
+    vector<string_view> oneBitVars; // Wires used as the select of a MUX, which only require a single bit
+    vector<string_view> vars; // The multi-bit wires
+    bool narrowed = false;
 
-    signType = isSigned(this->getOperands(), varBits);
-
-    if( this->getOpName() == "ADD")
+    splitNames(this->getVarNames(), names);
+    for (string_view var : names)
     {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
-
-        /*
-            Following the format:  ADD #(.DATAWIDTH(8)) ADD1(a, b, d); // d = a + b
-        */
-        if(signType) // If the either is a signed type
+        int id = symbols.find(var);
+        if (id >= 0 && (size_t)id < useDefs.size() && useDefs.isUsedAs(id, PortRole::SELECT)) // Check whether the variable is the select of a MUX
         {
-            file << "\t" << "S" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] <<");" << endl;
+            oneBitVars.push_back(var);
         }
         else
         {
-            file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ");" << endl;
+            vars.push_back(var);
+            narrowed = narrowed || isNarrowed(var, this->getBitWidth(), symbols);
         }
     }
-    else if( this->getOpName() == "SUB")
+
+    if (oneBitVars.empty() && !narrowed) // Write the declaration as it is
     {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
+        file.append('\t').append(this->getNetType());
+        printRange(file, this->getBitWidth());
+        file.append(this->getVarNames()).append(";\n");
+        return;
+    }
 
-        /*
-            Following the format: SUB #(.DATAWIDTH(16)) SUB1 (f, d, xwire); // xwire = f - d
-        */
-        if(signType)
-        {
-            file << "\t" << "S" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ");" << endl;
-        }
-        else
-        {
-            file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "("<< this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ");" << endl;
-        }
+    if (!oneBitVars.empty()) // Write the one bit variables into the output file
+    {
+        file.append('\t').append(this->getNetType()).append(' ');
+        appendNames(file, oneBitVars);
+        file.append(";\n");
     }
-    else if( this->getOpName() == "MUL")
+
+    if (narrowed) // Write the multi-bit variables into the output file, one declaration per width
+    {
+        printByWidth(file, this->getNetType(), vars, symbols);
+    }
+    else if (!vars.empty()) // Write the multi-bit variables into the output file
     {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
+        file.append('\t').append(this->getNetType());
+        printRange(file, this->getBitWidth());
+        appendNames(file, vars);
+        file.append(";\n");
+    }
 
-        /*
-            Following the format: MUL #(.DATAWIDTH(16)) MUL1 (a, c, f); // f = a * c
-        */
-        if(signType)
-        {
-            file << "\t" << "S" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ");" << endl;
-        }
-        else
-        {
-            file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ") " << ");" << endl;
-        }
+    return;
+}
+
+void SetNet::printRegister(Emitter& file, const SymbolTable& symbols) const
+{
+    vector<string_view> names;
+    splitNames(this->getVarNames(), names);
+
+    bool narrowed = false;
+    for (string_view var : names)
+    {
+        narrowed = narrowed || isNarrowed(var, this->getBitWidth(), symbols);
     }
-    else if( this->getOpName() == "GT")
+
+    if (narrowed)
     {
-        maxBitWidth = getMaxBitWidth(2, this->getOperands(), varBits); // Get the maximum bit width for the module based on the largest input size
+        printByWidth(file, this->getNetType(), names, symbols);
+        return;
+    }
 
-        /*
-            Following the format: COMP #(.DATAWIDTH(32)) COMP_2(d, e, bGTc, 1'b0, 1'b0); // dLTe = b > c
-        */
-        if(signType)
+    file.append('\t').append(this->getNetType());
+    printRange(file, this->getBitWidth());
+    file.append(this->getVarNames()).append(";\n");
+    return;
+}
+
+// The fixed text of each instance template, built once from the descriptor table
+struct InstanceText
+{
+    string head; // e.g., "\tADD #(.DATAWIDTH("
+    string signedHead; // e.g., "\tSADD #(.DATAWIDTH(", same as head when the module has no signed variant
+    string name; // e.g., ")) ADD"
+};
+
+static const InstanceText* getInstanceText(Opcode opcode)
+{
+    static const vector<InstanceText> texts = []
+    {
+        vector<InstanceText> built(OPCODE_COUNT);
+        for (int code = 0; code < OPCODE_COUNT; ++code)
         {
-            file << "\t" << "S" << "COMP" << " #(.DATAWIDTH(" << maxBitWidth << ")) " << "COMP" << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ", 1\'b0, 1\'b0" << ");" << endl;
+            const OpDescriptor& desc = OP_DESCRIPTORS[code];
+            built[code].head = string("\t") + desc.module + " #(.DATAWIDTH(";
+            built[code].signedHead = desc.signedModule != nullptr ? string("\t") + desc.signedModule + " #(.DATAWIDTH(" : built[code].head;
+            built[code].name = string(")) ") + desc.name;
         }
-        else
+        return built;
+    }();
+
+    return &texts[(int)opcode];
+}
+
+void OpList::printOperation(Emitter& file, size_t index, int indexOp, const SymbolTable& symbols) const
+{
+    this->printInstanceHead(file, index, symbols);
+    file.appendInt(indexOp);
+    this->printInstancePorts(file, index, symbols);
+    return;
+}
+
+void OpList::printInstanceHead(Emitter& file, size_t index, const SymbolTable& symbols) const
+{
+    Opcode opcode = this->getOpcode(index);
+    const OpDescriptor& desc = getDescriptor(opcode); // Module name, port order, and width rule of the operation
+    const InstanceText* text = getInstanceText(opcode);
+    OperandRange operands = this->getOperands(index);
+
+    int maxBitWidth = this->getDataWidth(index, symbols); // Get the bit width for the module based on the output or the largest input (or a width pass)
+    bool signType = desc.signedModule != nullptr && isSigned(operands, symbols); // Only modules with a signed variant use it
+
+    /*
+        Following the format: ADD #(.DATAWIDTH(8)) ADD1(a, b, d); // d = a + b
+        The order of the ports comes from the descriptor of the opcode (see OP_DESCRIPTORS)
+    */
+    file.append(signType ? text->signedHead : text->head).appendInt(maxBitWidth).append(text->name);
+    return;
+}
+
+void OpList::printInstancePorts(Emitter& file, size_t index, const SymbolTable& symbols) const
+{
+    const OpDescriptor& desc = getDescriptor(this->getOpcode(index));
+    OperandRange operands = this->getOperands(index);
+
+    file.append('(');
+    for (const int8_t* port = desc.ports; *port != PORT_END; ++port)
+    {
+        if (port != desc.ports) // Separate the ports
         {
-            file << "\t" << "COMP" << " #(.DATAWIDTH(" << maxBitWidth << ")) " << "COMP" << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ", " << this->getOperands()[0] << ", 1\'b0, 1\'b0" << ");" << endl;
+            file.append(", ");
         }
-    }
-    else if( this->getOpName() == "LT")
-    {
-        maxBitWidth = getMaxBitWidth(2, this->getOperands(), varBits); // Get the maximum bit width for the module based on the largest input size
 
-        /*
-            Following the format: COMP #(.DATAWIDTH(32)) COMP_2(d, e, 1'b0, dLTe, 1'b0); // dLTe = d < e
-        */
-        if(signType)
+        if (*port == PORT_CLK_RST)
+        {
+            file.append("Clk, Rst");
+        }
+        else if (*port == PORT_ZERO)
         {
-            file << "\t" << "S" << "COMP" << " #(.DATAWIDTH(" << maxBitWidth << ")) " << "COMP" << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ",  1\'b0, " << this->getOperands()[0] << ", 1\'b0" << ");" << endl;
+            file.append("1\'b0");
         }
         else
         {
-            file << "\t" << "COMP" << " #(.DATAWIDTH(" << maxBitWidth << ")) " << "COMP" << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ",  1\'b0, " << this->getOperands()[0] << ", 1\'b0" << ");" << endl;
+            file.append(symbols.getName(operands[*port]));
         }
     }
-    else if( this->getOpName() == "EQ")
+
+    file.append(");\n");
+
+    return;
+}
+
+bool OpList::isWiring(size_t index, const SymbolTable& symbols) const
+{
+    Opcode opcode = this->getOpcode(index);
+    OperandRange operands = this->getOperands(index);
+    return (opcode == Opcode::SHR || opcode == Opcode::SHL) && operands.size() == 3 && symbols.getInfo(operands[2]).netType == CONSTANT;
+}
+
+static void appendBits(Emitter& file, string_view name, int high, int low, int bitWidth) // e.g., "a[5:2]", "a[3]", or "a" for all of its bits
+{
+    file.append(name);
+    if (low == 0 && high == bitWidth - 1)
+    {
+        return;
+    }
+    file.append('[').appendInt(high);
+    if (high != low)
     {
-        maxBitWidth = getMaxBitWidth(2, this->getOperands(), varBits); // Get the maximum bit width for the module based on the largest input size
+        file.append(':').appendInt(low);
+    }
+    file.append(']');
+    return;
+}
 
-        /*
-            Following the format: COMP #(.DATAWIDTH(32)) COMP_2(d, e, 1'b0, 1'b0, fEQg); // dLTe = f == g
-        */
-        if(signType)
+/*
+    A shift by a constant moves bits without any logic, so it is emitted as an assign of the bits that the instance
+    would compute: the source is truncated or zero-extended to DATAWIDTH bits, shifted, and the DATAWIDTH bits of the
+    result go into the output (e.g., "\tassign d = a[7:3];\n" for "d = a >> 3" at 8 bits)
+*/
+void OpList::printWiring(Emitter& file, size_t index, const SymbolTable& symbols, const UseDefIndex& useDefs) const
+{
+    OperandRange operands = this->getOperands(index);
+    bool shiftRight = this->getOpcode(index) == Opcode::SHR;
+    int dataWidth = this->getDataWidth(index, symbols);
+    uint64_t mask = dataWidth >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << dataWidth) - 1;
+    uint64_t amount = getConstantValue(operands[2], symbols) & mask; // The shift amount port has DATAWIDTH bits as well
+
+    int source = operands[1];
+    const variableInfo& info = symbols.getInfo(source);
+    int bitWidth = info.bitWidth;
+    if (info.netType == WIRE && (size_t)source < useDefs.size() && useDefs.isUsedAs(source, PortRole::SELECT))
+    {
+        bitWidth = 1; // Declared with a single bit (see SetNet::printWire())
+    }
+
+    file.append("\tassign ").append(symbols.getName(operands[0])).append(" = ");
+    if (amount >= (uint64_t)dataWidth) // Every bit is shifted out
+    {
+        file.appendInt(dataWidth).append("'d0");
+    }
+    else if (info.netType == CONSTANT && (shiftRight || dataWidth <= 64)) // The bits of a literal cannot be selected, so write the result as a literal
+    {
+        uint64_t value = getConstantValue(source, symbols) & mask;
+        value = amount >= 64 ? 0 : shiftRight ? value >> amount : (value << amount) & mask;
+        file.appendInt(dataWidth).append("'d").append(to_string(value));
+    }
+    else if (shiftRight)
+    {
+        int high = min(bitWidth, dataWidth) - 1;
+        if ((int)amount > high)
         {
-            file << "\t" << "S" << "COMP" << " #(.DATAWIDTH(" << maxBitWidth << ")) " << "COMP" << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ",  1\'b0, 1\'b0, " << this->getOperands()[0] << ");" << endl;
+            file.appendInt(dataWidth).append("'d0");
         }
         else
         {
-            file << "\t" << "COMP" << " #(.DATAWIDTH(" << maxBitWidth << ")) " << "COMP" << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[2] << ",  1\'b0, 1\'b0, " << this->getOperands()[0] << ");" << endl;
+            appendBits(file, symbols.getName(source), high, (int)amount, bitWidth);
         }
     }
-    else if( this->getOpName() == "MUX")
+    else
     {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
-
-        /*
-            Following the format: MUX2x1 #(.DATAWIDTH(32)) MUX_1(d, e, dLTe, g); // g = dLTe ? d : e
-        */
-        if(signType)
+        int kept = min(bitWidth, dataWidth - (int)amount); // The source bits that stay inside DATAWIDTH
+        if (amount != 0)
         {
-            file << "\t" << "S" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[2] << ", " << this->getOperands()[3] << ", " << this->getOperands()[1] << ", " << this->getOperands()[0] << ");" << endl;
+            file.append('{');
         }
-        else
+        if (info.netType == CONSTANT) // Into more than 64 bits, so the kept bits of the literal are a literal of their own
         {
-            file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[2] << ", " << this->getOperands()[3] << ", " << this->getOperands()[1] << ", " << this->getOperands()[0] << ");" << endl;
+            uint64_t value = getConstantValue(source, symbols);
+            kept = min(kept, 64);
+            file.appendInt(kept).append("'d").append(to_string(kept >= 64 ? value : value & (((uint64_t)1 << kept) - 1)));
         }
-    }
-    else if( this->getOpName() == "SHR")
-    {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
-
-        /*
-            Following the format: SHR #(.DATAWIDTH(32)) SHR2(l2div2, l2div4, sa); // l2div4 = l2div2 >> sa
-        */
-        file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[0] << ", " << this->getOperands()[2] << ");" << endl;
-    }
-    else if( this->getOpName() == "SHL")
-    {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
-
-        /*
-            Following the format: SHL #(.DATAWIDTH(32)) SHL_1(g, xwire, {31'b0, dLTe}); // xwire = g << dLTe
-        */
-        file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", " << this->getOperands()[0] << ", " << this->getOperands()[2] << ");" << endl;
-    }
-    else if( this->getOpName() == "REG" )
-    {
-        maxBitWidth = getMaxBitWidth(1, this->getOperands(), varBits); // Get the maximum bit width for the module based on the output
-
-        /*
-            Following the format: REG #(.DATAWIDTH(32)) REG_2(zwire, Clk, Rst, z); // z = zwire
-        */
-        if(signType)
+        else
         {
-            file << "\t" << "S" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", Clk, Rst, " << this->getOperands()[0] << ");" << endl;
+            appendBits(file, symbols.getName(source), kept - 1, 0, bitWidth);
         }
-        else
+        if (amount != 0)
         {
-            file << "\t" << this->getOpName() << " #(.DATAWIDTH(" << maxBitWidth << ")) " << this->getOpName() << indexOp << "(" << this->getOperands()[1] << ", Clk, Rst, " << this->getOperands()[0] << ") " << endl;
+            file.append(", ").appendInt((int)amount).append("'d0}");
         }
     }
-    
+    file.append(";\n");
     return;
 }
 
@@ -756,465 +1400,648 @@ void SetOp::printOperation(ofstream& file, int indexOp, unordered_map<string, va
 /*
     Store each net into their respective object type
 */
-SetNet parseInput(string inputString, NetParser& np) // Tokenize the input string, retaining only the utilized tokens
+SetNet parseDeclaration(const NetLine& line, char signType, int bitValue, NetParser& np) // Store each variable of a declaration line, retaining only the utilized tokens
 {
-    vector<string> netInput; // Store the net-type and variable names (e.g., {"Int32", "a, b, c"})
-    char signType; // Temporarily store the sign type
-
-    size_t typeEnd = inputString.find(' '); // Finds the index of the first encountered whitespace character
-    netInput.push_back(inputString.substr(typeEnd + 1, inputString.find(' ', typeEnd + 1) - typeEnd - 1)); // Find and extract the bitwidth (e.g., "Int8" from "input Int8 a, b, c") and push into the vector
-
-    size_t variablesStart = inputString.find(' ', typeEnd + 1); // Finds the next encountered whitespace character after typeEnd+1 index
-    netInput.push_back(inputString.substr(variablesStart + 1)); // Extract the variables (e.g., "a, b , c" from "input Int8 a, b, c") and push into the vector
-
-    // Determine sign type
-    if (netInput[0].find('U') != string::npos) { // Check if the character 'U' is found in the string
-        signType = 'u'; // Unsigned datatype
-    } else {
-        signType = 's'; // Signed datatype
-    }
-
     /*
-        The code below (excluding the return) is to extract each variable along their net type, sign type, and bitwidth 
-        which is then stored in a vector in the NetParser object
+        The symbol table records "input", "output", "wire", or "reg" for each variable,
+        while registers are declared as wires in the Verilog module
     */
-    // Extract the number associated with the type
-    string type = netInput[0];
-    int bitValue;
-    if (type.substr(0, 3) == "Int")
-    {
-        bitValue = stoi(type.substr(3)); // Extract the bit-value from "Int[bit-value]"
-    } else if (type.substr(0, 4) == "UInt")
+    const char* varType;
+    const char* netType;
+
+    switch (line.kind)
     {
-        bitValue = stoi(type.substr(4)); // Extract the bit-value from "UInt[bit-value]"
+        case LineKind::INPUT_DECL: varType = "input"; netType = "input"; break;
+        case LineKind::OUTPUT_DECL: varType = "output"; netType = "output"; break;
+        case LineKind::REGISTER_DECL: varType = "reg"; netType = "wire"; break;
+        default: varType = "wire"; netType = "wire"; break;
     }
 
-     // Extract variable names and store in variableBits
-    stringstream ss(netInput[1]); // Selects the element of the bitwidth (e.g., "Int8")
-    string variableName;
-    while (getline(ss, variableName, ','))
+    // Extract variable names (e.g., "a", "b", and "c" from "input Int8 a, b, c") and store in the symbol table
+    string_view varList = line.varList;
+    string_view variableName;
+    while (nextVarName(varList, variableName))
     {
-        // Trim leading and trailing whitespaces from variableName
-        variableName.erase(0, variableName.find_first_not_of(" \t\r\n"));
-        variableName.erase(variableName.find_last_not_of(" \t\r\n") + 1);
-
         /*
-            The unordered map of setVarBit should, for example, contain the following mapping:
-                setVarBit["a"] = 8;
-                setVarBit["b"] = 8;
-                setVarBit["c"] = 8;
+            The symbol table should, for example, contain the following records:
+                "a" -> {"input", 's', 8};
+                "b" -> {"input", 's', 8};
+                "c" -> {"input", 's', 8};
         */
-        np.setVarBit("input", signType, bitValue, variableName); // Store variableName in variableBits with associated bitwidth
+        np.setVarBit(varType, signType, bitValue, variableName); // Store variableName with its net type, sign type, and bitwidth
     }
 
     /*
-        The returned object will contain for example, "input", 8, 's', "a, b, c"
+        The returned object will contain for example, "input", 8, "a, b, c"
     */
-	return SetNet("input", bitValue, netInput[1]); // Return this temporary initialized object
+	return SetNet(netType, bitValue, np.keepText(line.varList)); // Return this temporary initialized object (the names are copied into the arena)
 }
 
-SetNet parseOutput(string outputString, NetParser& np) // Tokenize the output string, retaining only the utilized tokens
+static const char MALFORMED_OPERATION[] = ": malformed operation (expected 'x = a', 'x = a op b', or 'x = sel ? a : b')"; // After "Line N"
+
+SetOp parseOperation(const NetLine& line, bool createReg, NetParser& np, string& error) // Convert the tokens of an operation line, retaining only the utilized tokens (error is set for a line that cannot be converted)
 {
-    vector<string> netOutput; // Store the net-type and variable names (e.g., {"Int32", "a, b, c"})
-    char signType; // Temporarily store the sign type
+    string_view tempOps[MAX_LINE_TOKENS]; // The tokens other than "=" and ":"
+    size_t opCount = 0; // Number of kept tokens
+    int tokenCount = line.tokenCount; // Count number of tokens
 
-    size_t typeEnd = outputString.find(' '); // Finds the index of the first encountered whitespace character
-    netOutput.push_back(outputString.substr(typeEnd + 1, outputString.find(' ', typeEnd + 1) - typeEnd - 1)); // Find and extract the bitwidth (e.g., "Int8" from "output Int8 a, b, c") and push into the vector
+    if(tokenCount > MAX_LINE_TOKENS) // No operation has this many tokens
+    {
+        error = "Line " + to_string(line.number) + MALFORMED_OPERATION;
+        return SetOp();
+    }
 
-    size_t variablesStart = outputString.find(' ', typeEnd + 1); // Finds the next encountered whitespace character after typeEnd+1 index
-    netOutput.push_back(outputString.substr(variablesStart + 1)); // Extract the variables (e.g., "a, b , c" from "output Int8 a, b, c") and push into the vector
+	for(int i = 0; i < tokenCount; ++i)
+	{
+		if(line.tokens[i] != "=" && line.tokens[i] != ":") // Skip over any token that is an equal sign or a colon
+		{
+        	tempOps[opCount++] = line.tokens[i]; // Store the token
+		}
+    }
 
-    // Determine sign type
-    if (netOutput[0].find('U') != string::npos) { // Check if the character 'U' is found in the string
-        signType = 'u'; // Unsigned datatype
-    } else {
-        signType = 's'; // Signed datatype
+    int tempIds[MAX_LINE_TOKENS]; // Symbol IDs of the tokens, without the operator token (the third kept token)
+    size_t idCount = 0;
+    for (size_t i = 0; i < opCount; ++i)
+    {
+        if (i == 0 && createReg)
+        {
+            tempIds[idCount++] = np.internVar(tempOps[0], "wire"); // The operation drives the wire in front of the output register
+        }
+        else if (i != 2 && tempOps[i][0] >= '0' && tempOps[i][0] <= '9') // A name never starts with a digit, so this is an integer literal
+        {
+            uint64_t value;
+            if (i == 0 || !parseLiteral(tempOps[i], value)) // Nothing can be assigned to a literal, and one wider than 64 bits is not supported
+            {
+                error = "Line " + to_string(line.number) + ": " + (i == 0 ? "cannot assign to the literal " : "the literal does not fit in 64 bits: ") + string(tempOps[i]);
+                return SetOp();
+            }
+            tempIds[idCount++] = np.internLiteral(value);
+        }
+        else if (i != 2)
+        {
+            tempIds[idCount++] = np.internVar(tempOps[i]);
+        }
     }
 
-    /*
-        The code below (excluding the return) is to extract each variable along their net type, sign type, and bitwidth 
-        which is then stored in a vector in the NetParser object
-    */
-    // Extract the number associated with the type
-    string type = netOutput[0]; // Selects the element of the bitwidth (e.g., "Int8")
-    int bitValue;
-    if (type.substr(0, 3) == "Int")
+    Opcode opcode = Opcode::NONE;
+    if(opCount == 2) // A plain assignment (e.g., "x = xwire") has no operator token to inspect
     {
-        bitValue = stoi(type.substr(3)); // Extract the bit-value from "Int[bit-value]"
-    } else if (type.substr(0, 4) == "UInt")
+        opcode = Opcode::REG;
+    }
+    else if(opCount > 2)
     {
-        bitValue = stoi(type.substr(4)); // Extract the bit-value from "UInt[bit-value]"
+        // Index starts [0]
+        for (int code = 0; code < OPCODE_COUNT; ++code) // Check if the element pointed by this index is the operator token of an opcode
+        {
+            if(tempOps[2] == OP_DESCRIPTORS[code].symbol)
+            {
+                opcode = (Opcode)code;
+            }
+        }
     }
 
-     // Extract variable names and store in variableBits
-    stringstream ss(netOutput[1]); // Bitstream the variables in netOutput[1] (e.g., "a, b, c")
-    string variableName;
-    while (getline(ss, variableName, ','))
+    if(opcode == Opcode::NONE && opCount > 2)
     {
-        // Trim leading and trailing whitespaces from variableName
-        variableName.erase(0, variableName.find_first_not_of(" \t\r\n"));
-        variableName.erase(variableName.find_last_not_of(" \t\r\n") + 1);
-
-        /*
-            The unordered map of setVarBit should, for example, contain the following mapping:
-                setVarBit["a"] = 8;
-                setVarBit["b"] = 8;
-                setVarBit["c"] = 8;
-        */
-        np.setVarBit("output", signType, bitValue, variableName); // Store variableName in variableBits with associated bitwidth
+        error = "Line " + to_string(line.number) + ": unknown operator '" + string(tempOps[2]) + "'";
+        return SetOp();
     }
+    if(opcode == Opcode::NONE || idCount != getOperandCount(opcode)) // e.g., "c = =" or "c = a +", which would leave ports of the instance unconnected
+    {
+        error = "Line " + to_string(line.number) + MALFORMED_OPERATION;
+        return SetOp();
+    }
+	return SetOp(opcode, tempIds, idCount);
+}
+
+
+//------------------------------------------------------------------------------------------------------------------------------------------------------------- //
+
+/*
+
+                                    _             
+   ___ ___  _ ____   _____ _ __ ___(_) ___  _ __  
+  / __/ _ \| '_ \ \ / / _ \ '__/ __| |/ _ \| '_ \ 
+ | (_| (_) | | | \ V /  __/ |  \__ \ | (_) | | | |
+  \___\___/|_| |_|\_/ \___|_|  |___/_|\___/|_| |_|
+
+*/
 
+// Perform conversion from behavior netlist text file to Verilog file
+bool NetParser::convertToVerilog(string inputFile, string outputFile, string moduleName)
+{
     /*
-        The returned object will contain for example, "output", 8, 's', "a, b, c"
+
+        ███████╗██╗██╗  ████████╗███████╗██████╗      █████╗ ███╗   ██╗██████╗     ███████╗████████╗ ██████╗ ██████╗ ███████╗    ██╗███╗   ██╗██████╗ ██╗   ██╗████████╗
+        ██╔════╝██║██║  ╚══██╔══╝██╔════╝██╔══██╗    ██╔══██╗████╗  ██║██╔══██╗    ██╔════╝╚══██╔══╝██╔═══██╗██╔══██╗██╔════╝    ██║████╗  ██║██╔══██╗██║   ██║╚══██╔══╝
+        █████╗  ██║██║     ██║   █████╗  ██████╔╝    ███████║██╔██╗ ██║██║  ██║    ███████╗   ██║   ██║   ██║██████╔╝█████╗      ██║██╔██╗ ██║██████╔╝██║   ██║   ██║   
+        ██╔══╝  ██║██║     ██║   ██╔══╝  ██╔══██╗    ██╔══██║██║╚██╗██║██║  ██║    ╚════██║   ██║   ██║   ██║██╔══██╗██╔══╝      ██║██║╚██╗██║██╔═══╝ ██║   ██║   ██║   
+        ██║     ██║███████╗██║   ███████╗██║  ██║    ██║  ██║██║ ╚████║██████╔╝    ███████║   ██║   ╚██████╔╝██║  ██║███████╗    ██║██║ ╚████║██║     ╚██████╔╝   ██║   
+        ╚═╝     ╚═╝╚══════╝╚═╝   ╚══════╝╚═╝  ╚═╝    ╚═╝  ╚═╝╚═╝  ╚═══╝╚═════╝     ╚══════╝   ╚═╝    ╚═════╝ ╚═╝  ╚═╝╚══════╝    ╚═╝╚═╝  ╚═══╝╚═╝      ╚═════╝    ╚═╝   
+
     */
-	return SetNet("output", bitValue, netOutput[1]); // Return this temporary initialized object
-}
 
-SetNet parseWire(string wireString, NetParser& np) // Tokenize the wire string, retaining only the utilized tokens
-{
-    vector<string> netWire; // Store the net-type and variable names (e.g., {"Int32", "a, b, c"})
-    char signType; // Temporarily store the sign type
+    this->stats = ConversionStats();
+    DPGEN_STATS_SCOPE(statsScope, this->options.collectStats ? &this->stats : nullptr);
+    DPGEN_SPAN(convertSpan, "convert", inputFile);
 
-    size_t typeEnd = wireString.find(' '); // Find the end of the type
-    netWire.push_back(wireString.substr(typeEnd + 1, wireString.find(' ', typeEnd + 1) - typeEnd - 1)); // Extract the type
+    DPGEN_PHASE(readTimer, Phase::READ);
+    DPGEN_SPAN(readSpan, "read");
+    MappedFile netlistFile(inputFile); // Map the netlist into memory; the lexer hands out views into it
+    DPGEN_SPAN_END(readSpan);
+    DPGEN_PHASE_END(readTimer);
 
-    size_t variablesStart = wireString.find(' ', typeEnd + 1); // Find the start of the variables
-    netWire.push_back(wireString.substr(variablesStart + 1)); // Extract the variables
+    this->errorMessage.clear();
 
-    // Determine sign type
-    if (netWire[0].find('U') != string::npos) { // Check if the character 'U' is found in the string
-        signType = 'u'; // Unsigned datatype
-    } else {
-        signType = 's'; // Signed datatype
+    if (!netlistFile.isOpen())
+    {
+        this->errorMessage = "Unable to open the text file of " + inputFile;
+        return false;
     }
 
-    /*
-        The code below (excluding the return) is to extract each variable along their net type, sign type, and bitwidth 
-        which is then stored in a vector in the NetParser object
-    */
-    // Extract the number associated with the type
-    string type = netWire[0];
-    int bitValue;
-    if (type.substr(0, 3) == "Int")
+    return this->convertTextToVerilog(netlistFile.text(), outputFile, moduleName);
+}
+
+// Perform conversion from behavior netlist text already in memory to Verilog file
+bool NetParser::convertTextToVerilog(string_view netlistText, string outputFile, string moduleName)
+{
+    if (activeStats() == nullptr) // Not called from convertToVerilog, so these stats start here
     {
-        bitValue = stoi(type.substr(3)); // Extract the bit-value from "Int[bit-value]"
-    } else if (type.substr(0, 4) == "UInt")
+        this->stats = ConversionStats();
+    }
+    DPGEN_STATS_SCOPE(statsScope, this->options.collectStats ? &this->stats : nullptr);
+
+    if (moduleName.empty()) // The module is named after the output file unless told otherwise
     {
-        bitValue = stoi(type.substr(4)); // Extract the bit-value from "UInt[bit-value]"
+        moduleName = outputFile;
     }
 
-     // Extract variable names and store in variableBits
-    stringstream ss(netWire[1]); // Selects the element of the bitwidth (e.g., "Int8")
-    string variableName;
-    while (getline(ss, variableName, ','))
+    string verilogText;
+    if (!this->convertText(netlistText, moduleName, verilogText))
     {
-        // Trim leading and trailing whitespaces from variableName
-        variableName.erase(0, variableName.find_first_not_of(" \t\r\n"));
-        variableName.erase(variableName.find_last_not_of(" \t\r\n") + 1);
+        return false;
+    }
 
-        /*
-            The unordered map of setVarBit should, for example, contain the following mapping:
-                setVarBit["a"] = {"wire", 'u', 8};
-                setVarBit["b"] = {"wire", 'u', 8};
-                setVarBit["c"] = {"wire", 'u', 8};
-        */
-        np.setVarBit("wire", signType, bitValue, variableName); // Store variableName in variableBits with associated bitwidth
+    DPGEN_PHASE(writeTimer, Phase::WRITE);
+    DPGEN_SPAN(writeSpan, "write", outputFile);
+    if (!writeFileIfChanged(outputFile, verilogText)) // Write the result to the output file, unless it already holds exactly this text
+    {
+        this->errorMessage = "Unable to write the Verilog file " + outputFile;
+        return false;
     }
 
-    /*
-        The returned object will contain for example, "wire", 8, 's', "a, b, c"
-    */
-	return SetNet("wire", bitValue, netWire[1]); // Return this temporary initialized object
+    return true;
 }
 
-SetNet parseRegister(string regString, NetParser& np) // Tokenize the register string, retaining only the utilized tokens
+// Perform conversion from behavior netlist text to Verilog text, without touching any file but the cache
+bool NetParser::convertText(string_view netlistText, const string& moduleName, string& verilogText)
 {
-    vector<string> netReg; // Store the net-type and variable names (e.g., {"Int32", "a, b, c"})
-    char signType; // Temporarily store the sign type
+    this->errorMessage.clear();
+
+    if (activeStats() == nullptr) // Not called from convertTextToVerilog, so these stats start here
+    {
+        this->stats = ConversionStats();
+    }
+    DPGEN_STATS_SCOPE(statsScope, this->options.collectStats ? &this->stats : nullptr);
+    DPGEN_SPAN(translateSpan, "translate", moduleName); // Parse and emit (the "convert" span of convertToVerilog also covers the read)
 
-    size_t typeEnd = regString.find(' '); // Find the end of the type
-    netReg.push_back(regString.substr(typeEnd + 1, regString.find(' ', typeEnd + 1) - typeEnd - 1)); // Extract the type
+    // A netlist that was converted before with the same settings skips parsing altogether
+    ConversionCache cache(this->options.cacheDir);
+    string cacheKey;
 
-    size_t variablesStart = regString.find(' ', typeEnd + 1); // Find the start of the variables
-    netReg.push_back(regString.substr(variablesStart + 1)); // Extract the variables
+    if (!this->options.cacheDir.empty() && this->options.costJsonFile.empty())
+    {
+        cacheKey = cache.makeKey(netlistText, moduleName, this->options.fingerprint());
 
-    // Determine sign type
-    if (netReg[0].find('U') != string::npos) { // Check if the character 'U' is found in the string
-        signType = 'u'; // Unsigned datatype
-    } else {
-        signType = 's'; // Signed datatype
+        string reportText;
+        if (cache.lookup(cacheKey, verilogText, reportText))
+        {
+            this->clear(); // Nothing of the previous netlist stays behind
+            this->report = move(reportText);
+            DPGEN_COUNT(cacheHits, 1);
+            DPGEN_COUNT(outputBytes, verilogText.size());
+            return true;
+        }
     }
 
-
     /*
-        The code below (excluding the return) is to extract each variable along their net type, sign type, and bitwidth 
-        which is then stored in a vector in the NetParser object
+
+    ██████╗ ██████╗ ███╗   ██╗██╗   ██╗███████╗██████╗ ████████╗    ████████╗ ██████╗     ██╗   ██╗███████╗██████╗ ██╗██╗      ██████╗  ██████╗ 
+    ██╔════╝██╔═══██╗████╗  ██║██║   ██║██╔════╝██╔══██╗╚══██╔══╝    ╚══██╔══╝██╔═══██╗    ██║   ██║██╔════╝██╔══██╗██║██║     ██╔═══██╗██╔════╝ 
+    ██║     ██║   ██║██╔██╗ ██║██║   ██║█████╗  ██████╔╝   ██║          ██║   ██║   ██║    ██║   ██║█████╗  ██████╔╝██║██║     ██║   ██║██║  ███╗
+    ██║     ██║   ██║██║╚██╗██║╚██╗ ██╔╝██╔══╝  ██╔══██╗   ██║          ██║   ██║   ██║    ╚██╗ ██╔╝██╔══╝  ██╔══██╗██║██║     ██║   ██║██║   ██║
+    ╚██████╗╚██████╔╝██║ ╚████║ ╚████╔╝ ███████╗██║  ██║   ██║          ██║   ╚██████╔╝     ╚████╔╝ ███████╗██║  ██║██║███████╗╚██████╔╝╚██████╔╝
+    ╚═════╝ ╚═════╝ ╚═╝  ╚═══╝  ╚═══╝  ╚══════╝╚═╝  ╚═╝   ╚═╝          ╚═╝    ╚═════╝       ╚═══╝  ╚══════╝╚═╝  ╚═╝╚═╝╚══════╝ ╚═════╝  ╚═════╝ 
+
     */
-    // Extract the number associated with the type
-    string type = netReg[0];
-    int bitValue;
-    if (type.substr(0, 3) == "Int")
+
+    bool parsed;
+    if (NetlistImage::isImage(netlistText)) // A precompiled netlist (.dpir) is loaded as it is, without a parse
     {
-        bitValue = stoi(type.substr(3)); // Extract the bit-value from "Int[bit-value]"
-    } else if (type.substr(0, 4) == "UInt")
+        parsed = NetlistImage::load(netlistText, *this, this->errorMessage);
+    }
+    else
     {
-        bitValue = stoi(type.substr(4)); // Extract the bit-value from "UInt[bit-value]"
+        parsed = this->parseText(netlistText); // Fill the nets, operations, and symbol table of this parser
     }
 
-     // Extract variable names and store in variableBits
-    stringstream ss(netReg[1]); // Selects the element of the bitwidth (e.g., "Int8")
-    string variableName;
-    while (getline(ss, variableName, ','))
+    if (!parsed)
     {
-        // Trim leading and trailing whitespaces from variableName
-        variableName.erase(0, variableName.find_first_not_of(" \t\r\n"));
-        variableName.erase(variableName.find_last_not_of(" \t\r\n") + 1);
+        return false;
+    }
 
-        /*
-            The unordered map of setVarBit should, for example, contain the following mapping:
-                setVarBit["a"] = {"reg", 'u', 8};
-                setVarBit["b"] = {"reg", 'u', 8};
-                setVarBit["c"] = {"reg", 'u', 8};
-        */
-        np.setVarBit("reg", signType, bitValue, variableName); // Store variableName in variableBits with associated bitwidth
+    this->optimize();
+
+    verilogText = this->emitVerilog(moduleName); // Do the conversion
+
+    ostringstream reportText;
+    printConversionReport(reportText, *this);
+    this->report = reportText.str();
+
+    if (!cacheKey.empty())
+    {
+        cache.store(cacheKey, verilogText, this->report);
     }
 
-    /*
-        The returned object will contain for example, "wire", 8, 's', "a, b, c"
-    */
-	return SetNet("wire", bitValue, netReg[1]); // Return this temporary initialized object
+    return true;
 }
 
-SetOp parseOperation(string opString, bool createReg) // Tokenize the operation string, retaining only the utilized tokens
+// Perform conversion from behavior netlist text to Verilog written into a stream (e.g., cout)
+bool NetParser::convertText(string_view netlistText, const string& moduleName, ostream& sink)
 {
-	istringstream opStream(opString); // Initialize a stream from a string and then parse it (purposely for >>)
-	string tempOp; // Declare string variable to store token
-	vector<string> tempOps; // Vector to store dynamically created string variables
-    int tokenCount = 0; // Count number of tokens
-
-	while(opStream >> tempOp) // Loop while opStream is not empty
-	{
-		if(tempOp != "=" && tempOp != ":") // Skip over any token that is an equal sign
-		{
-        	tempOps.push_back(tempOp); // Store the token in the vector
-		}
-        tokenCount++; // Increment the counter
+    if (activeStats() == nullptr)
+    {
+        this->stats = ConversionStats();
     }
+    DPGEN_STATS_SCOPE(statsScope, this->options.collectStats ? &this->stats : nullptr);
 
-    if(createReg)
+    string verilogText;
+    if (!this->convertText(netlistText, moduleName, verilogText))
     {
-        tempOps[0] += "wire";
+        return false;
     }
 
-	// Index starts [0]
-	if(tempOps[2] == ADD) // Check if the element pointed by this index is an addition operator
-	{
-		return SetOp("ADD",tempOps);
-	}
-	else if(tempOps[2] == SUB) // Check if the element pointed by this index is an subtractor operator
-	{
-		return SetOp("SUB",tempOps);
-	}
-	else if(tempOps[2] == MUL) // Check if the element pointed by this index is an multiplier operator
-	{
-		return SetOp("MUL",tempOps);
-	}
-	else if(tempOps[2] == GT) // Check if the element pointed by this index is an greater than operator
-	{
-		return SetOp("GT",tempOps);
-	}
-	else if(tempOps[2] == LT) // Check if the element pointed by this index is an less than operator
-	{
-		return SetOp("LT",tempOps);
-	}
-	else if(tempOps[2] == EQ) // Check if the element pointed by this index is an equal to operator
-	{
-		return SetOp("EQ",tempOps);
-	}
-	else if(tempOps[2] == MUX) // Check if the element pointed by this index is an equal to operator
-	{
-		return SetOp("MUX",tempOps);
-	}
-	else if(tempOps[2] == SHR) // Check if the element pointed by this index is an shift-right operator
-	{
-		return SetOp("SHR",tempOps);
-	}
-	else if(tempOps[2] == SHL) // Check if the element pointed by this index is an shift-left operator
-	{
-		return SetOp("SHL",tempOps);
-	}
-    else if(tokenCount == 3)
+    DPGEN_PHASE(writeTimer, Phase::WRITE);
+    DPGEN_SPAN(writeSpan, "write", "stream");
+    sink.write(verilogText.data(), (streamsize)verilogText.size()); // The module is generated in memory, so it goes out in one write
+    sink.flush();
+    if (!sink)
     {
-        return SetOp("REG",tempOps);
+        this->errorMessage = "Unable to write the Verilog output";
+        return false;
     }
 
-	return SetOp(); // Otherwise return empty object
+    return true;
 }
 
+// Parse the netlist text into the nets, operations, and symbol table of this parser
+bool NetParser::parseText(string_view netlistText)
+{
+    this->clear(); // A parser may run several conversions, each starts from an empty netlist
 
-//------------------------------------------------------------------------------------------------------------------------------------------------------------- //
+    NetLexer lexer(netlistText); // Single pass over the netlist; each line is classified once
+    NetLine line;
+    DPGEN_SPAN(parseSpan, "parse");
+    DPGEN_SPAN(runSpan, nullptr); // One trace event per run of declaration lines or operation lines
+#if DPGEN_INSTRUMENTATION
+    int runKind = -1; // 1 inside a run of operation lines, 0 inside a run of declarations, -1 before the first line
+#endif
 
-/*
+    while (lexer.nextLine(line))
+    {
+        DPGEN_COUNT(lines, 1);
 
-                                    _             
-   ___ ___  _ ____   _____ _ __ ___(_) ___  _ __  
-  / __/ _ \| '_ \ \ / / _ \ '__/ __| |/ _ \| '_ \ 
- | (_| (_) | | | \ V /  __/ |  \__ \ | (_) | | | |
-  \___\___/|_| |_|\_/ \___|_|  |___/_|\___/|_| |_|
+#if DPGEN_INSTRUMENTATION
+        if (tracing() && (int)(line.kind == LineKind::OPERATION) != runKind) // The run of lines changes kind
+        {
+            runKind = (int)(line.kind == LineKind::OPERATION);
+            DPGEN_SPAN_RESTART(runSpan, runKind == 1 ? "operations" : "declarations");
+        }
+#endif
 
-*/
+        if (line.kind == LineKind::COMMENT) // A comment marks an error in the netlist
+        {
+            this->errorMessage = string(line.comment); // Keep the text after "//" as the error message
+            return false; // Exit program
+        }
 
-// Perform conversion from behavior netlist text file to Verilog file
-bool NetParser::convertToVerilog(string inputFile, string outputFile)
-{
-    /*
+        if (line.kind == LineKind::OPERATION) // Check if current line is an operation expression
+        {
+            DPGEN_COUNT(operations, 1);
+            bool createReg;
+            {
+                DPGEN_PHASE(synthesisTimer, Phase::SYNTHESIS);
+                createReg = checkOutput(line, *this);
+            }
+            {
+                DPGEN_PHASE(operationTimer, Phase::OPERATIONS);
+                string error;
+                this->setOperation(parseOperation(line, createReg, *this, error)); // Pass the tokens of the current line to the function
+                if (!error.empty())
+                {
+                    this->errorMessage = error;
+                    return false;
+                }
+            }
+            if(createReg) // Checks if a register needs to be created
+            {
+                DPGEN_PHASE(synthesisTimer, Phase::SYNTHESIS);
+                DPGEN_COUNT(synthesizedNets, 1);
+                createRegister(line, *this); 
+            }
+            this->operationLines.resize(this->operations.size(), (uint32_t)line.number); // The line of each operation it produced
+            continue;
+        }
 
-        ███████╗██╗██╗  ████████╗███████╗██████╗      █████╗ ███╗   ██╗██████╗     ███████╗████████╗ ██████╗ ██████╗ ███████╗    ██╗███╗   ██╗██████╗ ██╗   ██╗████████╗
-        ██╔════╝██║██║  ╚══██╔══╝██╔════╝██╔══██╗    ██╔══██╗████╗  ██║██╔══██╗    ██╔════╝╚══██╔══╝██╔═══██╗██╔══██╗██╔════╝    ██║████╗  ██║██╔══██╗██║   ██║╚══██╔══╝
-        █████╗  ██║██║     ██║   █████╗  ██████╔╝    ███████║██╔██╗ ██║██║  ██║    ███████╗   ██║   ██║   ██║██████╔╝█████╗      ██║██╔██╗ ██║██████╔╝██║   ██║   ██║   
-        ██╔══╝  ██║██║     ██║   ██╔══╝  ██╔══██╗    ██╔══██║██║╚██╗██║██║  ██║    ╚════██║   ██║   ██║   ██║██╔══██╗██╔══╝      ██║██║╚██╗██║██╔═══╝ ██║   ██║   ██║   
-        ██║     ██║███████╗██║   ███████╗██║  ██║    ██║  ██║██║ ╚████║██████╔╝    ███████║   ██║   ╚██████╔╝██║  ██║███████╗    ██║██║ ╚████║██║     ╚██████╔╝   ██║   
-        ╚═╝     ╚═╝╚══════╝╚═╝   ╚══════╝╚═╝  ╚═╝    ╚═╝  ╚═╝╚═╝  ╚═══╝╚═════╝     ╚══════╝   ╚═╝    ╚═════╝ ╚═╝  ╚═╝╚══════╝    ╚═╝╚═╝  ╚═══╝╚═╝      ╚═════╝    ╚═╝   
+        DPGEN_COUNT(declarations, 1);
+        DPGEN_PHASE(declarationTimer, Phase::DECLARATIONS);
+        this->lastDeclarationLine = line.number;
+        char signType;
+        int bitWidth;
 
-    */
+        if (line.tokenCount < 3 || !checkBitWidth(line.tokens[1], signType, bitWidth)) // Skip a declaration without a valid type or variables
+        {
+            continue;
+        }
+
+        SetNet net = parseDeclaration(line, signType, bitWidth, *this); // Pass the tokens of the current line to the function
 
-	ifstream netlistFile(inputFile);
+        switch (line.kind) // Store the net into the vector of its net type
+        {
+            case LineKind::INPUT_DECL: this->setInput(net); break;
+            case LineKind::OUTPUT_DECL: this->setOutput(net); break;
+            case LineKind::WIRE_DECL: this->setWire(net); break;
+            default: this->setRegister(net); break;
+        }
+    }
+
+    DPGEN_COUNT(signals, this->symbols.size());
 
-	vector<string> text_lines; // Declare a vector of words for each line
-	string line; // // Declare a string to one line
+    this->useDefs.build(this->operations, this->symbols.size());
+    return true;
+}
 
-    // Loop through each line in netlistFile
-    while ( getline(netlistFile, line) ) // Delimiter '\n' is explicitly passed here just in case
+// Rewrite the parsed operations with the passes that the options enable
+void NetParser::optimize()
+{
+    DPGEN_PHASE(optimizeTimer, Phase::OPTIMIZE);
+    DPGEN_SPAN(optimizeSpan, "optimize");
+
+    this->removedInstances = 0;
+    this->widthSavings.clear();
+    this->retiming = RetimeResult();
+    this->schedule = ScheduleResult();
+    this->pipelineRegisters = 0;
+    this->pipelineRegistersNeeded = 0;
+    this->pipelineLatency = 0;
+    this->pipelineBalanced = true;
+    this->folding = FoldResult();
+
+    if (this->literalCount != 0) // First, so the other passes see the instances that remain
     {
-        // Skip processing if the line is empty
-        if (!line.empty())
-        {
-            size_t pos = line.find("//");
-            // Check if "//" is present in the string
-            if (pos != string::npos)
-            {
-                string afterComment = line.substr(pos + 2);
-                
-                // Trim whitespace characters from both ends of the extracted substring
-                size_t start = afterComment.find_first_not_of(" \t\f\v\n\r");
-                size_t end = afterComment.find_last_not_of(" \t\f\v\n\r");
+        DPGEN_SPAN(foldSpan, "fold");
+        this->folding = foldConstants(this->operations, this->symbols, this->useDefs);
+        this->useDefs.build(this->operations, this->symbols.size()); // Folding interns the constants it writes
+    }
 
-                if (start != std::string::npos && end != std::string::npos)
-                {
-                    afterComment = afterComment.substr(start, end - start + 1);
-                }
+    if (this->options.eliminateCommonSubexpressions)
+    {
+        DPGEN_SPAN(cseSpan, "cse");
+        this->removedInstances += eliminateCommonSubexpressions(this->operations, this->symbols);
+    }
 
-                cout << "ERROR FOUND: " << line.substr(pos + 2) << endl; // extract the substring after "//" to output the error message
-                return false; // Exit program
-            }
+    if (this->removedInstances != 0) // The passes rewired readers, so index the rewritten operations
+    {
+        this->useDefs.build(this->operations, this->symbols.size());
+    }
 
-            // Define the set of whitespace characters to search
-            string whitespaceChars = " \t\f\v\n\r";
+    if (this->options.minimizeWidths) // After CSE, which compares the widths of the rule
+    {
+        DPGEN_SPAN(widthSpan, "min-width");
+        minimizeDataWidths(this->operations, this->symbols, this->useDefs, this->widthSavings);
+        trimDemandedBits(this->operations, this->symbols, this->useDefs, this->widthSavings);
+    }
 
-            /*
-                line.back() returns a reference to the last character of the string line.
-                whitespaceChars.find(line.back()) searches for the last character of line in the set of whitespace characters.
-                'string::npos' is a return value if the search is unsuccessful
-
-                NOTE:
-                    For an empty line that contains no visible characters, 
-                    the loop will find the last character to be the newline character ('\n') 
-                    which is considered a whitespace character. Therefore, 
-                    the loop will remove this newline character, effectively treating 
-                    the empty line as a line with trailing whitespace characters.
-            */
-            while (!line.empty() && whitespaceChars.find(line.back()) != string::npos) {
-                // The last character is a whitespace character
-                line.pop_back(); // Remove the last character
+    if (this->options.clockPeriod > 0) // Last, so the stages are timed with the final widths
+    {
+        DPGEN_SPAN(pipelineSpan, "pipeline");
+        PipelineResult pipeline = pipelineDatapath(this->operations, this->symbols, this->useDefs, this->options.clockPeriod);
+        this->pipelineRegisters = pipeline.registers.size();
+        this->pipelineRegistersNeeded = pipeline.registersNeeded;
+        this->pipelineLatency = pipeline.latency;
+        this->pipelineBalanced = pipeline.balanced;
+        if (!pipeline.registers.empty())
+        {
+            this->declareNets(pipeline.registers, true);
+            this->useDefs.build(this->operations, this->symbols.size());
+        }
+    }
+
+    if (this->options.retime) // After pipelining, so it also moves the registers pipelining inserted
+    {
+        DPGEN_SPAN(retimeSpan, "retime");
+        this->retiming = retimeRegisters(this->operations, this->symbols, this->useDefs);
+        if (this->retiming.retimed)
+        {
+            if (!this->retiming.registers.empty())
+            {
+                this->declareNets(this->retiming.registers, true);
             }
+            this->useDefs.build(this->operations, this->symbols.size());
+        }
+    }
 
-            text_lines.push_back(line); // After filtering, "line" is added to the vector of strings
+    if (!this->options.unitLimits.empty()) // Last, since it spreads each netlist cycle over several clock cycles
+    {
+        DPGEN_SPAN(scheduleSpan, "schedule");
+        this->schedule = scheduleOperations(this->operations, this->symbols, this->useDefs, this->options.unitLimits);
+        if (this->schedule.scheduled)
+        {
+            this->declareNets(this->schedule.wires, false);
+            this->declareNets(this->schedule.registers, true);
+            this->useDefs.build(this->operations, this->symbols.size());
         }
     }
 
-    // ofstream verilogFile(outputFile);
+    DPGEN_COUNT(removedInstances, this->removedInstances);
+    DPGEN_COUNT(pipelineRegisters, this->pipelineRegisters);
+    DPGEN_COUNT(narrowedInstances, this->widthSavings.instances.size());
+    DPGEN_COUNT(savedBits, this->widthSavings.savedInstanceBits());
+    DPGEN_COUNT(narrowedNets, this->widthSavings.nets.size());
+    return;
+}
 
-    // // Output each string in the vector
-    // for (const string& lain : text_lines) {
-    //     cout << lain << endl;
-    //     verilogFile << lain << endl;
-    // }
+void NetParser::declareNets(const vector<int>& ids, bool registers)
+{
+    vector<uint8_t> declared(ids.size(), 0);
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        if (declared[i])
+        {
+            continue;
+        }
 
-    // return true;
+        int bitWidth = this->symbols.getInfo(ids[i]).bitWidth;
+        string names;
+        for (size_t j = i; j < ids.size(); ++j)
+        {
+            if (!declared[j] && this->symbols.getInfo(ids[j]).bitWidth == bitWidth)
+            {
+                names.append(names.empty() ? "" : ", ").append(this->symbols.getName(ids[j]));
+                declared[j] = 1;
+            }
+        }
+        if (registers)
+        {
+            this->setRegister(SetNet(WIRE, bitWidth, this->keepText(names))); // Registers are declared as wires driven by REG instances
+        }
+        else
+        {
+            this->setWire(SetNet(WIRE, bitWidth, this->keepText(names)));
+        }
+    }
+    return;
+}
 
-    /*
+// Generate the Verilog module from what parseText() stored
+string NetParser::emitVerilog(const string& moduleName)
+{
+    DPGEN_PHASE(emitTimer, Phase::EMIT);
+    DPGEN_SPAN(emitSpan, "emit");
 
-    ██████╗ ██████╗ ███╗   ██╗██╗   ██╗███████╗██████╗ ████████╗    ████████╗ ██████╗     ██╗   ██╗███████╗██████╗ ██╗██╗      ██████╗  ██████╗ 
-    ██╔════╝██╔═══██╗████╗  ██║██║   ██║██╔════╝██╔══██╗╚══██╔══╝    ╚══██╔══╝██╔═══██╗    ██║   ██║██╔════╝██╔══██╗██║██║     ██╔═══██╗██╔════╝ 
-    ██║     ██║   ██║██╔██╗ ██║██║   ██║█████╗  ██████╔╝   ██║          ██║   ██║   ██║    ██║   ██║█████╗  ██████╔╝██║██║     ██║   ██║██║  ███╗
-    ██║     ██║   ██║██║╚██╗██║╚██╗ ██╔╝██╔══╝  ██╔══██╗   ██║          ██║   ██║   ██║    ╚██╗ ██╔╝██╔══╝  ██╔══██╗██║██║     ██║   ██║██║   ██║
-    ╚██████╗╚██████╔╝██║ ╚████║ ╚████╔╝ ███████╗██║  ██║   ██║          ██║   ╚██████╔╝     ╚████╔╝ ███████╗██║  ██║██║███████╗╚██████╔╝╚██████╔╝
-    ╚═════╝ ╚═════╝ ╚═╝  ╚═══╝  ╚═══╝  ╚══════╝╚═╝  ╚═╝   ╚═╝          ╚═╝    ╚═════╝       ╚═══╝  ╚══════╝╚═╝  ╚═╝╚═╝╚══════╝ ╚═════╝  ╚═════╝ 
+    string verilogText = writeToOutput(moduleName, *this);
+    DPGEN_COUNT(outputBytes, verilogText.size());
+    return verilogText;
+}
 
-    */
+const ConversionStats& NetParser::getStats() const
+{
+    return this->stats;
+}
 
-    NetParser netParser; // Create an instance of NetParser object
+// Forget the netlist of the previous conversion
+void NetParser::clear()
+{
+    this->inputs.clear();
+    this->outputs.clear();
+    this->wires.clear();
+    this->registers.clear();
+    this->operations.clear(); // The arrays keep their capacity, so a parser that converts again (e.g., in --serve) allocates less
+    this->symbols.clear();
+    this->errorMessage.clear();
+    this->useDefs.clear();
+    this->removedInstances = 0;
+    this->widthSavings.clear();
+    this->retiming = RetimeResult();
+    this->schedule = ScheduleResult();
+    this->pipelineRegisters = 0;
+    this->pipelineRegistersNeeded = 0;
+    this->pipelineLatency = 0;
+    this->pipelineBalanced = true;
+    this->operationLines.clear();
+    this->lastDeclarationLine = 0;
+    this->literalCount = 0;
+    this->folding = FoldResult();
+    this->report.clear();
+    this->arena.reset(); // Last, since the nets and the symbol table view into it
+    return;
+}
 
-    /*
-        'auto' tells the compiler to infer the type of it based on the initialization expression text_lines.begin().
-    */
-    for (const auto& line : text_lines)
+/*
+    Incremental update of the operations for dpgen --watch. The new lines are parsed exactly as parseText() would
+    parse them, since every declaration comes before them and the symbol table already holds every declared net.
+    A register synthesized for an output also adds its wire to the nets, so an edit that adds, removes, or reorders
+    such registers is left to a full parse; otherwise the nets stay as they are, and only the operations are spliced
+*/
+bool NetParser::replaceOperationText(size_t firstOp, size_t lastOp, string_view text, int firstLine, int lineShift, bool& selectsChanged)
+{
+    if (firstLine <= this->lastDeclarationLine || this->operationLines.size() != this->operations.size())
     {
-        istringstream lineStream(line); // Initialize a stream from a string and then parse it (purposely for >>)
-        string netType; // Declare string variable to store token
-        string bitWidth;
+        return false; // The parse of the edited lines depends on declarations that follow them, or the lines are unknown
+    }
 
-        lineStream >> netType >> bitWidth; // Store the first token in netType
-        
-        if( netType.compare(INPUT) == 0 && checkBitWidth(bitWidth) ) // Check whether the extracted token is equal to INPUT
+    // The outputs whose registers the old lines synthesized (such a register shares its line with the operation that drives its wire)
+    vector<int> oldRegisters;
+    for (size_t index = firstOp + 1; index < lastOp; ++index)
+    {
+        if (this->operations.getOpcode(index) == Opcode::REG && this->operationLines[index] == this->operationLines[index - 1])
         {
-            netParser.setInput(parseInput(line, netParser)); // Pass the string in the current line to the function
+            oldRegisters.push_back(this->operations.getOperands(index)[0]);
         }
-        else if( netType.compare(OUTPUT) == 0 && checkBitWidth(bitWidth)) // Check whether the extracted token is equal to INPUT
+    }
+
+    size_t literalCount = this->literalCount;
+    OpList replacement;
+    vector<uint32_t> replacementLines;
+    vector<int> newRegisters;
+    NetLexer lexer(text);
+    NetLine line;
+
+    while (lexer.nextLine(line))
+    {
+        if (line.kind != LineKind::OPERATION)
         {
-            netParser.setOutput(parseOutput(line, netParser)); // Pass the string in the current line to the function
+            return false; // Names interned so far stay undeclared and unused, which the output never shows
         }
-        else if( netType.compare(WIRE) == 0 && checkBitWidth(bitWidth) ) // Check whether the extracted token is equal to INPUT
+
+        uint32_t number = (uint32_t)(firstLine - 1 + line.number);
+        int outputId = line.tokenCount != 3 ? this->symbols.find(line.tokens[0]) : -1;
+        bool createReg = outputId >= 0 && this->symbols.getInfo(outputId).netType == "output"; // Same test as checkOutput()
+
+        string error;
+        replacement.push(parseOperation(line, createReg, *this, error));
+        if (!error.empty())
         {
-            netParser.setWire(parseWire(line, netParser)); // Pass the string in the current line to the function
+            this->literalCount = literalCount;
+            return false; // The full conversion reports it
         }
-        else if( netType.compare(REGISTER) == 0 && checkBitWidth(bitWidth) ) // Check whether the extracted token is equal to INPUT
+        replacementLines.push_back(number);
+
+        if (createReg)
         {
-            netParser.setRegister(parseRegister(line, netParser)); // Pass the string in the current line to the function
+            int ids[2] = {outputId, this->internVar(line.tokens[0], "wire")}; // Same operation as createRegister()
+            replacement.push(SetOp(Opcode::REG, ids, 2));
+            replacementLines.push_back(number);
+            newRegisters.push_back(outputId);
         }
-        else // Check if current line is an operation expression
+    }
+
+    if (newRegisters != oldRegisters || this->literalCount != literalCount)
+    {
+        this->literalCount = literalCount; // A literal is folded across the whole netlist, so a full parse handles it
+        return false;
+    }
+
+    // The selects read by the old or the new lines, which are the only symbols whose select role the edit can change
+    vector<pair<int, bool>> selects; // Symbol ID and whether it was a select before the edit
+    auto collectSelects = [this, &selects](const OpList& ops, size_t first, size_t last)
+    {
+        for (size_t index = first; index < last; ++index)
         {
-            bool createReg = checkOutput(line, netParser);
-            netParser.setOperation(parseOperation(line, createReg)); // Pass the string in the current line to the function
-            if(createReg) // Checks if a register needs to be created
+            if (ops.getOpcode(index) == Opcode::MUX)
             {
-                createRegister(line, netParser); 
+                int id = ops.getOperands(index)[1]; // "sel" of "x = sel ? a : b"
+                selects.push_back({id, (size_t)id < this->useDefs.size() && this->useDefs.isUsedAs(id, PortRole::SELECT)});
             }
         }
-    }
-
-    // for (const auto& wire : netParser.getOperations() ) {
-    //     cout << "OpName: " << wire.getOpName() << endl;
-    //     // Iterate through the vector using a range-based for loop
-    //     cout << "Operands: ";
-    //     for (const auto& op : wire.getOperands()) {
-    //         cout << op << ",";
-    //     }
-    //     cout << "\n" << endl;
-    // }
+    };
+    collectSelects(this->operations, firstOp, lastOp);
+    collectSelects(replacement, 0, replacement.size());
 
-    // for (const auto& wire : netParser.getRegisters() ) {
-    //     cout << "NetType: " << wire.getNetType() << ", Bitwidth: " << wire.getBitWidth() << ", VarNames: " << wire.getVarNames() << endl;
-    // }
+    this->operations.replace(firstOp, lastOp, replacement);
 
-    // unordered_map<string, variableInfo> temp = netParser.getVariableBits();
-
-    // for (const auto& pair : temp) {
-    //     cout << "Key: " << pair.first << ", NetType: " << pair.second.netType << ", SignType: " << pair.second.signType << ", BitWidth: " << pair.second.bitWidth << endl;
-    // }
+    this->operationLines.erase(this->operationLines.begin() + firstOp, this->operationLines.begin() + lastOp);
+    this->operationLines.insert(this->operationLines.begin() + firstOp, replacementLines.begin(), replacementLines.end());
+    for (size_t index = firstOp + replacementLines.size(); index < this->operationLines.size(); ++index)
+    {
+        this->operationLines[index] += lineShift;
+    }
 
-    writeToOutput(outputFile, netParser); // Do the conversion and write the result to the output file
+    this->useDefs.build(this->operations, this->symbols.size());
 
+    selectsChanged = false;
+    for (const pair<int, bool>& select : selects)
+    {
+        selectsChanged = selectsChanged || this->useDefs.isUsedAs(select.first, PortRole::SELECT) != select.second;
+    }
     return true;
 }
-
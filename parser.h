@@ -1,10 +1,19 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "arena.h"
+#include "emitter.h"
+#include "stats.h"
+#include "bitwidth.h"
+#include "retime.h"
+#include "schedule.h"
+#include "fold.h"
+
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
-#include <unordered_map>
+#include <cstdint>
 
 /*
     A directive that allows you to use names from the std namespace without prefixing them with ''
@@ -12,21 +21,88 @@
 */
 using namespace std;
 
-// Define constants for net types and operators
+#define DPGEN_VERSION "2.1.0" // Part of the conversion cache key, so bump it whenever the generated Verilog changes
+
+// Define constants for net types
 #define INPUT "input"
 #define OUTPUT "output"
 #define WIRE "wire"
 #define REGISTER "register"
 #define EMPTY "\0"
-#define ADD "+" // Addition operator constant
-#define SUB "-" // Subtraction operator constant
-#define MUL "*" // Multiplication operator constant
-#define GT ">" // Greater than operator constant
-#define LT "<" // Less than operator constant
-#define EQ	"==" // Equal operator constant
-#define MUX "?" // Multiplexer operator constant
-#define SHR ">>" // Shift right operator constant
-#define SHL "<<" // Shift left operator constant
+#define CONSTANT "const" // An integer literal operand, named as its Verilog literal (e.g., "4'd8" for 8)
+
+// Kind of each operation (the operator tokens themselves live in the descriptor table below)
+enum class Opcode : uint8_t
+{
+    ADD, // Addition
+    SUB, // Subtraction
+    MUL, // Multiplication
+    GT, // Greater than
+    LT, // Less than
+    EQ, // Equal
+    MUX, // Multiplexer
+    SHR, // Shift right
+    SHL, // Shift left
+    REG, // Register (plain assignment)
+    NONE // Unrecognized operation, which is not emitted
+};
+
+const int OPCODE_COUNT = (int)Opcode::NONE; // Number of opcodes that are emitted as instances
+const int COUNTER_COUNT = 8; // Number of instance counters (ADD, SUB, MUL, COMP, MUX, SHR, SHL, REG)
+
+// Which declared net sizes the DATAWIDTH of an instance
+enum class WidthRule : uint8_t
+{
+    OUTPUT_WIDTH, // The output, register, or wire that the component drives
+    LARGEST_INPUT // The largest input (comparators)
+};
+
+// Port slots of an instance: a non-negative slot is an operand index, the rest are fixed connections
+const int8_t PORT_CLK_RST = -1; // "Clk, Rst"
+const int8_t PORT_ZERO = -2; // "1'b0" for an unused comparator output
+const int8_t PORT_END = -3; // Terminates the port list
+
+// Describe how each opcode is parsed and emitted
+struct OpDescriptor
+{
+    const char* symbol; // Operator token in the netlist (e.g., "+"), empty for REG
+    const char* name; // Instance name prefix (e.g., "ADD")
+    const char* module; // Unsigned module name (e.g., "ADD", "COMP")
+    const char* signedModule; // Signed module name (e.g., "SADD"), or nullptr when the module has no signed variant
+    WidthRule widthRule; // How the DATAWIDTH parameter is chosen
+    int8_t counter; // Index of the instance counter (GT, LT, and EQ share the COMP counter so their names stay unique)
+    int8_t ports[6]; // Port order of the instance, terminated by PORT_END
+};
+
+// Indexed by Opcode
+constexpr OpDescriptor OP_DESCRIPTORS[OPCODE_COUNT] =
+{
+    { "+", "ADD", "ADD", "SADD", WidthRule::OUTPUT_WIDTH, 0, {1, 2, 0, PORT_END} }, // ADD #(.DATAWIDTH(8)) ADD1(a, b, d); // d = a + b
+    { "-", "SUB", "SUB", "SSUB", WidthRule::OUTPUT_WIDTH, 1, {1, 2, 0, PORT_END} }, // SUB #(.DATAWIDTH(16)) SUB1(f, d, xwire); // xwire = f - d
+    { "*", "MUL", "MUL", "SMUL", WidthRule::OUTPUT_WIDTH, 2, {1, 2, 0, PORT_END} }, // MUL #(.DATAWIDTH(16)) MUL1(a, c, f); // f = a * c
+    { ">", "COMP", "COMP", "SCOMP", WidthRule::LARGEST_INPUT, 3, {1, 2, 0, PORT_ZERO, PORT_ZERO, PORT_END} }, // COMP #(.DATAWIDTH(32)) COMP1(b, c, bGTc, 1'b0, 1'b0); // bGTc = b > c
+    { "<", "COMP", "COMP", "SCOMP", WidthRule::LARGEST_INPUT, 3, {1, 2, PORT_ZERO, 0, PORT_ZERO, PORT_END} }, // COMP #(.DATAWIDTH(32)) COMP1(d, e, 1'b0, dLTe, 1'b0); // dLTe = d < e
+    { "==", "COMP", "COMP", "SCOMP", WidthRule::LARGEST_INPUT, 3, {1, 2, PORT_ZERO, PORT_ZERO, 0, PORT_END} }, // COMP #(.DATAWIDTH(32)) COMP1(f, g, 1'b0, 1'b0, fEQg); // fEQg = f == g
+    { "?", "MUX", "MUX", "SMUX", WidthRule::OUTPUT_WIDTH, 4, {2, 3, 1, 0, PORT_END} }, // MUX #(.DATAWIDTH(32)) MUX1(d, e, dLTe, g); // g = dLTe ? d : e
+    { ">>", "SHR", "SHR", nullptr, WidthRule::OUTPUT_WIDTH, 5, {1, 0, 2, PORT_END} }, // SHR #(.DATAWIDTH(32)) SHR1(l2div2, l2div4, sa); // l2div4 = l2div2 >> sa
+    { "<<", "SHL", "SHL", nullptr, WidthRule::OUTPUT_WIDTH, 6, {1, 0, 2, PORT_END} }, // SHL #(.DATAWIDTH(32)) SHL1(g, xwire, dLTe); // xwire = g << dLTe
+    { "", "REG", "REG", "SREG", WidthRule::OUTPUT_WIDTH, 7, {1, PORT_CLK_RST, 0, PORT_END} } // REG #(.DATAWIDTH(32)) REG1(zwire, Clk, Rst, z); // z = zwire
+};
+
+inline const OpDescriptor& getDescriptor(Opcode opcode) // Getter for the descriptor of an emitted opcode
+{
+    return OP_DESCRIPTORS[(int)opcode];
+}
+
+inline size_t getOperandCount(Opcode opcode) // Operands of an emitted opcode, output included: one more than the largest port index
+{
+    size_t count = 0;
+    for (const int8_t* port = getDescriptor(opcode).ports; *port != PORT_END; ++port)
+    {
+        count = *port >= 0 && (size_t)*port >= count ? (size_t)*port + 1 : count;
+    }
+    return count;
+}
 
 // Define a struct to hold variable information
 struct variableInfo
@@ -36,41 +112,200 @@ struct variableInfo
     int bitWidth; // Bitwidth of the variable
 };
 
-// Class to store each operation
-class SetOp
+/*
+    Interns every net name into a dense integer ID so that width/sign/net-type queries
+    are a single index into a contiguous array instead of a scan over every declared variable.
+    The names live in the arena of the conversion, and the lookup table is open-addressed,
+    so interning a name allocates nothing but the (amortized) growth of the arrays
+*/
+class SymbolTable
 {
     private:
-        string netOperator; // Store the net operator
-        vector<string> operands; // Store the operands
+        Arena* arena; // Storage of the names (owned by the NetParser)
+        vector<string_view> names; // Name of each ID (indexed by ID)
+        vector<uint32_t> hashes; // Hash of the name of each ID, so growing the table does not rehash the names
+        vector<int> slots; // Open-addressed table of IDs (-1 marks an empty slot); the size is a power of two
+        vector<variableInfo> infos; // Width/sign/net-type record of each ID (indexed by ID)
 
-        // bool isInputExist();
-        // bool isOutputExist();
+        size_t findSlot(string_view name, uint32_t hash) const; // Slot holding the name, or the empty slot where it belongs
+        void grow(); // Double the table and reinsert every ID
+
+        friend class NetlistImage; // Saves and restores the arrays as they are
+
+    public:
+
+        // Parameterized Constructor
+        explicit SymbolTable(Arena* arena)
+        {
+            this->arena = arena;
+        }
+
+        int intern(string_view name); // Return the ID of the name, creating an undeclared record if it is new
+        int intern(string_view name, string_view suffix); // Same for the name followed by suffix (e.g., "x" + "wire"), without building a temporary string
+        int find(string_view name) const; // Return the ID of the name, or -1 if it was never interned
+
+        string_view getName(int id) const;
+        const variableInfo& getInfo(int id) const;
+        variableInfo& getInfo(int id);
+        size_t size() const;
+        void clear();
+};
+
+// A read-only view of the operand IDs of one operation (operand 0 is the output)
+struct OperandRange
+{
+    const int* first;
+    const int* last;
+
+    size_t size() const { return (size_t)(last - first); }
+    int operator[](size_t i) const { return first[i]; }
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+};
+
+const int MAX_OPERANDS = 4; // No operation has more than four operands (e.g., "g = dLTe ? d : e")
+
+// Class to store each parsed operation before it is appended to the operation list
+class SetOp
+{
+    private:
+        Opcode opcode; // Store the kind of operation
+        int operands[MAX_OPERANDS]; // Store the symbol IDs of the operands inline, so building an operation allocates nothing
+        uint8_t operandCount; // Number of stored operands
 
     public:
 
         // Default Constructor
         SetOp()
         {
-            this->netOperator = ""; // Declare empty string
-            this->operands = vector<string>(0); // Declare empty vector of strings
+            this->opcode = Opcode::NONE; // Declare an unrecognized operation
+            this->operandCount = 0; // Declare no operands
         }
 
         // Parameterized Constructor
-        SetOp(string netOperator, vector<string> operands)
+        SetOp(Opcode opcode, const int* ids, size_t count)
         {
-            this->netOperator = netOperator; // Assign the type of operator
-            this->operands = operands; // Operands used in the operation
-
-            if(netOperator != "REG") // Skip this code if the netOperator is REG because it does not have an operator
+            this->opcode = opcode; // Assign the type of operator
+            this->operandCount = (uint8_t)(count < MAX_OPERANDS ? count : MAX_OPERANDS); // Tokens past the last port are never connected
+            for (size_t i = 0; i < this->operandCount; ++i)
             {
-                this->operands.erase(this->operands.begin() + 2); // Remove the element at the specified index (i.e., the operators like '+' or '-' or '*' or etc)
+                this->operands[i] = ids[i]; // Operands used in the operation (the operator token is already dropped)
             }
         }
 
-        string getOpName() const;
-        vector<string> getOperands() const;
+        Opcode getOpcode() const;
+        OperandRange getOperands() const;
+};
+
+class UseDefIndex; // Declared below, since it is built from an OpList
+
+/*
+    Stores every operation as a struct of arrays: one opcode per operation, and the operand IDs
+    of all operations packed back to back, so that passes over the operations walk contiguous memory
+*/
+class OpList
+{
+    private:
+        vector<Opcode> opcodes; // Opcode of each operation
+        vector<uint32_t> operandStart; // Index of the first operand of each operation in operandIds (plus one past the last operation)
+        vector<int> operandIds; // Operand IDs of every operation
+        vector<int> dataWidths; // DATAWIDTH chosen by a width pass for each operation (0 for its width rule), empty until a pass sets one
+
+        friend class NetlistImage;
+
+    public:
+
+        // Default Constructor
+        OpList()
+        {
+            this->operandStart.push_back(0);
+        }
+
+        void push(const SetOp& op);
+        void clear(); // Remove every operation, keeping the capacity for the next netlist
+
+        size_t size() const;
+        bool empty() const;
+        Opcode getOpcode(size_t index) const;
+        OperandRange getOperands(size_t index) const;
+
+        void setOpcode(size_t index, Opcode opcode);
+        void setOperand(size_t index, size_t slot, int id);
+        int getDataWidth(size_t index, const SymbolTable& symbols) const; // DATAWIDTH of the instance
+        void setDataWidth(size_t index, int width); // Override the width rule of the opcode (e.g., with a narrower width)
+
+        void replace(size_t first, size_t last, const OpList& replacement); // Splice replacement in place of operations [first, last)
+
+        bool isWiring(size_t index, const SymbolTable& symbols) const; // A shift by a constant, emitted as an assign of bits rather than an instance
+        void printWiring(Emitter& file, size_t index, const SymbolTable& symbols, const UseDefIndex& useDefs) const; // e.g., "\tassign d = {a[5:0], 2'd0};\n"
+
+        void printOperation(Emitter& file, size_t index, int indexOp, const SymbolTable& symbols) const; // The whole instance line
+        void printInstanceHead(Emitter& file, size_t index, const SymbolTable& symbols) const; // e.g., "\tADD #(.DATAWIDTH(8)) ADD", before the instance number
+        void printInstancePorts(Emitter& file, size_t index, const SymbolTable& symbols) const; // e.g., "(a, b, d);\n", after the instance number
+};
+
+int getMaxBitWidth(WidthRule rule, OperandRange operands, const SymbolTable& symbols); // DATAWIDTH of an instance
+bool isSigned(OperandRange operands, const SymbolTable& symbols); // Whether any input is signed (selects the signed module)
+
+bool parseLiteral(string_view token, uint64_t& value); // Whether the token is a decimal integer literal (e.g., the "8" of "d = a * 8") that fits in 64 bits
+int getLiteralWidth(uint64_t value); // Bits of the Verilog literal of value: the fewest that hold it, rounded up to a power of two
+int internConstant(SymbolTable& symbols, uint64_t value); // ID of the constant symbol of value, an unsigned net of getLiteralWidth() bits
+uint64_t getConstantValue(int id, const SymbolTable& symbols); // Value of a constant symbol
 
-        void printOperation(ofstream& file, int indexOp, unordered_map<string, variableInfo> varBits) const;
+// How an operation reads one of its inputs
+enum class PortRole : uint8_t
+{
+    DATA, // An operand of an arithmetic or comparison instance, or a data input of a MUX
+    SELECT, // The select of a MUX (a 1-bit wire)
+    SHIFT_AMOUNT, // The shift amount of SHR or SHL
+    REGISTER_INPUT // The data input of a REG
+};
+
+PortRole getPortRole(Opcode opcode, size_t slot); // Role of input operand slot (1, 2, ...) of an opcode
+
+// One read of a signal
+struct SignalUse
+{
+    uint32_t operation; // Index in the operation list
+    uint8_t slot; // Operand slot that reads the signal
+    PortRole role;
+};
+
+// A read-only view of the uses of one signal
+struct UseRange
+{
+    const SignalUse* first;
+    const SignalUse* last;
+
+    size_t size() const { return (size_t)(last - first); }
+    bool empty() const { return first == last; }
+    const SignalUse& operator[](size_t i) const { return first[i]; }
+    const SignalUse* begin() const { return first; }
+    const SignalUse* end() const { return last; }
+};
+
+/*
+    Use-def index of the operations: for every symbol, the operation that defines it and the operations that
+    read it with the port they read it through. Uses are stored in compressed arrays (counted, then placed),
+    so building takes time linear in the number of operands, and every query is a constant-time lookup
+*/
+class UseDefIndex
+{
+    private:
+        vector<int> definitions; // Operation that drives each symbol (indexed by symbol ID), or -1 for inputs and undriven nets
+        vector<uint8_t> roleMasks; // Bit (1 << role) is set if the symbol is read through a port of that role
+        vector<uint32_t> useStart; // Index of the first use of each symbol in uses (plus one past the last symbol)
+        vector<SignalUse> uses; // Uses of every symbol, packed back to back in operation order
+
+    public:
+
+        void build(const OpList& ops, size_t symbolCount);
+        void clear(); // Index no symbol, keeping the capacity for the next netlist
+
+        size_t size() const; // Number of symbols
+        int getDefinition(int symbol) const;
+        UseRange getUses(int symbol) const;
+        bool isUsedAs(int symbol, PortRole role) const;
 };
 
 // Class to store each net type (input, output, wire, register)
@@ -78,9 +313,9 @@ class SetNet
 {
     private:
         
-        string netType; // the type: "i" for input, "o" for output, "w" for wire, "u" for unassigned
+        string_view netType; // the type: "input", "output", or "wire" (a string literal)
         int bitWidth; // Bitwidth of the variable
-        string varNames; //the name of the variable
+        string_view varNames; //the name of the variable (stored in the arena of the conversion)
 
     public:
 
@@ -93,21 +328,39 @@ class SetNet
         }
 
         // Parameterized Constructor
-        SetNet( string netType, int bit, string var )
+        SetNet( string_view netType, int bit, string_view var )
         {
             this->netType = netType; // Assign the corresponding net type
             this->bitWidth = bit; // Store the bit width of te variables
             this->varNames = var; // Store the variable names as it is (e.g., "a, b, c")
         }
 
-    	string getVarNames() const;
-		string getNetType() const;
+    	string_view getVarNames() const;
+		string_view getNetType() const;
 		int getBitWidth() const;
 
-        void printInput(ofstream& file) const;
-        void printOutput(ofstream& file) const;
-        void printWire(ofstream& file, vector<SetOp> ops) const;
-        void printRegister(ofstream& file) const;
+        void printInput(Emitter& file) const;
+        void printOutput(Emitter& file) const;
+        void printWire(Emitter& file, const UseDefIndex& useDefs, const SymbolTable& symbols) const;
+        void printRegister(Emitter& file, const SymbolTable& symbols) const;
+};
+
+// Options of a conversion
+struct ConvertOptions
+{
+    string cacheDir; // Directory of the conversion cache (empty disables the cache)
+    bool collectStats = false; // Fill the ConversionStats of each conversion (--stats)
+    bool eliminateCommonSubexpressions = false; // Merge operations that compute the same value (--cse)
+    bool minimizeWidths = false; // Give each instance, wire, and register the fewest bits that keep the outputs (--min-width)
+    unsigned emitThreads = 0; // Threads that format the instances (--emit-threads=N), 0 for one per core; the output does not depend on it
+    double clockPeriod = 0; // Insert pipeline registers so no stage is slower than this (ns) (--clock-period), 0 to keep the registers of the netlist
+    bool retime = false; // Move the registers to the places that give the shortest clock period (--retime)
+    vector<int> unitLimits; // Functional units of each instance counter that the operations share (--resources), empty for one instance per operation
+    bool criticalPath = false; // Report the critical path of the parsed netlist (--critical-path)
+    bool costReport = false; // Report the area and the output slacks of the parsed netlist (--cost, --cost-json)
+    string costJsonFile; // Where the single conversion writes the cost report as JSON (--cost-json=file), empty for none; it reads the parsed netlist, so the cache is not used
+
+    string fingerprint() const; // The options that change the generated Verilog or the report, as part of the cache key
 };
 
 // Class that stores a set of those net types or operations
@@ -115,33 +368,110 @@ class NetParser //this class implements not only wires, but also inputs, outputs
 {
     private:
 
+        Arena arena; // Names and declaration text of the current conversion, released at once by clear()
         vector<SetNet> inputs;
 		vector<SetNet> outputs;
 		vector<SetNet> wires;
 		vector<SetNet> registers;
-        vector<SetOp> operations;
+        OpList operations;
+        UseDefIndex useDefs; // Definition and uses of every symbol, rebuilt whenever the operations change
         
-        unordered_map<string, variableInfo> variableBits; // Create an unordered map to store each variable with a vector strings
+        SymbolTable symbols; // Interned variables with their net type, sign type, and bit width
+        string errorMessage; // Why the last conversion failed (empty if it succeeded)
+        ConvertOptions options; // Options of the conversions run by this parser
+        ConversionStats stats; // Phase times and counts of the last conversion (when options.collectStats is set)
+        size_t removedInstances = 0; // Instances removed by the optimization passes of the last conversion
+        WidthSavings widthSavings; // Instances and nets narrowed by the optimization passes of the last conversion
+        size_t pipelineRegisters = 0; // Registers inserted by pipelining in the last conversion
+        size_t pipelineRegistersNeeded = 0; // Registers its stages take (more than were inserted if there were too many)
+        int pipelineLatency = 0; // Clock cycles pipelining added between the inputs and the outputs
+        bool pipelineBalanced = true; // False if pipelining gave up because an output is computed from another one over more than a period
+        RetimeResult retiming; // Where retiming moved the registers in the last conversion
+        ScheduleResult schedule; // Steps and units of the last conversion (when unit limits are set)
+        vector<uint32_t> operationLines; // Netlist line of each operation (empty for a precompiled netlist)
+        int lastDeclarationLine = 0; // Line of the last declaration in the netlist
+        size_t literalCount = 0; // Integer literal operands of the netlist (of a precompiled one, its distinct values); folding is skipped without any
+        FoldResult folding; // What constant folding did in the last conversion
+        string report; // The report of the last conversion (printConversionReport), from the cache on a hit
+
+        friend class NetlistImage; // Fills the parser from a precompiled netlist instead of parseText()
+
+        void declareNets(const vector<int>& ids, bool registers); // Declarations of registers or wires added by a pass, one per width
 
     public:
 
+        // Default Constructor
+        NetParser() : symbols(&arena)
+        {
+        }
+
+        NetParser(const NetParser&) = delete; // The symbol table points into the arena of this parser
+        NetParser& operator=(const NetParser&) = delete;
+
     	void setInput(SetNet input);
 		void setOutput(SetNet output);
 		void setWire(SetNet wire);
 		void setRegister(SetNet reg);
         void setOperation(SetOp op);
 
-        void setVarBit(string netType, char signType, int bit, string var);
-        const unordered_map<string, variableInfo>& getVariableBits() const;
+        void setVarBit(string_view netType, char signType, int bit, string_view var);
+        int internVar(string_view var);
+        int internVar(string_view var, string_view suffix); // e.g., the "xwire" in front of output "x"
+        int internLiteral(uint64_t value); // The constant symbol of an integer literal operand
+        string_view keepText(string_view text); // Copy text into the arena of the conversion
+        const SymbolTable& getSymbols() const;
         void setBitWidthToOne(string var);
 
         const vector<SetNet>& getInputs() const;
         const vector<SetNet>& getOutputs() const;
         const vector<SetNet>& getWires() const;
         const vector<SetNet>& getRegisters() const;
-        const vector<SetOp>& getOperations() const;
+        const OpList& getOperations() const;
+        const UseDefIndex& getUseDefs() const;
+        const vector<uint32_t>& getOperationLines() const;
+        int getLastDeclarationLine() const;
+        size_t getLiteralCount() const;
 
-        bool convertToVerilog(string inputFile, string outputFile);
+        const string& getErrorMessage() const;
+
+        void setOptions(const ConvertOptions& options);
+        const ConvertOptions& getOptions() const;
+        const ConversionStats& getStats() const;
+        size_t getRemovedInstances() const;
+        const WidthSavings& getWidthSavings() const;
+        size_t getPipelineRegisters() const;
+        size_t getPipelineRegistersNeeded() const;
+        int getPipelineLatency() const;
+        bool isPipelineBalanced() const;
+        const RetimeResult& getRetiming() const;
+        const ScheduleResult& getSchedule() const;
+        const FoldResult& getFolding() const;
+        const string& getReport() const;
+
+        bool convertToVerilog(string inputFile, string outputFile, string moduleName = ""); // The module is named after outputFile unless moduleName is given
+        bool convertTextToVerilog(string_view netlistText, string outputFile, string moduleName = "");
+
+        /*
+            Conversions that never touch the filesystem (except the cache, when one is set); the parsed netlist stays in
+            this parser. A cache hit skips parsing, so it leaves the parser empty (as after clear()) but for the report of
+            the conversion (getReport); a caller that inspects the netlist converts without a cache directory
+        */
+        bool convertText(string_view netlistText, const string& moduleName, string& verilogText); // Return the Verilog in verilogText
+        bool convertText(string_view netlistText, const string& moduleName, ostream& sink); // Write the Verilog into sink (e.g., cout)
+
+        // The two halves of a conversion, for callers that time or inspect them separately
+        bool parseText(string_view netlistText); // Return false (with the error message set) if the netlist marks an error
+        void optimize(); // Run the optimization passes enabled in the options
+        string emitVerilog(const string& moduleName);
+        void clear();
+
+        // Replace operations [firstOp, lastOp) with those of the operation lines in text, which start at line firstLine,
+        // and move the lines of the later operations by lineShift. Return false, leaving the netlist unchanged, if text holds
+        // anything but operations or if the edit would change the registers synthesized for outputs (dpgen --watch).
+        // selectsChanged tells whether a wire started or stopped being a MUX select, which changes its declaration
+        bool replaceOperationText(size_t firstOp, size_t lastOp, string_view text, int firstLine, int lineShift, bool& selectsChanged);
 };
 
+void printModuleHead(Emitter& file, const string& moduleName, const NetParser& netParser); // The module text before the first instance
+
 #endif
\ No newline at end of file
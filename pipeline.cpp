@@ -0,0 +1,509 @@
+#include "pipeline.h"
+#include "dataflow.h"
+
+#include <algorithm> // Provides sort(), min(), and max()
+#include <climits> // Provides INT_MAX
+#include <string>
+#include <utility> // Provides pair
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// Strongly connected components of the operations, linked from each operation to the drivers of its inputs
+struct Components
+{
+    vector<int> componentOf; // Component of each operation (-1 if it is not emitted)
+    vector<uint32_t> start; // Index of the first member of each component in members (plus one past the last component)
+    vector<int> members; // Operations of every component, packed back to back
+
+    size_t size() const { return this->start.size() - 1; }
+};
+
+static bool isPort(const variableInfo& info)
+{
+    return info.netType == INPUT || info.netType == OUTPUT;
+}
+
+/*
+    Tarjan's algorithm with an explicit stack, so a long chain of operations cannot overflow the call stack.
+    It follows the edges from readers to drivers, so every component comes after the components that drive it
+*/
+static Components findComponents(const OpList& ops, const DataflowGraph& graph)
+{
+    size_t count = ops.size();
+    Components components;
+    components.componentOf.assign(count, -1);
+    components.start.push_back(0);
+
+    vector<int> visitIndex(count, -1); // Order in which each operation was first reached
+    vector<int> lowLink(count, 0); // Earliest visit index reachable from the operation without leaving the stack
+    vector<uint8_t> onStack(count, 0);
+    vector<int> stack;
+    vector<pair<int, uint32_t>> frames; // Operation being visited and its next operand slot
+    int visited = 0;
+
+    auto enter = [&](int operation)
+    {
+        visitIndex[operation] = lowLink[operation] = visited++;
+        stack.push_back(operation);
+        onStack[operation] = 1;
+        frames.push_back(make_pair(operation, 1u)); // Operand 0 is the output
+    };
+
+    for (size_t root = 0; root < count; ++root)
+    {
+        if (ops.getOpcode(root) == Opcode::NONE || visitIndex[root] >= 0)
+        {
+            continue;
+        }
+
+        enter((int)root);
+        while (!frames.empty())
+        {
+            int operation = frames.back().first;
+            OperandRange operands = ops.getOperands((size_t)operation);
+
+            if (frames.back().second < operands.size())
+            {
+                int driver = graph.getDriver(operands[frames.back().second++]);
+                if (driver < 0)
+                {
+                    continue;
+                }
+                if (visitIndex[driver] < 0)
+                {
+                    enter(driver);
+                }
+                else if (onStack[driver])
+                {
+                    lowLink[operation] = min(lowLink[operation], visitIndex[driver]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty())
+            {
+                lowLink[frames.back().first] = min(lowLink[frames.back().first], lowLink[operation]);
+            }
+
+            if (lowLink[operation] == visitIndex[operation]) // The root of a component, which is on the stack above it
+            {
+                int component = (int)components.size();
+                int member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = 0;
+                    components.componentOf[member] = component;
+                    components.members.push_back(member);
+                } while (member != operation);
+                components.start.push_back((uint32_t)components.members.size());
+            }
+        }
+    }
+
+    return components;
+}
+
+void declareSelectsWithOneBit(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, const vector<int>& nets)
+{
+    bool widthsKept = false;
+    for (int id : nets)
+    {
+        variableInfo& info = symbols.getInfo(id);
+        if (info.netType != WIRE || info.bitWidth == 1 || id >= (int)useDefs.size() || !useDefs.isUsedAs(id, PortRole::SELECT))
+        {
+            continue;
+        }
+
+        if (!widthsKept) // Before the first width changes, so every rule sees the declared widths
+        {
+            for (size_t index = 0; index < ops.size(); ++index)
+            {
+                if (ops.getOpcode(index) != Opcode::NONE)
+                {
+                    ops.setDataWidth(index, ops.getDataWidth(index, symbols));
+                }
+            }
+            widthsKept = true;
+        }
+        info.bitWidth = 1;
+    }
+    return;
+}
+
+PipelineResult pipelineDatapath(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, double clockPeriod)
+{
+    PipelineResult result;
+    size_t count = ops.size();
+    size_t symbolCount = symbols.size();
+
+    DataflowGraph graph; // Drivers, delays, and the combinational edges
+    graph.build(ops, symbols);
+
+    vector<int> order;
+    if (!graph.topologicalOrder(order)) // A combinational loop has no stages
+    {
+        return result;
+    }
+    result.pipelined = true;
+
+    // The members of each component in dataflow order, so the arrivals inside a loop follow its combinational edges
+    vector<int> position(count, 0);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        position[order[i]] = (int)i;
+    }
+    Components components = findComponents(ops, graph);
+    for (size_t component = 0; component < components.size(); ++component)
+    {
+        sort(components.members.begin() + components.start[component], components.members.begin() + components.start[component + 1],
+            [&](int a, int b) { return position[a] < position[b]; });
+    }
+
+    vector<int> stage(count, 0); // Clock cycle, counted from the inputs, in which each operation computes
+    vector<double> arrival(count, 0); // Time its output settles within the stage (ns), the register delay for a REG
+    vector<int> floorStage(components.size(), 0); // Earliest stage of each component (raised to balance the outputs)
+
+    auto driverStage = [&](int symbol)
+    {
+        int driver = graph.getDriver(symbol);
+        return driver >= 0 ? stage[driver] : 0; // Inputs arrive in the first stage
+    };
+
+    // An integer literal holds its value in every stage, so its readers keep reading it without registers
+    auto isLiteral = [&](int symbol) { return symbols.getInfo(symbol).netType == CONSTANT; };
+
+    // When an input of an operation settles, counted like analyzeTiming() does, plus the registers inserted in front of it
+    auto inputReady = [&](int operation, int symbol, bool& fromStageLogic)
+    {
+        int driver = graph.getDriver(symbol);
+        const variableInfo& info = symbols.getInfo(symbol);
+
+        if (isLiteral(symbol))
+        {
+            return 0.0;
+        }
+        if (stage[operation] > driverStage(symbol)) // Through an inserted register
+        {
+            return componentDelay(Opcode::REG, info.bitWidth, info.signType == 's'); // A copy of the net, so signed if it is
+        }
+        if (driver < 0 || isPort(info))
+        {
+            return 0.0;
+        }
+        if (ops.getOpcode((size_t)driver) == Opcode::REG)
+        {
+            return graph.getDelay((size_t)driver);
+        }
+        if (components.componentOf[driver] != components.componentOf[operation])
+        {
+            fromStageLogic = true; // One more stage would register this input
+        }
+        return arrival[driver];
+    };
+
+    // Put a component in a stage, returning the latest time an operation output or register input settles
+    auto place = [&](size_t component, int level, bool& fromStageLogic)
+    {
+        double latest = 0;
+        for (uint32_t m = components.start[component]; m < components.start[component + 1]; ++m)
+        {
+            stage[components.members[m]] = level;
+        }
+
+        for (uint32_t m = components.start[component]; m < components.start[component + 1]; ++m)
+        {
+            int operation = components.members[m];
+            OperandRange operands = ops.getOperands((size_t)operation);
+            double start = 0;
+            for (size_t slot = 1; slot < operands.size(); ++slot)
+            {
+                start = max(start, inputReady(operation, operands[slot], fromStageLogic));
+            }
+
+            if (ops.getOpcode((size_t)operation) == Opcode::REG) // Captures its input, then launches a new path
+            {
+                arrival[operation] = graph.getDelay((size_t)operation);
+                latest = max(latest, max(start, arrival[operation]));
+            }
+            else
+            {
+                arrival[operation] = start + graph.getDelay((size_t)operation);
+                latest = max(latest, arrival[operation]);
+            }
+        }
+        return latest;
+    };
+
+    // As soon as possible: the stage of the latest driver outside the component, or the next one if the period is exceeded
+    auto schedule = [&]()
+    {
+        for (size_t component = 0; component < components.size(); ++component)
+        {
+            int level = floorStage[component];
+            for (uint32_t m = components.start[component]; m < components.start[component + 1]; ++m)
+            {
+                OperandRange operands = ops.getOperands((size_t)components.members[m]);
+                for (size_t slot = 1; slot < operands.size(); ++slot)
+                {
+                    int driver = graph.getDriver(operands[slot]);
+                    if (driver >= 0 && components.componentOf[driver] != (int)component)
+                    {
+                        level = max(level, stage[driver]);
+                    }
+                }
+            }
+
+            bool fromStageLogic = false;
+            if (place(component, level, fromStageLogic) > clockPeriod && fromStageLogic)
+            {
+                bool unused = false;
+                place(component, level + 1, unused); // Every input now comes through a register, so a later stage would not help
+            }
+        }
+    };
+
+    // Schedule until the operations driving outputs share the last stage
+    vector<int> outputDrivers;
+    for (size_t id = 0; id < symbolCount; ++id)
+    {
+        int driver = graph.getDriver((int)id);
+        if (symbols.getInfo((int)id).netType == OUTPUT && driver >= 0)
+        {
+            outputDrivers.push_back(driver);
+        }
+    }
+
+    int previousLast = -1;
+    while (true)
+    {
+        schedule();
+
+        int last = 0;
+        for (int driver : outputDrivers)
+        {
+            last = max(last, stage[driver]);
+        }
+
+        /*
+            Raising the floors only moves the outputs that were early. If the last stage moved as well, one of them
+            drives another output through logic slower than the period, which the next round would push again
+        */
+        if (previousLast >= 0 && last > previousLast)
+        {
+            result.pipelined = false;
+            result.balanced = false;
+            return result;
+        }
+        previousLast = last;
+
+        bool raised = false;
+        for (int driver : outputDrivers)
+        {
+            if (stage[driver] < last)
+            {
+                floorStage[components.componentOf[driver]] = last;
+                raised = true;
+            }
+        }
+
+        if (!raised)
+        {
+            result.latency = last;
+            break;
+        }
+    }
+
+    /*
+        As soon as possible leaves a value that is read much later on a long chain of registers. Walking back from
+        the outputs, each component moves to the stage before its earliest reader when that saves register bits
+        (its outputs wait less, its inputs longer) and it still settles within the period, or no later than before
+    */
+    vector<int> lastRead(symbolCount, 0); // Latest stage that reads each net
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::NONE)
+        {
+            continue;
+        }
+        OperandRange operands = ops.getOperands(index);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            lastRead[operands[slot]] = max(lastRead[operands[slot]], stage[index]);
+        }
+    }
+
+    vector<uint8_t> drivesOutput(components.size(), 0);
+    for (int driver : outputDrivers)
+    {
+        drivesOutput[components.componentOf[driver]] = 1;
+    }
+
+    vector<int> countedBy(symbolCount, -1); // Component that last counted the bits of an input net
+    for (size_t component = components.size(); component-- > 0;)
+    {
+        int level = stage[components.members[components.start[component]]];
+        int target = INT_MAX;
+        for (uint32_t m = components.start[component]; m < components.start[component + 1] && !drivesOutput[component]; ++m)
+        {
+            for (const SignalUse& use : useDefs.getUses(ops.getOperands((size_t)components.members[m])[0]))
+            {
+                if (components.componentOf[use.operation] != (int)component)
+                {
+                    target = min(target, stage[use.operation] - 1);
+                }
+            }
+        }
+        if (target == INT_MAX || target <= level)
+        {
+            continue;
+        }
+
+        long long saved = 0;
+        long long added = 0;
+        for (uint32_t m = components.start[component]; m < components.start[component + 1]; ++m)
+        {
+            OperandRange operands = ops.getOperands((size_t)components.members[m]);
+            if (lastRead[operands[0]] > level) // Read outside the component
+            {
+                saved += (long long)symbols.getInfo(operands[0]).bitWidth * (target - level);
+            }
+            for (size_t slot = 1; slot < operands.size(); ++slot)
+            {
+                int symbol = operands[slot];
+                int driver = graph.getDriver(symbol);
+                if ((driver < 0 || components.componentOf[driver] != (int)component) && countedBy[symbol] != (int)component && !isLiteral(symbol))
+                {
+                    countedBy[symbol] = (int)component;
+                    added += (long long)symbols.getInfo(symbol).bitWidth * max(0, target - lastRead[symbol]);
+                }
+            }
+        }
+        if (saved <= added)
+        {
+            continue;
+        }
+
+        bool unused = false;
+        double before = place(component, level, unused);
+        if (place(component, target, unused) > max(clockPeriod, before))
+        {
+            place(component, level, unused);
+            continue;
+        }
+
+        for (uint32_t m = components.start[component]; m < components.start[component + 1]; ++m)
+        {
+            OperandRange operands = ops.getOperands((size_t)components.members[m]);
+            for (size_t slot = 1; slot < operands.size(); ++slot)
+            {
+                lastRead[operands[slot]] = max(lastRead[operands[slot]], target);
+            }
+        }
+    }
+
+    // Each net needs one register per stage between its driver and its latest reader
+    vector<int> depth(symbolCount, 0);
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::NONE)
+        {
+            continue;
+        }
+        OperandRange operands = ops.getOperands(index);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            if (!isLiteral(operands[slot]))
+            {
+                depth[operands[slot]] = max(depth[operands[slot]], stage[index] - driverStage(operands[slot]));
+            }
+        }
+    }
+
+    for (int registers : depth)
+    {
+        result.registersNeeded += (size_t)registers;
+    }
+    if (result.registersNeeded > MAX_PIPELINE_REGISTERS_PER_OPERATION * max(count, (size_t)64)) // Left as it was
+    {
+        result.pipelined = false;
+        result.latency = 0;
+        return result;
+    }
+
+    vector<int> registered;
+    for (size_t id = 0; id < symbolCount; ++id)
+    {
+        if (depth[id] > 0)
+        {
+            registered.push_back((int)id);
+        }
+    }
+    declareSelectsWithOneBit(ops, symbols, useDefs, registered);
+
+    // A chain of registers per net, named after it (e.g., "d_p1", "d_p2"), which every later reader shares
+    vector<int> chainStart(symbolCount, -1);
+    vector<int> chain;
+    for (size_t id = 0; id < symbolCount; ++id)
+    {
+        if (depth[id] == 0)
+        {
+            continue;
+        }
+
+        variableInfo info = symbols.getInfo((int)id); // A copy, since interning below may move the records
+        string name(symbols.getName((int)id));
+        int previous = (int)id;
+
+        chainStart[id] = (int)chain.size();
+        for (int k = 1; k <= depth[id]; ++k)
+        {
+            string suffix = "_p" + to_string(k);
+            size_t known = symbols.size();
+            int reg = symbols.intern(name, suffix);
+            while (symbols.size() == known) // Taken by another net
+            {
+                suffix += "_";
+                reg = symbols.intern(name, suffix);
+            }
+            variableInfo& regInfo = symbols.getInfo(reg);
+            regInfo.netType = "reg";
+            regInfo.signType = info.signType;
+            regInfo.bitWidth = info.bitWidth;
+
+            int operands[2] = { reg, previous };
+            ops.push(SetOp(Opcode::REG, operands, 2));
+            chain.push_back(reg);
+            result.registers.push_back(reg);
+            previous = reg;
+        }
+    }
+
+    // Each reader takes the register of its own stage
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) == Opcode::NONE)
+        {
+            continue;
+        }
+        OperandRange operands = ops.getOperands(index);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            int symbol = operands[slot];
+            int registers = stage[index] - driverStage(symbol);
+            if (registers > 0 && !isLiteral(symbol))
+            {
+                ops.setOperand(index, slot, chain[chainStart[symbol] + registers - 1]);
+            }
+        }
+    }
+
+    return result;
+}
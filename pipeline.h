@@ -0,0 +1,59 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "parser.h"
+
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    A netlist whose values are read many stages after they are computed (e.g., a select computed near the inputs
+    of a long chain of operations) would need a register per stage for each of them; past this many registers per
+    operation, the netlist is left unpipelined
+*/
+const size_t MAX_PIPELINE_REGISTERS_PER_OPERATION = 16;
+
+// What pipelining added to a netlist
+struct PipelineResult
+{
+    bool pipelined = false; // False if a combinational loop leaves the stages undefined, the outputs cannot share a stage, or too many registers would be needed
+    bool balanced = true; // False if an output is computed from another output over more than a period, so one always lands a stage after the other
+    int latency = 0; // Clock cycles added between the inputs and the outputs
+    vector<int> registers; // Nets of the inserted registers (symbol IDs), already declared in the symbol table as "reg"
+    size_t registersNeeded = 0; // Registers the stages take, inserted only if within MAX_PIPELINE_REGISTERS_PER_OPERATION
+};
+
+/*
+    printWire() declares a wire that selects a MUX with one bit, whatever its declared width. A pass that moves the
+    select readers of such a wire to registers declares it (and so its registers) with one bit outright, so it keeps
+    the value it had; the DATAWIDTH of every instance is kept as the width rule gave it
+*/
+void declareSelectsWithOneBit(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, const vector<int>& nets);
+
+/*
+    Cut the datapath into stages of at most clockPeriod ns (with the delays of componentDelay()) by inserting REG
+    instances. Every operation gets a stage, assigned as soon as possible in dataflow order: the stage of its
+    latest driver, or one more when its inputs from that stage would settle too late. An input from an earlier
+    stage goes through one register per stage in between, and the chain of registers of a net is shared by all of
+    its readers; an integer literal holds its value in every stage, so it is read as it is. The operations driving outputs are all moved to the last stage (with balancing registers in front
+    of the ones that were early), so every path from an input to an output gains the same latency and the module
+    computes the same outputs, that many cycles later. Then, walking back from the outputs, an operation whose
+    value waits on a long chain moves to the stage before its earliest reader when that takes fewer register bits.
+
+    The stages of the operations around a loop through a register all stay the same, since a register inserted
+    inside the loop would change what it computes; such a loop keeps its delay. The inserted registers reset to 0
+    like the others, so the outputs of the first latency cycles after a reset (and a loop that reads them) start
+    from those zeros. Operations and nets are appended, so the existing instances keep their names.
+
+    An output read by the logic of another output (e.g., "y = x + a" with output x) ties the two: if that logic
+    is slower than the period, moving the first output to the last stage pushes the second one past it every
+    time. Such a netlist is left unpipelined, with balanced set to false
+*/
+PipelineResult pipelineDatapath(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, double clockPeriod);
+
+#endif
@@ -0,0 +1,186 @@
+#include "report.h"
+#include "parser.h"
+#include "dataflow.h"
+#include "bitwidth.h"
+#include "pipeline.h"
+#include "schedule.h"
+
+#include <cstdio> // Provides snprintf() to format the numbers of a report
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// The registers --clock-period inserted and the clock period the pipelined module reaches
+static void printPipelineReport(ostream& out, const NetParser& netParser, double clockPeriod)
+{
+    DataflowGraph graph;
+    graph.build(netParser.getOperations(), netParser.getSymbols());
+    TimingReport timing = graph.analyzeTiming();
+    char line[128];
+
+    if (timing.hasLoop)
+    {
+        out << "Not pipelined: the stages of a combinational loop are undefined" << endl;
+        return;
+    }
+    if (!netParser.isPipelineBalanced())
+    {
+        out << "Not pipelined: an output is computed from another output by logic slower than the period, so they cannot share the last stage" << endl;
+        return;
+    }
+    if (netParser.getPipelineRegistersNeeded() > netParser.getPipelineRegisters())
+    {
+        snprintf(line, sizeof(line), "Not pipelined: the stages would need %zu registers, more than %zu per operation", netParser.getPipelineRegistersNeeded(), MAX_PIPELINE_REGISTERS_PER_OPERATION);
+        out << line << endl;
+        return;
+    }
+
+    snprintf(line, sizeof(line), "Pipelined for %.3f ns: %zu registers inserted, latency +%d cycles", clockPeriod, netParser.getPipelineRegisters(), netParser.getPipelineLatency());
+    out << line << "\n";
+    if (timing.criticalPath > 0)
+    {
+        snprintf(line, sizeof(line), "Achieved clock period %.3f ns (%.2f MHz)", timing.criticalPath, 1000.0 / timing.criticalPath);
+        out << line;
+        if (timing.criticalPath > clockPeriod)
+        {
+            out << ", since a component or a loop through a register is slower than the target";
+        }
+        out << "\n";
+    }
+    out.flush();
+    return;
+}
+
+// Where --retime moved the registers, with the critical path before and after
+static void printRetimeReport(ostream& out, const NetParser& netParser)
+{
+    const RetimeResult& retiming = netParser.getRetiming();
+    char line[128];
+
+    if (retiming.hasLoop)
+    {
+        out << "Not retimed: the clock period of a combinational loop is undefined" << endl;
+        return;
+    }
+    if (retiming.movableRegisters == 0)
+    {
+        out << "Not retimed: no register only delays its net (registers that change the width of their net stay in place)" << endl;
+        return;
+    }
+    if (!retiming.retimed)
+    {
+        snprintf(line, sizeof(line), "Not retimed: the %zu registers already give the shortest clock period (%.3f ns)", retiming.movableRegisters, retiming.periodBefore);
+        out << line << endl;
+        return;
+    }
+
+    snprintf(line, sizeof(line), "Retimed %zu registers into %zu: clock period %.3f ns -> %.3f ns", retiming.movableRegisters, retiming.registersAfter, retiming.periodBefore, retiming.periodAfter);
+    out << line << "\n";
+    out << "Before retiming:" << "\n" << retiming.pathBefore;
+    out << "After retiming:" << "\n";
+
+    DataflowGraph graph;
+    graph.build(netParser.getOperations(), netParser.getSymbols());
+    printTimingReport(out, graph, graph.analyzeTiming());
+    return;
+}
+
+// The steps --resources scheduled the operations into, and how busy the shared units are
+static void printScheduleReport(ostream& out, const NetParser& netParser)
+{
+    const ScheduleResult& schedule = netParser.getSchedule();
+    char line[160];
+
+    if (schedule.hasLoop)
+    {
+        out << "Not scheduled: the steps of a combinational loop are undefined" << endl;
+        return;
+    }
+    if (!schedule.scheduled)
+    {
+        out << "Not scheduled: no operation needs a functional unit" << endl;
+        return;
+    }
+
+    snprintf(line, sizeof(line), "Scheduled %zu operation%s in %d step%s: one netlist cycle every %d clock cycle%s, outputs valid in the last",
+             schedule.operations, schedule.operations == 1 ? "" : "s", schedule.steps, schedule.steps == 1 ? "" : "s", schedule.steps, schedule.steps == 1 ? "" : "s");
+    out << line << "\n";
+    for (const UnitUsage& usage : schedule.usage)
+    {
+        double busy = 100.0 * (double)usage.operations / ((double)usage.units * schedule.steps);
+        if (usage.limit == 0) // Each unit is busy in one step only
+        {
+            snprintf(line, sizeof(line), "\t%-4s: %d unit%s, one per operation", usage.kind.c_str(), usage.units, usage.units == 1 ? "" : "s");
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "\t%-4s: %d of %d unit%s, %zu operation%s in %d unit-step%s, %.1f%% busy", usage.kind.c_str(), usage.units, usage.limit, usage.limit == 1 ? "" : "s",
+                     usage.operations, usage.operations == 1 ? "" : "s", usage.units * schedule.steps, usage.units * schedule.steps == 1 ? "" : "s", busy);
+        }
+        out << line;
+        if (usage.units > usage.limit && usage.limit > 0)
+        {
+            out << " (more than the limit, since signed and unsigned operations, or comparators and shifts of different widths, cannot share a unit)";
+        }
+        out << "\n";
+    }
+    snprintf(line, sizeof(line), "Added %zu multiplexer%s, %zu result register%s, and a %d-state controller", schedule.multiplexers, schedule.multiplexers == 1 ? "" : "s",
+             schedule.registers.size(), schedule.registers.size() == 1 ? "" : "s", schedule.steps);
+    out << line << endl;
+    return;
+}
+
+void printConversionReport(ostream& out, const NetParser& netParser)
+{
+    const ConvertOptions& options = netParser.getOptions();
+
+    if (netParser.getFolding().changed())
+    {
+        const FoldResult& folding = netParser.getFolding();
+        out << "Constant folding left " << folding.wired << (folding.wired == 1 ? " operation" : " operations") << " as wiring ("
+            << folding.folded << " folded, " << folding.simplified << " simplified, " << folding.strengthReduced << " strength-reduced)" << endl;
+    }
+
+    if (options.eliminateCommonSubexpressions && netParser.getRemovedInstances() != 0)
+    {
+        out << "Common subexpression elimination removed " << netParser.getRemovedInstances() << " instances" << endl;
+    }
+
+    if (options.minimizeWidths && (!netParser.getWidthSavings().instances.empty() || !netParser.getWidthSavings().nets.empty()))
+    {
+        printWidthReport(out, netParser);
+    }
+
+    if (options.clockPeriod > 0)
+    {
+        printPipelineReport(out, netParser, options.clockPeriod);
+    }
+
+    if (options.retime)
+    {
+        printRetimeReport(out, netParser);
+    }
+
+    if (!options.unitLimits.empty())
+    {
+        printScheduleReport(out, netParser);
+    }
+
+    if (options.criticalPath && !options.retime) // The retiming report already ends with the critical path
+    {
+        DataflowGraph graph; // Edges from each operation to the operations that read its output
+        graph.build(netParser.getOperations(), netParser.getSymbols());
+        printTimingReport(out, graph, graph.analyzeTiming());
+    }
+
+    if (options.costReport) // The area of the instances and the slack of each output, with the costs of the component library
+    {
+        DataflowGraph graph;
+        graph.build(netParser.getOperations(), netParser.getSymbols());
+        printCostReport(out, graph.analyzeCost(options.clockPeriod), netParser.getSymbols());
+    }
+    return;
+}
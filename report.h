@@ -0,0 +1,21 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <ostream>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+class NetParser;
+
+/*
+    What the passes and the analyses the options of netParser ask for did in its last conversion: constant folding,
+    --cse, --min-width, --clock-period, --retime, --resources, --critical-path, and --cost, in that order. convertText
+    keeps it (NetParser::getReport) and the cache stores it with the Verilog, so a hit prints the same report
+*/
+void printConversionReport(ostream& out, const NetParser& netParser);
+
+#endif
@@ -0,0 +1,498 @@
+#include "retime.h"
+#include "dataflow.h"
+#include "pipeline.h" // Provides declareSelectsWithOneBit()
+
+#include <algorithm> // Provides sort() and max()
+#include <sstream> // Provides ostringstream
+#include <string>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const double PERIOD_RESOLUTION = 0.001; // The binary search stops once the period is known this closely (ns), as precisely as the reports print it
+
+// One input of the retiming graph: a net read through a chain of registers that only delay it
+struct RetimeEdge
+{
+    int from; // Vertex of the operation that drives the chain, or the host
+    int to; // Vertex of the operation that reads it, or the host
+    int weight; // Registers on the chain
+    int minimum; // Registers the edge keeps (one in front of an output that a register drives, or of a select read from a wide wire)
+    int source; // Net the chain starts from
+    int reader; // Operation that reads the chain, or -1 for an output
+    int slot; // Operand slot it reads, or the symbol ID of the output
+    double launch; // When source settles if it is read without a register: the delay of a register that stays, 0 for a port
+    double registerDelay; // Delay of a register on the chain
+};
+
+// The output of a register at some depth of a chain, which the rebuilt chain names the same way
+struct ChainName
+{
+    int source; // Net the chain starts from
+    int depth; // Registers between source and name
+    int name;
+};
+
+// Width of a net in the emitted module, where printWire() declares a wire that selects a MUX with one bit
+static int emittedWidth(int symbol, const SymbolTable& symbols, const UseDefIndex& useDefs)
+{
+    const variableInfo& info = symbols.getInfo(symbol);
+    if (info.netType == WIRE && symbol < (int)useDefs.size() && useDefs.isUsedAs(symbol, PortRole::SELECT))
+    {
+        return 1;
+    }
+    return info.bitWidth;
+}
+
+// A register that only delays its net (as wide as its input and output, and of the same sign) and that something reads, or that drives an output
+static bool onlyDelays(const OpList& ops, size_t index, const SymbolTable& symbols, const UseDefIndex& useDefs)
+{
+    if (ops.getOpcode(index) != Opcode::REG)
+    {
+        return false;
+    }
+
+    OperandRange operands = ops.getOperands(index);
+    int width = ops.getDataWidth(index, symbols);
+    if (emittedWidth(operands[0], symbols, useDefs) != width || emittedWidth(operands[1], symbols, useDefs) != width)
+    {
+        return false;
+    }
+    if (symbols.getInfo(operands[0]).signType != symbols.getInfo(operands[1]).signType) // Its readers are signed or unsigned by it
+    {
+        return false;
+    }
+    return symbols.getInfo(operands[0]).netType == OUTPUT || !useDefs.getUses(operands[0]).empty();
+}
+
+RetimeResult retimeRegisters(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs)
+{
+    RetimeResult result;
+    size_t count = ops.size();
+    size_t symbolCount = symbols.size();
+
+    DataflowGraph graph; // Drivers, delays, and the critical path before retiming
+    graph.build(ops, symbols);
+    TimingReport before = graph.analyzeTiming();
+    if (before.hasLoop)
+    {
+        result.hasLoop = true;
+        return result;
+    }
+    result.periodBefore = result.periodAfter = before.criticalPath;
+
+    ostringstream path;
+    printTimingReport(path, graph, before);
+    result.pathBefore = path.str();
+
+    // A vertex per combinational operation, then the host
+    vector<int> vertexOf(count, -1);
+    vector<size_t> operationOf;
+    vector<uint8_t> delaying(count, 0); // Registers that retiming moves
+    double stayingDelay = 0; // Slowest register that stays
+    for (size_t index = 0; index < count; ++index)
+    {
+        Opcode opcode = ops.getOpcode(index);
+        if (opcode == Opcode::REG)
+        {
+            delaying[index] = onlyDelays(ops, index, symbols, useDefs);
+            result.movableRegisters += delaying[index];
+            stayingDelay = delaying[index] ? stayingDelay : max(stayingDelay, graph.getDelay(index));
+        }
+        else if (opcode != Opcode::NONE)
+        {
+            vertexOf[index] = (int)operationOf.size();
+            operationOf.push_back(index);
+        }
+    }
+    if (result.movableRegisters == 0)
+    {
+        return result;
+    }
+    int host = (int)operationOf.size();
+
+    // Follow a net back through the registers that only delay it, to the net they start from (-1 for a loop of registers alone)
+    vector<int> traceSource(symbolCount, -1);
+    vector<int> traceWeight(symbolCount, 0);
+    vector<int> passed;
+    vector<ChainName> names;
+    auto trace = [&](int net, int& weight)
+    {
+        passed.clear();
+        int at = net;
+        while (traceSource[at] < 0)
+        {
+            const variableInfo& info = symbols.getInfo(at);
+            int driver = graph.getDriver(at);
+            if (info.netType == INPUT || info.netType == OUTPUT || driver < 0 || !delaying[driver]) // The chain starts here
+            {
+                traceSource[at] = at;
+                break;
+            }
+            if (passed.size() > result.movableRegisters)
+            {
+                return -1;
+            }
+            passed.push_back(at);
+            at = ops.getOperands((size_t)driver)[1];
+        }
+
+        for (size_t i = passed.size(); i-- > 0; )
+        {
+            int previous = i + 1 < passed.size() ? passed[i + 1] : at;
+            traceSource[passed[i]] = traceSource[previous];
+            traceWeight[passed[i]] = traceWeight[previous] + 1;
+
+            const variableInfo& info = symbols.getInfo(passed[i]);
+            if (info.netType != WIRE || info.bitWidth == 1) // A wide wire that a select came to read would be declared with one bit
+            {
+                names.push_back(ChainName{traceSource[previous], traceWeight[passed[i]], passed[i]});
+            }
+        }
+        weight = traceWeight[net];
+        return traceSource[net];
+    };
+
+    // An edge per input of an operation, per input of a register that stays, and per output
+    vector<RetimeEdge> edges;
+    vector<RetimeEdge> literalReads; // Reads of an integer literal, which holds its value in every cycle, so no register goes in front of them
+    auto addEdge = [&](int to, int reader, int slot, int net, int registers)
+    {
+        int weight = 0;
+        int source = trace(net, weight);
+        if (source < 0)
+        {
+            return false;
+        }
+        if (symbols.getInfo(source).netType == CONSTANT)
+        {
+            literalReads.push_back(RetimeEdge{host, to, 0, registers, source, reader, slot, 0, 0});
+            return true;
+        }
+
+        const variableInfo& info = symbols.getInfo(source);
+        int driver = graph.getDriver(source);
+        bool port = info.netType == INPUT || info.netType == OUTPUT;
+        bool fromHost = port || driver < 0 || vertexOf[driver] < 0;
+        double launch = fromHost && !port && driver >= 0 ? graph.getDelay((size_t)driver) : 0;
+
+        int minimum = registers;
+        if (reader >= 0 && to < host && getPortRole(ops.getOpcode((size_t)reader), (size_t)slot) == PortRole::SELECT &&
+            info.netType == WIRE && info.bitWidth != 1 && emittedWidth(source, symbols, useDefs) != 1) // Reading the wire itself would make it a select, declared with one bit
+        {
+            minimum = 1;
+        }
+        edges.push_back(RetimeEdge{fromHost ? host : vertexOf[driver], to, weight + registers, minimum, source, reader, slot, launch,
+            componentDelay(Opcode::REG, emittedWidth(source, symbols, useDefs), info.signType == 's')});
+        return true;
+    };
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        OperandRange operands = ops.getOperands(index);
+        if (vertexOf[index] >= 0)
+        {
+            for (size_t slot = 1; slot < operands.size(); ++slot)
+            {
+                if (!addEdge(vertexOf[index], (int)index, (int)slot, operands[slot], 0))
+                {
+                    return result;
+                }
+            }
+        }
+        else if (ops.getOpcode(index) == Opcode::REG && !delaying[index] && !addEdge(host, (int)index, 1, operands[1], 0))
+        {
+            return result;
+        }
+    }
+    for (size_t id = 0; id < symbolCount; ++id)
+    {
+        int driver = graph.getDriver((int)id);
+        if (symbols.getInfo((int)id).netType != OUTPUT || driver < 0)
+        {
+            continue;
+        }
+        if (delaying[driver]) // The last register drives the output, so the chain ends one register early
+        {
+            if (!addEdge(host, -1, (int)id, ops.getOperands((size_t)driver)[1], 1))
+            {
+                return result;
+            }
+        }
+        else if (vertexOf[driver] >= 0) // Driven without a register, which is how it stays
+        {
+            edges.push_back(RetimeEdge{vertexOf[driver], host, 0, 0, (int)id, -1, (int)id, 0, 0});
+        }
+    }
+
+    // The edges into each vertex, and out of each vertex (including those into the host)
+    vector<uint32_t> inStart(host + 2, 0);
+    vector<uint32_t> outStart(host + 2, 0);
+    for (const RetimeEdge& edge : edges)
+    {
+        inStart[edge.to + 1]++;
+        outStart[edge.from + 1]++;
+    }
+    for (int v = 0; v <= host; ++v)
+    {
+        inStart[v + 1] += inStart[v];
+        outStart[v + 1] += outStart[v];
+    }
+    vector<uint32_t> inEdges(edges.size());
+    vector<uint32_t> outEdges(edges.size());
+    {
+        vector<uint32_t> inFill(inStart.begin(), inStart.end() - 1);
+        vector<uint32_t> outFill(outStart.begin(), outStart.end() - 1);
+        for (uint32_t e = 0; e < edges.size(); ++e)
+        {
+            inEdges[inFill[edges[e].to]++] = e;
+            outEdges[outFill[edges[e].from]++] = e;
+        }
+    }
+
+    auto retimed = [&](const RetimeEdge& edge, const vector<int>& lag) { return edge.weight + lag[edge.to] - lag[edge.from]; };
+
+    // When each vertex settles under a retiming, in topological order of the edges left without registers
+    vector<double> arrival(host, 0);
+    vector<uint32_t> pending(host, 0);
+    vector<int> order;
+    auto settle = [&](const vector<int>& lag)
+    {
+        fill(pending.begin(), pending.end(), 0);
+        for (const RetimeEdge& edge : edges)
+        {
+            if (edge.from < host && edge.to < host && retimed(edge, lag) == 0)
+            {
+                pending[edge.to]++;
+            }
+        }
+
+        order.clear();
+        for (int v = 0; v < host; ++v)
+        {
+            if (pending[v] == 0)
+            {
+                order.push_back(v);
+            }
+        }
+        for (size_t next = 0; next < order.size(); ++next)
+        {
+            int v = order[next];
+            double start = 0;
+            for (uint32_t i = inStart[v]; i < inStart[v + 1]; ++i)
+            {
+                const RetimeEdge& edge = edges[inEdges[i]];
+                double ready = retimed(edge, lag) > 0 ? edge.registerDelay : edge.from == host ? edge.launch : arrival[edge.from];
+                start = max(start, ready);
+            }
+            arrival[v] = start + graph.getDelay(operationOf[v]);
+
+            for (uint32_t i = outStart[v]; i < outStart[v + 1]; ++i)
+            {
+                const RetimeEdge& edge = edges[outEdges[i]];
+                if (edge.to < host && retimed(edge, lag) == 0 && --pending[edge.to] == 0)
+                {
+                    order.push_back(edge.to);
+                }
+            }
+        }
+        return order.size() == (size_t)host;
+    };
+
+    // FEAS: one more register in front of every vertex that settles too late, until none does
+    int lagLimit = (int)result.movableRegisters + 1; // More than any path to an output can give
+    auto feasible = [&](double period, vector<int>& lag)
+    {
+        lag.assign(host + 1, 0);
+        for (int round = 0; round <= host; ++round)
+        {
+            if (!settle(lag))
+            {
+                return false;
+            }
+
+            bool late = false;
+            for (int v = 0; v < host; ++v)
+            {
+                if (arrival[v] <= period)
+                {
+                    continue;
+                }
+                late = true;
+                if (++lag[v] > lagLimit)
+                {
+                    return false;
+                }
+                for (uint32_t i = outStart[v]; i < outStart[v + 1]; ++i)
+                {
+                    if (retimed(edges[outEdges[i]], lag) < edges[outEdges[i]].minimum)
+                    {
+                        return false;
+                    }
+                }
+            }
+            if (!late)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    double low = 0; // No period below the slowest operation is feasible
+    for (int v = 0; v < host; ++v)
+    {
+        low = max(low, graph.getDelay(operationOf[v]));
+    }
+    double high = before.criticalPath;
+    vector<int> best(host + 1, 0);
+    vector<int> lag;
+    while (high - low > PERIOD_RESOLUTION)
+    {
+        double period = (low + high) / 2;
+        if (feasible(period, lag))
+        {
+            high = period;
+            best.swap(lag);
+        }
+        else
+        {
+            low = period;
+        }
+    }
+
+    // Keep the registers where they are unless the retiming is faster, counting the registers themselves like analyzeTiming()
+    settle(best);
+    double period = stayingDelay;
+    for (int v = 0; v < host; ++v)
+    {
+        period = max(period, arrival[v]);
+    }
+    for (const RetimeEdge& edge : edges)
+    {
+        period = retimed(edge, best) > 0 ? max(period, edge.registerDelay) : period;
+    }
+    if (period >= before.criticalPath - PERIOD_RESOLUTION / 2)
+    {
+        return result;
+    }
+
+    // Rebuild the registers: one chain per net, as deep as its latest reader needs
+    vector<int> depth(symbolCount, 0);
+    for (const RetimeEdge& edge : edges)
+    {
+        int registers = retimed(edge, best) - (edge.reader < 0 ? 1 : 0);
+        depth[edge.source] = max(depth[edge.source], registers);
+    }
+
+    vector<int> registered;
+    for (size_t id = 0; id < symbolCount; ++id)
+    {
+        if (depth[id] > 0)
+        {
+            registered.push_back((int)id);
+        }
+    }
+    declareSelectsWithOneBit(ops, symbols, useDefs, registered);
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (delaying[index])
+        {
+            ops.setOpcode(index, Opcode::NONE);
+        }
+    }
+
+    sort(names.begin(), names.end(), [](const ChainName& a, const ChainName& b) { return a.source != b.source ? a.source < b.source : a.depth < b.depth; });
+    vector<int> chainStart(symbolCount, -1);
+    vector<int> chain;
+    size_t next = 0; // First name of the net being chained
+    for (int source : registered)
+    {
+        variableInfo info = symbols.getInfo(source); // A copy, since interning below may move the records
+        string name(symbols.getName(source));
+        int previous = source;
+
+        while (next < names.size() && names[next].source < source)
+        {
+            ++next;
+        }
+        chainStart[source] = (int)chain.size();
+        for (int k = 1; k <= depth[source]; ++k)
+        {
+            while (next < names.size() && names[next].source == source && names[next].depth < k)
+            {
+                ++next;
+            }
+
+            int reg;
+            if (next < names.size() && names[next].source == source && names[next].depth == k) // A register of the netlist at this depth
+            {
+                reg = names[next].name;
+            }
+            else
+            {
+                string suffix = "_r" + to_string(k);
+                size_t known = symbols.size();
+                reg = symbols.intern(name, suffix);
+                while (symbols.size() == known) // Taken by another net
+                {
+                    suffix += "_";
+                    reg = symbols.intern(name, suffix);
+                }
+
+                variableInfo& regInfo = symbols.getInfo(reg);
+                regInfo.netType = "reg";
+                regInfo.signType = info.signType;
+                regInfo.bitWidth = info.bitWidth;
+                result.registers.push_back(reg);
+            }
+
+            int operands[2] = { reg, previous };
+            ops.push(SetOp(Opcode::REG, operands, 2));
+            chain.push_back(reg);
+            previous = reg;
+        }
+    }
+    result.registersAfter = chain.size();
+
+    // Each reader takes the register at its depth, and each output gets its last register back
+    auto chainAt = [&](int source, int registers) { return registers == 0 ? source : chain[chainStart[source] + registers - 1]; };
+    for (const RetimeEdge& edge : edges)
+    {
+        int registers = retimed(edge, best);
+        if (edge.reader >= 0)
+        {
+            ops.setOperand((size_t)edge.reader, (size_t)edge.slot, chainAt(edge.source, registers));
+        }
+        else if (edge.minimum > 0)
+        {
+            int operands[2] = { edge.slot, chainAt(edge.source, registers - 1) };
+            ops.push(SetOp(Opcode::REG, operands, 2));
+            result.registersAfter++;
+        }
+    }
+    for (const RetimeEdge& read : literalReads) // The literal itself, or one register of it in front of an output
+    {
+        if (read.reader >= 0)
+        {
+            ops.setOperand((size_t)read.reader, (size_t)read.slot, read.source);
+        }
+        else
+        {
+            int operands[2] = { read.slot, read.source };
+            ops.push(SetOp(Opcode::REG, operands, 2));
+            result.registersAfter++;
+        }
+    }
+
+    DataflowGraph after;
+    after.build(ops, symbols);
+    result.periodAfter = after.analyzeTiming().criticalPath;
+    result.retimed = true;
+    return result;
+}
@@ -0,0 +1,54 @@
+#ifndef RETIME_H
+#define RETIME_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+class OpList;
+class SymbolTable;
+class UseDefIndex;
+
+// What retiming did to the registers of a netlist
+struct RetimeResult
+{
+    bool retimed = false; // False if no placement of the registers gives a shorter clock period
+    bool hasLoop = false; // A combinational loop leaves the clock period undefined
+    size_t movableRegisters = 0; // REG instances that only delay their net, which are the ones retiming moves
+    size_t registersAfter = 0; // REG instances that replaced them
+    double periodBefore = 0; // Critical path (ns)
+    double periodAfter = 0;
+    string pathBefore; // The critical path before retiming, as printTimingReport() prints it
+    vector<int> registers; // Nets of the new registers (symbol IDs), already in the symbol table as "reg" but not yet declared
+};
+
+/*
+    Leiserson–Saxe retiming for the minimum clock period. The graph has a vertex per combinational operation
+    and an edge per input, weighted with the registers the input goes through; one host vertex stands for the
+    inputs, the outputs, and the registers that change the width or sign of their net, which all stay where they are.
+    A retiming r moves r(v) registers from the outputs of v to its inputs, so an edge u -> v ends up with
+    w + r(v) - r(u) registers, never fewer than zero (and never fewer than one in front of an output, whose
+    last register drives it). Every cycle, and every path from an input to an output, keeps its registers,
+    so the module computes the same outputs in the same cycles. Integer literals hold their value in every cycle,
+    so they stay out of the graph and their readers keep reading them without registers.
+
+    The minimum period is found by binary search on the period with the FEAS test: starting from r = 0, every
+    vertex whose arrival exceeds the period gets one more register in front of it, and the period is feasible
+    once no arrival does. Each round is one topological pass over the edges without registers, so a test takes
+    linear time per round, and it gives up once a vertex would take more registers than its outputs can give.
+    Arrivals follow analyzeTiming(): a register output settles after the register delay of its width.
+
+    The registers of each net are then rebuilt as one chain that all of its readers share; a register at the
+    same depth as before keeps its name (e.g., "greg" still holds g one cycle late), and the others are named
+    after the net (e.g., "d_r1"). Registers reset to 0, so the first cycles after a reset may differ from
+    the netlist's
+*/
+RetimeResult retimeRegisters(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs);
+
+#endif
@@ -0,0 +1,532 @@
+#include "schedule.h"
+#include "dataflow.h"
+#include "pipeline.h" // Provides declareSelectsWithOneBit()
+
+#include <algorithm> // Provides sort() and max()
+#include <cctype> // Provides tolower()
+#include <functional> // Provides function
+#include <queue> // Provides priority_queue
+#include <string>
+#include <utility> // Provides pair
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+// Operations that can share a unit
+struct UnitKey
+{
+    Opcode opcode;
+    bool isSigned; // Uses the signed module
+    int width; // DATAWIDTH the operations need, or 0 when a unit of any width computes their low bits
+    int counter; // Instance counter (kind of unit)
+};
+
+// One functional unit and the operations bound to it, in step order
+struct Unit
+{
+    int key;
+    vector<int> operations;
+};
+
+static string lowercase(string_view text)
+{
+    string lower(text);
+    for (char& c : lower)
+    {
+        c = (char)tolower((unsigned char)c);
+    }
+    return lower;
+}
+
+bool parseUnitLimits(const string& spec, vector<int>& limits, string& error)
+{
+    limits.assign(COUNTER_COUNT, 0);
+    size_t start = 0;
+    while (start <= spec.size())
+    {
+        size_t comma = spec.find(',', start);
+        string item = spec.substr(start, comma == string::npos ? string::npos : comma - start);
+        start = comma == string::npos ? spec.size() + 1 : comma + 1;
+
+        size_t equals = item.find('=');
+        int counter = -1;
+        for (int code = 0; code < OPCODE_COUNT && equals != string::npos; ++code)
+        {
+            if ((Opcode)code != Opcode::REG && lowercase(OP_DESCRIPTORS[code].name) == lowercase(item.substr(0, equals)))
+            {
+                counter = OP_DESCRIPTORS[code].counter;
+            }
+        }
+        if (counter < 0)
+        {
+            error = "\"" + item + "\" does not name a kind of unit (add, sub, mul, comp, mux, shr, or shl) with a count";
+            return false;
+        }
+
+        string count = item.substr(equals + 1);
+        if (count.empty() || count.size() > 6 || count.find_first_not_of("0123456789") != string::npos || stoi(count) == 0)
+        {
+            error = "\"" + item + "\" needs a count of at least 1";
+            return false;
+        }
+        limits[counter] = stoi(count);
+    }
+    return true;
+}
+
+// Intern a new net named name + suffix, with more underscores while another net has the name
+static int internNew(SymbolTable& symbols, string_view name, string suffix, const char* netType, char signType, int bitWidth)
+{
+    size_t known = symbols.size();
+    int id = symbols.intern(name, suffix);
+    while (symbols.size() == known) // Taken by another net
+    {
+        suffix += "_";
+        id = symbols.intern(name, suffix);
+    }
+
+    variableInfo& info = symbols.getInfo(id);
+    info.netType = netType;
+    info.signType = signType;
+    info.bitWidth = bitWidth;
+    return id;
+}
+
+ScheduleResult scheduleOperations(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, const vector<int>& limits)
+{
+    ScheduleResult result;
+    size_t count = ops.size();
+
+    DataflowGraph graph; // Drivers of the nets
+    graph.build(ops, symbols);
+
+    auto isCombinational = [&](int operation) // An operation that a unit computes (wiring is an assign, which takes none)
+    {
+        return operation >= 0 && ops.getOpcode((size_t)operation) != Opcode::NONE && ops.getOpcode((size_t)operation) != Opcode::REG &&
+            !ops.isWiring((size_t)operation, symbols);
+    };
+    auto driverOf = [&](int symbol) // The driver of a net, seen through the wiring between them
+    {
+        int driver = graph.getDriver(symbol);
+        for (size_t hops = 0; driver >= 0 && ops.isWiring((size_t)driver, symbols) && hops < count; ++hops)
+        {
+            driver = graph.getDriver(ops.getOperands((size_t)driver)[1]);
+        }
+        return driver;
+    };
+
+    // An edge from each operation to every operation that reads its output, outputs included, since a result is only held after its step
+    vector<uint32_t> successorStart(count + 1, 0);
+    vector<int> successors;
+    vector<uint32_t> pending(count, 0); // Inputs of each operation whose drivers are not scheduled yet
+    vector<int> operations;
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (!isCombinational((int)index))
+        {
+            continue;
+        }
+        operations.push_back((int)index);
+        OperandRange operands = ops.getOperands(index);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            int driver = driverOf(operands[slot]);
+            if (isCombinational(driver))
+            {
+                successorStart[driver + 1]++;
+                pending[index]++;
+            }
+        }
+    }
+    if (operations.empty())
+    {
+        return result;
+    }
+    for (size_t index = 0; index < count; ++index)
+    {
+        successorStart[index + 1] += successorStart[index];
+    }
+    successors.resize(successorStart[count]);
+    vector<uint32_t> fill(successorStart.begin(), successorStart.end() - 1);
+    for (int operation : operations)
+    {
+        OperandRange operands = ops.getOperands((size_t)operation);
+        for (size_t slot = 1; slot < operands.size(); ++slot)
+        {
+            int driver = driverOf(operands[slot]);
+            if (isCombinational(driver))
+            {
+                successors[fill[driver]++] = operation;
+            }
+        }
+    }
+
+    // Dataflow order, then the longest chain of operations from each one to the end of the netlist cycle
+    vector<int> order;
+    vector<uint32_t> unplaced(pending);
+    for (int operation : operations)
+    {
+        if (unplaced[operation] == 0)
+        {
+            order.push_back(operation);
+        }
+    }
+    for (size_t next = 0; next < order.size(); ++next)
+    {
+        for (uint32_t e = successorStart[order[next]]; e < successorStart[order[next] + 1]; ++e)
+        {
+            if (--unplaced[successors[e]] == 0)
+            {
+                order.push_back(successors[e]);
+            }
+        }
+    }
+    if (order.size() != operations.size()) // Operations on a combinational loop never become ready
+    {
+        result.hasLoop = true;
+        return result;
+    }
+
+    vector<int> height(count, 0);
+    for (size_t i = order.size(); i-- > 0; )
+    {
+        int operation = order[i];
+        height[operation] = 1;
+        for (uint32_t e = successorStart[operation]; e < successorStart[operation + 1]; ++e)
+        {
+            height[operation] = max(height[operation], height[successors[e]] + 1);
+        }
+    }
+
+    // The kind of unit each operation needs
+    vector<UnitKey> keys;
+    vector<int> keyOf(count, -1);
+    vector<int> dataWidth(count, 0); // DATAWIDTH of each operation, before anything changes
+    for (int operation : operations)
+    {
+        Opcode opcode = ops.getOpcode((size_t)operation);
+        const OpDescriptor& desc = getDescriptor(opcode);
+        dataWidth[operation] = ops.getDataWidth((size_t)operation, symbols);
+
+        bool exactWidth = desc.widthRule == WidthRule::LARGEST_INPUT || opcode == Opcode::SHR || opcode == Opcode::SHL;
+        UnitKey key = { opcode, desc.signedModule != nullptr && isSigned(ops.getOperands((size_t)operation), symbols),
+            exactWidth ? dataWidth[operation] : 0, desc.counter };
+
+        size_t k = 0;
+        while (k < keys.size() && !(keys[k].opcode == key.opcode && keys[k].isSigned == key.isSigned && keys[k].width == key.width))
+        {
+            k++;
+        }
+        if (k == keys.size())
+        {
+            keys.push_back(key);
+        }
+        keyOf[operation] = (int)k;
+    }
+
+    // A kind may allocate a unit as long as one is left for every kind of operation that has none yet
+    vector<int> allowed(COUNTER_COUNT, 0); // The limit, raised to the kinds of unit its operations need
+    vector<int> allocated(COUNTER_COUNT, 0);
+    vector<int> missing(COUNTER_COUNT, 0); // Kinds of unit with operations but no unit yet
+    for (const UnitKey& key : keys)
+    {
+        missing[key.counter]++;
+    }
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+    {
+        int limit = counter < (int)limits.size() ? limits[counter] : 0;
+        allowed[counter] = limit == 0 ? 0 : max(limit, missing[counter]);
+    }
+
+    vector<Unit> units;
+    vector<vector<int>> unitsOfKey(keys.size());
+    vector<int> step(count, -1);
+
+    typedef pair<int, int> Priority; // Height, then the earlier operation
+    vector<priority_queue<pair<Priority, int>>> ready(keys.size());
+    vector<int> next; // Operations that become ready in the next step
+    for (int operation : operations)
+    {
+        if (pending[operation] == 0)
+        {
+            ready[keyOf[operation]].push(make_pair(make_pair(height[operation], -operation), operation));
+        }
+    }
+
+    size_t placed = 0;
+    vector<int> keyOrder(keys.size());
+    for (int current = 0; placed < operations.size(); ++current)
+    {
+        for (int operation : next)
+        {
+            ready[keyOf[operation]].push(make_pair(make_pair(height[operation], -operation), operation));
+        }
+        next.clear();
+
+        // The kinds whose most urgent operation is most urgent go first
+        for (size_t k = 0; k < keys.size(); ++k)
+        {
+            keyOrder[k] = (int)k;
+        }
+        sort(keyOrder.begin(), keyOrder.end(), [&](int a, int b)
+        {
+            if (ready[a].empty() || ready[b].empty())
+            {
+                return !ready[a].empty() && ready[b].empty();
+            }
+            return ready[a].top().first > ready[b].top().first;
+        });
+
+        size_t placedBefore = placed;
+        for (int k : keyOrder)
+        {
+            const UnitKey& key = keys[k];
+            size_t busy = 0;
+            while (!ready[k].empty())
+            {
+                bool unlimited = allowed[key.counter] == 0; // One unit per operation, since sharing would only add multiplexers
+                if (busy == unitsOfKey[k].size() || unlimited)
+                {
+                    int reserved = missing[key.counter] - (unitsOfKey[k].empty() ? 1 : 0); // Units kept for the other kinds
+                    if (!unlimited && allocated[key.counter] + 1 + reserved > allowed[key.counter])
+                    {
+                        break;
+                    }
+                    missing[key.counter] -= unitsOfKey[k].empty() ? 1 : 0;
+                    allocated[key.counter]++;
+                    unitsOfKey[k].push_back((int)units.size());
+                    units.push_back(Unit{k, {}});
+                    busy = unlimited ? unitsOfKey[k].size() - 1 : busy;
+                }
+
+                int operation = ready[k].top().second;
+                ready[k].pop();
+                step[operation] = current;
+                units[unitsOfKey[k][busy++]].operations.push_back(operation);
+                placed++;
+
+                for (uint32_t e = successorStart[operation]; e < successorStart[operation + 1]; ++e)
+                {
+                    if (--pending[successors[e]] == 0)
+                    {
+                        next.push_back(successors[e]);
+                    }
+                }
+            }
+        }
+
+        if (placed == placedBefore && next.empty()) // Nothing can ever be placed (the reservations make this unreachable)
+        {
+            return result;
+        }
+        result.steps = current + 1;
+    }
+
+    result.scheduled = true;
+    result.operations = operations.size();
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+    {
+        if (allocated[counter] == 0)
+        {
+            continue;
+        }
+        UnitUsage usage;
+        for (int code = 0; code < OPCODE_COUNT; ++code)
+        {
+            if (OP_DESCRIPTORS[code].counter == counter)
+            {
+                usage.kind = OP_DESCRIPTORS[code].module;
+                break;
+            }
+        }
+        usage.limit = counter < (int)limits.size() ? limits[counter] : 0;
+        usage.units = allocated[counter];
+        result.usage.push_back(usage);
+    }
+    for (const Unit& unit : units)
+    {
+        for (UnitUsage& usage : result.usage)
+        {
+            usage.operations += usage.kind == getDescriptor(keys[unit.key].opcode).module ? unit.operations.size() : 0;
+        }
+    }
+
+    /*
+        Rebuild the netlist around the units. Any wire that selects a MUX may become a data input of a MUX chain,
+        so it is declared with the one bit it had (which keeps the DATAWIDTH of every instance as it was)
+    */
+    vector<int> nets(symbols.size());
+    for (size_t id = 0; id < nets.size(); ++id)
+    {
+        nets[id] = (int)id;
+    }
+    declareSelectsWithOneBit(ops, symbols, useDefs, nets);
+
+    result.stateBits = 1;
+    while ((1 << result.stateBits) < result.steps)
+    {
+        result.stateBits++;
+    }
+    result.stateRegister = internNew(symbols, "State", "", "reg", 'u', result.stateBits);
+    result.stateDecodes.assign(result.steps, -1);
+    auto decode = [&](int state)
+    {
+        if (result.stateDecodes[state] < 0)
+        {
+            string stateName(symbols.getName(result.stateRegister));
+            result.stateDecodes[state] = internNew(symbols, stateName, to_string(state), WIRE, 'u', 1);
+            result.wires.push_back(result.stateDecodes[state]);
+        }
+        return result.stateDecodes[state];
+    };
+    result.stateThresholds.assign(result.steps, -1);
+    auto threshold = [&](int state)
+    {
+        if (result.stateThresholds[state] < 0)
+        {
+            string stateName(symbols.getName(result.stateRegister));
+            result.stateThresholds[state] = internNew(symbols, stateName, "_from" + to_string(state), WIRE, 'u', 1);
+            result.wires.push_back(result.stateThresholds[state]);
+        }
+        return result.stateThresholds[state];
+    };
+
+    auto pushMux = [&](int dest, int select, int chosen, int other)
+    {
+        int operands[4] = { dest, select, chosen, other };
+        ops.push(SetOp(Opcode::MUX, operands, 4));
+        result.multiplexers++;
+        return ops.size() - 1;
+    };
+
+    // The registers of the netlist load in the last step, from what their inputs hold by then
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (ops.getOpcode(index) != Opcode::REG)
+        {
+            continue;
+        }
+        OperandRange operands = ops.getOperands(index);
+        int width = ops.getDataWidth(index, symbols);
+        char signType = isSigned(operands, symbols) ? 's' : 'u'; // Keeps the module of the register
+        int dest = operands[0];
+        int source = operands[1];
+
+        string destName(symbols.getName(dest));
+        int input = internNew(symbols, destName, "_next", WIRE, signType, width);
+        result.wires.push_back(input);
+        pushMux(input, decode(result.steps - 1), source, dest);
+        ops.setOperand(index, 1, input);
+        ops.setDataWidth(index, width);
+    }
+
+    vector<int> unitNumbers(COUNTER_COUNT, 0);
+    for (const Unit& unit : units)
+    {
+        const UnitKey& key = keys[unit.key];
+        const OpDescriptor& desc = getDescriptor(key.opcode);
+        bool comparator = desc.widthRule == WidthRule::LARGEST_INPUT;
+        string name = lowercase(desc.name) + to_string(++unitNumbers[key.counter]);
+
+        int width = key.width;
+        for (int operation : unit.operations)
+        {
+            width = max(width, dataWidth[operation]);
+        }
+        char signType = key.isSigned ? 's' : 'u';
+        char resultSign = key.isSigned && !comparator ? 's' : 'u'; // A comparator output is one unsigned bit
+
+        // Each input takes the operand of the operation of the current step (and of the nearest one before it otherwise)
+        size_t operandCount = ops.getOperands((size_t)unit.operations[0]).size();
+        int unitOperands[MAX_OPERANDS];
+        for (size_t slot = 1; slot < operandCount; ++slot)
+        {
+            // A balanced tree rather than a chain, so a unit of many operations adds log2 of them MUX delays:
+            // the operations are in step order, and each MUX picks its upper half from the step that half starts
+            int inputWidth = getPortRole(key.opcode, slot) == PortRole::SELECT ? 1 : width;
+            string prefix = "_" + string(1, (char)('a' + slot - 1));
+            int count = 0;
+            function<int(size_t, size_t)> select = [&](size_t first, size_t last)
+            {
+                int operand = ops.getOperands((size_t)unit.operations[first])[slot];
+                bool same = true;
+                for (size_t i = first + 1; i <= last && same; ++i)
+                {
+                    same = ops.getOperands((size_t)unit.operations[i])[slot] == operand;
+                }
+                if (same)
+                {
+                    return operand;
+                }
+                size_t middle = (first + last + 1) / 2;
+                int upper = select(middle, last);
+                int lower = select(first, middle - 1);
+                int input = internNew(symbols, name, prefix + to_string(++count), WIRE, signType, inputWidth);
+                result.wires.push_back(input);
+                pushMux(input, threshold(step[unit.operations[middle]]), upper, lower);
+                return input;
+            };
+            unitOperands[slot] = select(0, unit.operations.size() - 1);
+        }
+
+        unitOperands[0] = internNew(symbols, name, "_out", WIRE, resultSign, comparator ? 1 : width);
+        result.wires.push_back(unitOperands[0]);
+        ops.push(SetOp(key.opcode, unitOperands, operandCount));
+        ops.setDataWidth(ops.size() - 1, width);
+
+        // The result is the unit output in its step, and the register that holds it afterwards
+        for (int operation : unit.operations)
+        {
+            int dest = ops.getOperands((size_t)operation)[0];
+            int destWidth = symbols.getInfo(dest).bitWidth;
+            string destName(symbols.getName(dest));
+            int held = internNew(symbols, destName, "_q", "reg", resultSign, destWidth);
+            result.registers.push_back(held);
+
+            size_t mux = pushMux(dest, decode(step[operation]), unitOperands[0], held);
+            ops.setDataWidth(mux, comparator ? 1 : min(dataWidth[operation], destWidth)); // Extended into the result as the operation extended it
+
+            int operands[2] = { held, dest };
+            ops.push(SetOp(Opcode::REG, operands, 2));
+            ops.setOpcode((size_t)operation, Opcode::NONE);
+        }
+    }
+
+    return result;
+}
+
+void printStateMachine(Emitter& file, const ScheduleResult& schedule, const SymbolTable& symbols)
+{
+    string_view state = symbols.getName(schedule.stateRegister);
+    string bits = to_string(schedule.stateBits) + "'d";
+
+    file.append("\n\treg [").appendInt(schedule.stateBits - 1).append(":0] ").append(state).append(";\n\n");
+    file.append("\talways @(posedge Clk) begin\n");
+    file.append("\t\tif (Rst == 1'b1 || ").append(state).append(" == ").append(bits).appendInt(schedule.steps - 1).append(")\n");
+    file.append("\t\t\t").append(state).append(" <= ").append(bits).append("0;\n");
+    file.append("\t\telse\n");
+    file.append("\t\t\t").append(state).append(" <= ").append(state).append(" + ").append(bits).append("1;\n");
+    file.append("\tend\n\n");
+
+    for (size_t step = 0; step < schedule.stateDecodes.size(); ++step)
+    {
+        if (schedule.stateDecodes[step] >= 0)
+        {
+            file.append("\tassign ").append(symbols.getName(schedule.stateDecodes[step])).append(" = ").append(state);
+            file.append(" == ").append(bits).appendInt((long long)step).append(";\n");
+        }
+    }
+    for (size_t step = 0; step < schedule.stateThresholds.size(); ++step)
+    {
+        if (schedule.stateThresholds[step] >= 0)
+        {
+            file.append("\tassign ").append(symbols.getName(schedule.stateThresholds[step])).append(" = ").append(state);
+            file.append(" >= ").append(bits).appendInt((long long)step).append(";\n");
+        }
+    }
+    return;
+}
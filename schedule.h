@@ -0,0 +1,71 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "emitter.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+class OpList;
+class SymbolTable;
+class UseDefIndex;
+
+// The functional units of one kind (e.g., MUL) after binding
+struct UnitUsage
+{
+    string kind; // Instance name prefix (e.g., "MUL")
+    int limit = 0; // Units allowed (0 for one per operation)
+    int units = 0; // Units bound, more than the limit only when its operations need more kinds of unit (e.g., signed and unsigned)
+    size_t operations = 0; // Operations bound to them, each busy for one step
+};
+
+// What scheduling and binding did to a netlist
+struct ScheduleResult
+{
+    bool scheduled = false; // False if a combinational loop leaves the steps undefined, or no operation computes anything
+    bool hasLoop = false;
+    int steps = 0; // States of the controller, which are the clock cycles of one netlist cycle
+    size_t operations = 0; // Operations scheduled
+    vector<UnitUsage> usage; // Per kind of unit, in instance counter order
+    size_t multiplexers = 0; // MUX instances added in front of the shared units and to hold results
+    vector<int> registers; // Nets of the registers that hold results (symbol IDs), already in the symbol table but not yet declared
+    vector<int> wires; // Nets of the unit inputs and outputs, the register inputs, and the state decodes, not yet declared
+    int stateRegister = -1; // Symbol of the state register of the controller
+    int stateBits = 0;
+    vector<int> stateDecodes; // Wire that is 1 in each state (-1 for a state no instance selects on)
+    vector<int> stateThresholds; // Wire that is 1 from each state on, for the MUX trees in front of the units (-1 if unused)
+};
+
+/*
+    Parse "mul=2,add=3" into a limit per instance counter (ADD, SUB, MUL, COMP, MUX, SHR, SHL); a kind that is
+    not named keeps one unit per operation. Return false with error set if a kind or a count is not valid
+*/
+bool parseUnitLimits(const string& spec, vector<int>& limits, string& error);
+
+/*
+    Resource-constrained list scheduling and binding. Every combinational operation takes one step (clock cycle);
+    steps are filled in dataflow order, the operations with the longest chain of operations after them first, and
+    an operation waits for a later step when every unit of its kind is busy. Operations share a unit if they have
+    the same module and sign (comparators and shifts also the same width, since their results depend on every bit
+    of their operands); a kind whose operations need more kinds of unit than its limit gets one unit of each.
+
+    The operations are replaced by their units: a balanced tree of MUX instances in front of each input of a shared
+    unit selects the operands of the operation of the current step, and a MUX and a register per result hold the value
+    for the later steps. The registers of the netlist load once, in the last step, so the module computes one
+    netlist cycle every steps clock cycles; the inputs have to be held for those cycles, and the outputs are
+    valid in the last one. The controller is a state counter that the module text ends with (printStateMachine())
+*/
+ScheduleResult scheduleOperations(OpList& ops, SymbolTable& symbols, const UseDefIndex& useDefs, const vector<int>& limits);
+
+// The state register, its counter, and the state decodes of the controller, e.g., "assign State0 = State == 3'd0;" and
+// "assign State_from4 = State >= 3'd4;"
+void printStateMachine(Emitter& file, const ScheduleResult& schedule, const SymbolTable& symbols);
+
+#endif
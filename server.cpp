@@ -0,0 +1,504 @@
+#include "server.h"
+#include "parser.h"
+#include "lexer.h"
+#include "threadpool.h"
+
+#include <cstdlib> // Provides strtoull()
+#include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
+#include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., cin and cout)
+#include <map>
+#include <mutex>
+
+#if !defined(_WIN32)
+#include <csignal> // Provides signal() for a clean shutdown
+#include <poll.h> // Provides poll(), which watches every connection from one thread
+#include <sys/socket.h> // Provides socket(), bind(), listen(), accept(), and connect()
+#include <sys/un.h> // Provides sockaddr_un
+#include <unistd.h> // Provides read(), write(), close(), pipe(), and unlink()
+#endif
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+#if !defined(_WIN32)
+
+static volatile sig_atomic_t stopRequested = 0; // Set by SIGINT or SIGTERM
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+// Buffered reader of the response lines a client receives
+class SocketReader
+{
+    private:
+        int fd; // Connected socket
+        string buffer; // Bytes received but not consumed yet
+        size_t pos; // Index of the first unconsumed byte in buffer
+
+        bool fill() // Receive more bytes, returning false at end of stream
+        {
+            if (this->pos > 0) // Drop the consumed bytes before growing the buffer
+            {
+                this->buffer.erase(0, this->pos);
+                this->pos = 0;
+            }
+
+            char chunk[65536];
+            ssize_t count = read(this->fd, chunk, sizeof(chunk));
+            if (count <= 0)
+            {
+                return false;
+            }
+
+            this->buffer.append(chunk, (size_t)count);
+            return true;
+        }
+
+    public:
+
+        // Parameterized Constructor
+        explicit SocketReader(int fd)
+        {
+            this->fd = fd;
+            this->pos = 0;
+        }
+
+        bool readLine(string& line) // Read up to the next newline (which is dropped)
+        {
+            while (true)
+            {
+                size_t end = this->buffer.find('\n', this->pos);
+                if (end != string::npos)
+                {
+                    line = this->buffer.substr(this->pos, end - this->pos);
+                    this->pos = end + 1;
+                    return true;
+                }
+                if (!this->fill())
+                {
+                    return false;
+                }
+            }
+        }
+};
+
+static bool writeAll(int fd, const string& text) // Send the whole string
+{
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+        ssize_t count = write(fd, text.data() + sent, text.size() - sent);
+        if (count <= 0)
+        {
+            return false;
+        }
+        sent += (size_t)count;
+    }
+    return true;
+}
+
+static vector<string> splitTabs(const string& line) // Split a header into its tab-separated fields
+{
+    vector<string> fields;
+    size_t start = 0;
+
+    while (true)
+    {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab - start));
+        if (tab == string::npos)
+        {
+            return fields;
+        }
+        start = tab + 1;
+    }
+}
+
+static bool fillAddress(const string& socketPath, sockaddr_un& address) // Build the address of the socket path
+{
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+
+    address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    socketPath.copy(address.sun_path, socketPath.size());
+    return true;
+}
+
+// One request taken off a connection
+struct ServerRequest
+{
+    vector<string> fields; // The tab-separated fields of the header
+    string netlistText; // The payload of a TEXT request
+};
+
+// A client connection, read by the I/O thread of the server
+struct ServerConnection
+{
+    string buffer; // Bytes received but not taken as a request yet
+    bool busy = false; // A worker is answering its last request, so the next one waits (the answers keep the order of the requests)
+    bool hungUp = false; // The client closed its end, so the connection is closed once its requests are answered
+};
+
+/*
+    Take the next complete request (the header, and the payload of TEXT) off the front of buffer. Return 1 if one was
+    taken, 0 if more bytes are needed, and -1 (with error set) if the rest of the stream cannot be framed
+*/
+static int takeRequest(string& buffer, ServerRequest& request, string& error)
+{
+    size_t end = buffer.find('\n');
+    if (end == string::npos)
+    {
+        return 0;
+    }
+
+    vector<string> fields = splitTabs(buffer.substr(0, end));
+    size_t payload = 0;
+    if (fields[0] == "TEXT" && (fields.size() == 3 || fields.size() == 4))
+    {
+        char* stop = nullptr;
+        unsigned long long byteCount = strtoull(fields[1].c_str(), &stop, 10);
+
+        if (fields[1].empty() || *stop != '\0') // Without a valid length the rest of the stream cannot be framed
+        {
+            error = "Invalid byte count: " + fields[1];
+            return -1;
+        }
+        if (buffer.size() - (end + 1) < byteCount)
+        {
+            return 0; // The netlist is still on its way
+        }
+        payload = (size_t)byteCount;
+        request.netlistText = buffer.substr(end + 1, payload);
+    }
+
+    request.fields = move(fields);
+    buffer.erase(0, end + 1 + payload);
+    return 1;
+}
+
+/*
+    Convert one FILE or TEXT request on a pool worker and send the answer. Each worker keeps one parser for every
+    request it serves, so the arena and the arrays of the previous netlist are reused rather than allocated again;
+    concurrent requests run on different workers, so they still share no state
+*/
+static void answerRequest(int fd, const ServerRequest& request, const ConvertOptions& options, ConversionStats& totals, mutex& totalsMutex)
+{
+    static thread_local NetParser netParser;
+    const vector<string>& fields = request.fields;
+    netParser.clear(); // Reset between requests (a failed request leaves nothing of the last netlist either)
+    netParser.setOptions(options);
+
+    bool success;
+    if (fields[0] == "FILE")
+    {
+        success = netParser.convertToVerilog(fields[1], fields[2], fields.size() == 4 ? fields[3] : "");
+    }
+    else
+    {
+        success = netParser.convertTextToVerilog(request.netlistText, fields[2], fields.size() == 4 ? fields[3] : "");
+    }
+
+    if (options.collectStats)
+    {
+        lock_guard<mutex> lock(totalsMutex);
+        totals.add(netParser.getStats());
+    }
+
+    writeAll(fd, success ? string("OK\n") : "FAIL\t" + netParser.getErrorMessage() + "\n"); // A client that hung up is noticed by the I/O thread
+    return;
+}
+
+int runServer(const string& socketPath, size_t threadCount, const ConvertOptions& options)
+{
+    sockaddr_un address;
+    if (!fillAddress(socketPath, address))
+    {
+        cerr << "Error: Socket path is too long: " << socketPath << endl;
+        return 1;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        cerr << "Error: Unable to create a socket" << endl;
+        return 1;
+    }
+
+    // A leftover socket file from a server that is no longer running is replaced, a live server is left alone
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(probe, (sockaddr*)&address, sizeof(address)) == 0)
+    {
+        close(probe);
+        close(listener);
+        cerr << "Error: A server is already listening on " << socketPath << endl;
+        return 1;
+    }
+    close(probe);
+    unlink(socketPath.c_str());
+
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 128) != 0)
+    {
+        close(listener);
+        cerr << "Error: Unable to listen on " << socketPath << endl;
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN); // A client that hangs up must not kill the server
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+
+    ConvertOptions connectionOptions = options;
+    if (connectionOptions.emitThreads == 0) // Requests are already served in parallel, so each formats its instances on one thread
+    {
+        connectionOptions.emitThreads = 1;
+    }
+
+    int wakeUp[2]; // A worker that answered a request writes a byte here, so the I/O thread polls that connection again
+    if (pipe(wakeUp) != 0)
+    {
+        close(listener);
+        unlink(socketPath.c_str());
+        cerr << "Error: Unable to create a pipe" << endl;
+        return 1;
+    }
+
+    ConversionStats totals; // Sum of the stats of every request (--stats)
+    mutex totalsMutex;
+    mutex answeredMutex; // Guards answered
+    vector<int> answered; // Connections whose request a worker answered since the I/O thread last looked
+    map<int, ServerConnection> connections; // By socket; only the I/O thread touches them
+    ThreadPool pool(threadCount); // Created once, so every request runs on a warm worker
+    cout << "dpgen serving on " << socketPath << " with " << pool.size() << " threads" << endl;
+
+    // Hand the complete requests of a connection to the pool, one at a time. Return false once the connection is to be closed
+    auto dispatch = [&](int fd, ServerConnection& connection)
+    {
+        while (!connection.busy)
+        {
+            ServerRequest request;
+            string error;
+            int taken = takeRequest(connection.buffer, request, error);
+            if (taken < 0)
+            {
+                writeAll(fd, "FAIL\t" + error + "\n");
+                return false;
+            }
+            if (taken == 0)
+            {
+                return !connection.hungUp;
+            }
+
+            const string& kind = request.fields[0];
+            if ((kind == "FILE" || kind == "TEXT") && (request.fields.size() == 3 || request.fields.size() == 4))
+            {
+                connection.busy = true;
+                pool.submit([fd, request, &connectionOptions, &totals, &totalsMutex, &answeredMutex, &answered, &wakeUp]
+                {
+                    answerRequest(fd, request, connectionOptions, totals, totalsMutex);
+                    lock_guard<mutex> lock(answeredMutex);
+                    answered.push_back(fd);
+                    if (answered.size() == 1) // Otherwise the I/O thread has a byte to wake up on already
+                    {
+                        char byte = 0;
+                        (void)!write(wakeUp[1], &byte, 1);
+                    }
+                });
+            }
+            else if (!writeAll(fd, kind == "PING" ? string("OK\n") : "FAIL\tUnknown request: " + kind + "\n")) // Answered here, without a worker
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto closeConnection = [&connections](int fd)
+    {
+        close(fd);
+        connections.erase(fd);
+    };
+
+    /*
+        The I/O thread: one poll over the listening socket, the wake-up pipe, and the connections that wait for a
+        request. A connection holds a worker only while a request of it is converted, so idle clients cannot starve
+        the others; a busy connection is not read until it is answered, which bounds what a client can queue
+    */
+    vector<pollfd> polled;
+    while (!stopRequested)
+    {
+        polled.clear();
+        polled.push_back(pollfd{ listener, POLLIN, 0 });
+        polled.push_back(pollfd{ wakeUp[0], POLLIN, 0 });
+        for (const auto& entry : connections)
+        {
+            if (!entry.second.busy)
+            {
+                polled.push_back(pollfd{ entry.first, POLLIN, 0 });
+            }
+        }
+
+        if (poll(polled.data(), polled.size(), 200) <= 0) // Wake up regularly to notice a shutdown request
+        {
+            continue;
+        }
+
+        if (polled[1].revents != 0) // Read the byte before taking the list, so an answer added after it writes a new one
+        {
+            char bytes[64];
+            (void)!read(wakeUp[0], bytes, sizeof(bytes));
+            vector<int> done;
+            {
+                lock_guard<mutex> lock(answeredMutex);
+                done.swap(answered);
+            }
+            for (int fd : done)
+            {
+                ServerConnection& connection = connections[fd];
+                connection.busy = false;
+                if (!dispatch(fd, connection))
+                {
+                    closeConnection(fd);
+                }
+            }
+        }
+
+        for (size_t index = 2; index < polled.size(); ++index)
+        {
+            if (polled[index].revents == 0)
+            {
+                continue;
+            }
+            int fd = polled[index].fd;
+            ServerConnection& connection = connections[fd];
+            char chunk[65536];
+            ssize_t count = read(fd, chunk, sizeof(chunk)); // poll() said it would not block
+            if (count > 0)
+            {
+                connection.buffer.append(chunk, (size_t)count);
+            }
+            else
+            {
+                connection.hungUp = true;
+            }
+            if (!dispatch(fd, connection))
+            {
+                closeConnection(fd);
+            }
+        }
+
+        if (polled[0].revents != 0)
+        {
+            int client = accept(listener, nullptr, nullptr);
+            if (client >= 0)
+            {
+                connections[client] = ServerConnection();
+            }
+        }
+    }
+
+    close(listener);
+    pool.wait(); // Finish the requests in flight
+    for (const auto& entry : connections)
+    {
+        close(entry.first);
+    }
+    close(wakeUp[0]);
+    close(wakeUp[1]);
+    unlink(socketPath.c_str());
+
+    if (options.collectStats)
+    {
+        printStats(cout, totals);
+    }
+
+    return 0;
+}
+
+int runClient(const string& socketPath, const string& netlistFile, const string& verilogFile, bool sendText)
+{
+    sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (!fillAddress(socketPath, address) || fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        cerr << "Error: No dpgen server is listening on " << socketPath << endl;
+        return 1;
+    }
+
+    // The server does not share our working directory, so send absolute paths, and name the module after the path as typed (like dpgen does)
+    string outputPath = filesystem::absolute(verilogFile).string();
+    string request;
+
+    if (sendText) // Send the netlist itself, for servers that cannot see our files
+    {
+        MappedFile netlist(netlistFile);
+        if (!netlist.isOpen())
+        {
+            close(fd);
+            cerr << "Error: Unable to open the text file of " << netlistFile << endl;
+            return 1;
+        }
+        request = "TEXT\t" + to_string(netlist.text().size()) + "\t" + outputPath + "\t" + verilogFile + "\n";
+        request.append(netlist.text());
+    }
+    else
+    {
+        request = "FILE\t" + filesystem::absolute(netlistFile).string() + "\t" + outputPath + "\t" + verilogFile + "\n";
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    SocketReader reader(fd);
+    string response;
+
+    if (!writeAll(fd, request) || !reader.readLine(response))
+    {
+        close(fd);
+        cerr << "Error: The dpgen server closed the connection" << endl;
+        return 1;
+    }
+    close(fd);
+
+    vector<string> fields = splitTabs(response);
+
+    if (fields[0] == "OK")
+    {
+        cout << "Verilog file successfully created" << endl;
+        return 0;
+    }
+
+    if (fields.size() > 1 && !fields[1].empty())
+    {
+        cout << "ERROR FOUND: " << fields[1] << endl;
+    }
+    cout << "Verilog file failed to be created due to incomplete Behavioral Netlist" << endl;
+    return 1;
+}
+
+#else
+
+int runServer(const string& socketPath, size_t threadCount, const ConvertOptions& options)
+{
+    cerr << "Error: --serve needs Unix domain sockets, which this platform does not provide" << endl;
+    return 1;
+}
+
+int runClient(const string& socketPath, const string& netlistFile, const string& verilogFile, bool sendText)
+{
+    cerr << "Error: --client needs Unix domain sockets, which this platform does not provide" << endl;
+    return 1;
+}
+
+#endif
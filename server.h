@@ -0,0 +1,33 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "parser.h"
+
+#include <string>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    Requests and responses on the socket are text headers terminated by a newline:
+
+        FILE <tab> netlistFile <tab> verilogFile [<tab> moduleName]    Convert a netlist file (paths as seen by the server)
+        TEXT <tab> byteCount <tab> verilogFile [<tab> moduleName]      Convert the byteCount bytes of netlist text that follow the header
+        PING                                                           Check that the server is alive
+
+    The module is named after verilogFile unless moduleName is given.
+    Each request is answered with "OK" or "FAIL <tab> message". A connection may send any number of requests, which are
+    answered in order. One thread reads every connection and hands each conversion to a worker of the pool, so a
+    connection holds a worker only while one of its requests is converted (PING is answered without one)
+*/
+
+// Serve conversion requests on a Unix domain socket until SIGINT or SIGTERM (zero threads means one per core)
+int runServer(const string& socketPath, size_t threadCount, const ConvertOptions& options);
+
+// Send one conversion to a running server and print the result like the single-file command line
+int runClient(const string& socketPath, const string& netlistFile, const string& verilogFile, bool sendText);
+
+#endif
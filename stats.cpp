@@ -0,0 +1,277 @@
+#include "stats.h"
+#include "emitter.h"
+
+#include <atomic>
+#include <cstdio> // Provides snprintf()
+#include <mutex>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const char* const PHASE_NAMES[PHASE_COUNT] = { "read", "declarations", "operations", "synthesis", "optimize", "emit", "write" };
+
+/*
+
+    Heap allocation counters
+
+*/
+
+// Per-thread, so concurrent batch conversions each see only their own allocations
+static thread_local size_t threadAllocations = 0;
+static thread_local size_t threadAllocatedBytes = 0;
+
+void countAllocation(size_t bytes)
+{
+    threadAllocations++;
+    threadAllocatedBytes += bytes;
+}
+
+/*
+
+    Conversion statistics
+
+*/
+
+static thread_local ConversionStats* currentStats = nullptr;
+
+ConversionStats* activeStats()
+{
+    return currentStats;
+}
+
+StatsScope::StatsScope(ConversionStats* stats)
+{
+    this->previous = currentStats;
+    this->outermost = stats != nullptr && currentStats == nullptr;
+    this->allocations = threadAllocations;
+    this->allocatedBytes = threadAllocatedBytes;
+
+    if (this->outermost)
+    {
+        currentStats = stats;
+    }
+}
+
+StatsScope::~StatsScope()
+{
+    if (this->outermost)
+    {
+        currentStats->allocations += threadAllocations - this->allocations;
+        currentStats->allocatedBytes += threadAllocatedBytes - this->allocatedBytes;
+        currentStats->conversions += 1;
+        currentStats = this->previous;
+    }
+}
+
+void ConversionStats::add(const ConversionStats& other)
+{
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        this->seconds[i] += other.seconds[i];
+    }
+    this->lines += other.lines;
+    this->declarations += other.declarations;
+    this->operations += other.operations;
+    this->signals += other.signals;
+    this->synthesizedNets += other.synthesizedNets;
+    this->removedInstances += other.removedInstances;
+    this->narrowedInstances += other.narrowedInstances;
+    this->savedBits += other.savedBits;
+    this->narrowedNets += other.narrowedNets;
+    this->pipelineRegisters += other.pipelineRegisters;
+    this->allocations += other.allocations;
+    this->allocatedBytes += other.allocatedBytes;
+    this->outputBytes += other.outputBytes;
+    this->cacheHits += other.cacheHits;
+    this->conversions += other.conversions;
+    return;
+}
+
+void printStats(ostream& out, const ConversionStats& stats)
+{
+    char text[128];
+    double total = 0;
+
+    out << "Conversion statistics";
+    if (stats.conversions > 1)
+    {
+        out << " (" << stats.conversions << " conversions)";
+    }
+    out << ":" << "\n";
+
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        snprintf(text, sizeof(text), "\t%-14s%12.3f ms\n", PHASE_NAMES[i], stats.seconds[i] * 1000.0);
+        out << text;
+        total += stats.seconds[i];
+    }
+    snprintf(text, sizeof(text), "\t%-14s%12.3f ms\n", "total", total * 1000.0);
+    out << text;
+
+    out << "\t" << "lines          " << stats.lines << "\n";
+    out << "\t" << "declarations   " << stats.declarations << "\n";
+    out << "\t" << "operations     " << stats.operations << "\n";
+    out << "\t" << "signals        " << stats.signals << "\n";
+    out << "\t" << "synthesized    " << stats.synthesizedNets << " wire/register pairs" << "\n";
+    out << "\t" << "removed        " << stats.removedInstances << " instances" << "\n";
+    out << "\t" << "pipelined      " << stats.pipelineRegisters << " registers" << "\n";
+    out << "\t" << "narrowed       " << stats.narrowedInstances << " instances (" << stats.savedBits << " bits), " << stats.narrowedNets << " nets" << "\n";
+#if DPGEN_INSTRUMENTATION
+    out << "\t" << "allocations    " << stats.allocations << " (" << stats.allocatedBytes << " bytes)" << "\n";
+#else
+    out << "\t" << "allocations    not counted (built without DPGEN_INSTRUMENTATION)" << "\n";
+#endif
+    out << "\t" << "output         " << stats.outputBytes << " bytes" << "\n";
+    if (stats.cacheHits != 0)
+    {
+        out << "\t" << "cache hits     " << stats.cacheHits << "\n";
+    }
+    out.flush();
+    return;
+}
+
+/*
+
+    Chrome trace events
+
+*/
+
+// A recorded "X" (complete) event
+struct TraceEvent
+{
+    const char* name;
+    string detail;
+    int thread; // Small per-thread number used as the tid
+    double startMicros; // Relative to startTrace()
+    double durationMicros;
+};
+
+static atomic<bool> traceEnabled(false);
+static mutex traceMutex; // Guards everything below
+static string traceFileName;
+static chrono::steady_clock::time_point traceEpoch;
+static vector<TraceEvent> traceEvents;
+
+static int traceThread() // 1, 2, 3, ... in the order threads first record an event
+{
+    static atomic<int> nextThread(1);
+    static thread_local int thread = nextThread.fetch_add(1);
+    return thread;
+}
+
+void startTrace(const string& traceFile)
+{
+    lock_guard<mutex> lock(traceMutex);
+    traceFileName = traceFile;
+    traceEpoch = chrono::steady_clock::now();
+    traceEvents.clear();
+    traceEnabled.store(true);
+    return;
+}
+
+bool tracing()
+{
+    return traceEnabled.load(memory_order_relaxed);
+}
+
+void TraceSpan::restart(const char* name, string_view detail)
+{
+    this->end();
+
+    if (tracing())
+    {
+        this->name = name;
+        this->detail.assign(detail.data(), detail.size());
+        this->start = chrono::steady_clock::now();
+    }
+    return;
+}
+
+void TraceSpan::end()
+{
+    if (this->name == nullptr)
+    {
+        return;
+    }
+
+    auto finish = chrono::steady_clock::now();
+    int thread = traceThread();
+
+    lock_guard<mutex> lock(traceMutex);
+    if (traceEnabled.load())
+    {
+        traceEvents.push_back(TraceEvent{this->name, move(this->detail), thread,
+            chrono::duration<double, micro>(this->start - traceEpoch).count(),
+            chrono::duration<double, micro>(finish - this->start).count()});
+    }
+    this->name = nullptr;
+    return;
+}
+
+static void appendJsonString(Emitter& out, string_view text) // Quote a string for JSON
+{
+    out.append('"');
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out.append('\\').append(c);
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            out.append(' ');
+        }
+        else
+        {
+            out.append(c);
+        }
+    }
+    out.append('"');
+    return;
+}
+
+bool finishTrace(string& error)
+{
+    lock_guard<mutex> lock(traceMutex);
+
+    if (!traceEnabled.load())
+    {
+        return true;
+    }
+    traceEnabled.store(false);
+
+    Emitter json;
+    char number[64];
+
+    json.append("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (size_t i = 0; i < traceEvents.size(); ++i)
+    {
+        const TraceEvent& event = traceEvents[i];
+
+        json.append("{\"name\": ");
+        appendJsonString(json, event.name);
+        json.append(", \"cat\": \"dpgen\", \"ph\": \"X\", \"pid\": 1, \"tid\": ").appendInt(event.thread);
+        snprintf(number, sizeof(number), ", \"ts\": %.3f, \"dur\": %.3f", event.startMicros, event.durationMicros);
+        json.append(number);
+        if (!event.detail.empty())
+        {
+            json.append(", \"args\": {\"detail\": ");
+            appendJsonString(json, event.detail);
+            json.append('}');
+        }
+        json.append(i + 1 < traceEvents.size() ? "},\n" : "}\n");
+    }
+    json.append("]}\n");
+    traceEvents.clear();
+
+    if (!writeWholeFile(traceFileName, json.text()))
+    {
+        error = "Unable to write the trace file " + traceFileName;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,192 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    Instrumentation of the conversion phases. With DPGEN_INSTRUMENTATION set to 0 (cmake -DDPGEN_INSTRUMENTATION=OFF)
+    the DPGEN_* macros below expand to nothing and the allocation counters are not installed
+*/
+#ifndef DPGEN_INSTRUMENTATION
+#define DPGEN_INSTRUMENTATION 1
+#endif
+
+// Phases of a conversion whose wall time is accumulated by --stats
+enum class Phase : uint8_t
+{
+    READ, // Opening and mapping the netlist file
+    DECLARATIONS, // Parsing input, output, wire, and register lines
+    OPERATIONS, // Parsing operation lines (without the synthesis below)
+    SYNTHESIS, // The wires and registers created in front of outputs (checkOutput and createRegister)
+    OPTIMIZE, // The optimization passes (e.g., --cse, --min-width, --clock-period)
+    EMIT, // Generating the Verilog module
+    WRITE // Writing the Verilog file (or reusing a cache entry)
+};
+
+const int PHASE_COUNT = 7;
+extern const char* const PHASE_NAMES[PHASE_COUNT]; // Indexed by Phase
+
+// What --stats reports for a conversion (or the sum over a batch)
+struct ConversionStats
+{
+    double seconds[PHASE_COUNT] = {}; // Wall time of each phase
+    size_t lines = 0; // Non-blank netlist lines
+    size_t declarations = 0; // Declaration lines
+    size_t operations = 0; // Operation lines
+    size_t signals = 0; // Names in the symbol table
+    size_t synthesizedNets = 0; // Wire/register pairs created in front of outputs
+    size_t removedInstances = 0; // Instances removed by the optimization passes
+    size_t narrowedInstances = 0; // Instances given a smaller DATAWIDTH by the optimization passes
+    size_t savedBits = 0; // DATAWIDTH bits those instances no longer have
+    size_t pipelineRegisters = 0; // Registers inserted to meet the clock period
+    size_t narrowedNets = 0; // Wires and registers declared with fewer bits by the optimization passes
+    size_t allocations = 0; // Heap allocations made during the conversion
+    size_t allocatedBytes = 0; // Bytes requested by those allocations
+    size_t outputBytes = 0; // Size of the generated Verilog
+    size_t cacheHits = 0; // Conversions answered by the conversion cache
+    size_t conversions = 0; // Number of conversions summed into these stats
+
+    void add(const ConversionStats& other); // Sum another conversion into these stats
+};
+
+void printStats(ostream& out, const ConversionStats& stats); // Human-readable report for --stats
+
+ConversionStats* activeStats(); // Stats of the conversion running on this thread, or nullptr when --stats is off
+
+/*
+    Count a heap allocation of the calling thread. The library never replaces the global operator new of the program
+    that links it; the dpgen executable does (heapcount.cpp) and calls this, while other programs count no allocations
+*/
+void countAllocation(size_t bytes);
+
+/*
+    Make stats the target of this thread's instrumentation for the lifetime of the scope and count the heap
+    allocations made meanwhile. Nested scopes on the same thread leave the outer one in charge
+*/
+class StatsScope
+{
+    private:
+        ConversionStats* previous; // Target before this scope (restored by the destructor)
+        bool outermost; // Whether this scope installed the target
+        size_t allocations; // Allocation counters of the thread when the scope started
+        size_t allocatedBytes;
+
+    public:
+
+        // Parameterized Constructor (nullptr leaves the stats off)
+        explicit StatsScope(ConversionStats* stats);
+
+        // Destructor
+        ~StatsScope();
+
+        StatsScope(const StatsScope&) = delete;
+        StatsScope& operator=(const StatsScope&) = delete;
+};
+
+// Adds the lifetime of the scope to a phase of the active stats
+class PhaseTimer
+{
+    private:
+        ConversionStats* stats; // Active stats when the timer started (nullptr when off)
+        Phase phase;
+        chrono::steady_clock::time_point start;
+
+    public:
+
+        // Parameterized Constructor
+        explicit PhaseTimer(Phase phase)
+        {
+            this->stats = activeStats();
+            this->phase = phase;
+            if (this->stats != nullptr)
+            {
+                this->start = chrono::steady_clock::now();
+            }
+        }
+
+        // Destructor
+        ~PhaseTimer()
+        {
+            this->stop();
+        }
+
+        void stop() // End the phase before the end of the scope
+        {
+            if (this->stats != nullptr)
+            {
+                this->stats->seconds[(int)this->phase] += chrono::duration<double>(chrono::steady_clock::now() - this->start).count();
+                this->stats = nullptr;
+            }
+        }
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+/*
+    Chrome trace-event recording (load the file in chrome://tracing or Perfetto). Spans are recorded only
+    between startTrace() and finishTrace(), from any thread
+*/
+void startTrace(const string& traceFile);
+bool finishTrace(string& error); // Write the recorded spans; true when no trace was started
+bool tracing();
+
+// A complete ("X") trace event covering the lifetime of the span, or from restart() to the next restart()/end()
+class TraceSpan
+{
+    private:
+        const char* name; // Event name (a string literal), nullptr when not recording
+        string detail; // Shown as args.detail in the trace viewer
+        chrono::steady_clock::time_point start;
+
+    public:
+
+        // Parameterized Constructor
+        explicit TraceSpan(const char* name, string_view detail = "")
+        {
+            this->name = nullptr;
+            this->restart(name, detail);
+        }
+
+        // Destructor
+        ~TraceSpan()
+        {
+            this->end();
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+        void restart(const char* name, string_view detail = ""); // End the current event and begin another
+        void end();
+};
+
+#if DPGEN_INSTRUMENTATION
+#define DPGEN_STATS_SCOPE(var, stats) StatsScope var(stats)
+#define DPGEN_PHASE(var, phase) PhaseTimer var(phase)
+#define DPGEN_PHASE_END(var) var.stop()
+#define DPGEN_SPAN(var, ...) TraceSpan var(__VA_ARGS__)
+#define DPGEN_SPAN_RESTART(var, ...) var.restart(__VA_ARGS__)
+#define DPGEN_SPAN_END(var) var.end()
+#define DPGEN_COUNT(field, amount) do { if (ConversionStats* dpgenStats = activeStats()) { dpgenStats->field += (amount); } } while (0)
+#else
+#define DPGEN_STATS_SCOPE(var, stats)
+#define DPGEN_PHASE(var, phase)
+#define DPGEN_PHASE_END(var)
+#define DPGEN_SPAN(var, ...)
+#define DPGEN_SPAN_RESTART(var, ...)
+#define DPGEN_SPAN_END(var)
+#define DPGEN_COUNT(field, amount) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+#include "parser.h"
+#include "cache.h"
+#include "dpir.h"
+
+#include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
+#include <fstream> // Provides functionality for working with files in C++ (e.g., ifstream, ofstream, and fstream)
+#include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., cin and cout)
+#include <sstream> // Provides stringstream, which reads a whole file into a string
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+namespace fs = filesystem;
+
+/*
+    Checks of libdpgen as another program links it: dpgen_api_test testsDir circuitsDir workDir
+    The Verilog of convertText must match the expected files of the dpgen conversions (tests/expected), whether the
+    parser is fresh, reused across netlists, or answered from the cache
+*/
+
+static const char* NETLISTS[] = {"474a_circuit1", "474a_circuit2", "474a_circuit3", "474a_circuit4", "mixedcircuit1", "mixedcircuit2",
+                                 "mixedcircuit3", "ucircuit1", "ucircuit2", "ucircuit3"};
+
+static int failures = 0; // Checks that failed so far
+
+static void check(bool condition, const string& what) // Report a failed check and carry on with the others
+{
+    if (!condition)
+    {
+        cout << "FAILED: " << what << endl;
+        failures++;
+    }
+    return;
+}
+
+static string readFile(const fs::path& path) // Whole file, or empty if it cannot be read
+{
+    ifstream file(path, ios::binary);
+    stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 4)
+    {
+        cout << "Usage: dpgen_api_test testsDir circuitsDir workDir" << endl;
+        return 1;
+    }
+    fs::path expected = fs::path(argv[1]) / "expected";
+    fs::path circuits = argv[2];
+    fs::path work = argv[3];
+    fs::remove_all(work);
+    fs::create_directories(work);
+
+    // A parser reused for every netlist converts each as a fresh one does (the server keeps one per worker)
+    NetParser reused;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (const char* name : NETLISTS)
+        {
+            string netlist = readFile(circuits / (string(name) + ".txt"));
+            string moduleName = string(name) + ".v";
+            string verilog;
+            check(reused.convertText(netlist, moduleName, verilog), string(name) + ": the reused parser fails: " + reused.getErrorMessage());
+            check(verilog == readFile(expected / moduleName), string(name) + ": the reused parser differs from the expected Verilog");
+
+            NetParser fresh;
+            string freshVerilog;
+            check(fresh.convertText(netlist, moduleName, freshVerilog), string(name) + ": a fresh parser fails: " + fresh.getErrorMessage());
+            check(freshVerilog == verilog, string(name) + ": a fresh parser differs from the reused one");
+        }
+    }
+
+    // A cache hit gives the same Verilog and leaves the parser empty rather than holding the previous netlist
+    ConvertOptions cached;
+    cached.cacheDir = (work / "cache").string();
+    NetParser netParser;
+    netParser.setOptions(cached);
+    string first = readFile(circuits / "474a_circuit2.txt");
+    string second = readFile(circuits / "474a_circuit3.txt");
+    string missVerilog;
+    string hitVerilog;
+    check(netParser.convertText(first, "474a_circuit2.v", missVerilog), "cache miss fails: " + netParser.getErrorMessage());
+    check(netParser.convertText(second, "474a_circuit3.v", missVerilog), "cache miss fails: " + netParser.getErrorMessage());
+    check(!netParser.getOperations().empty(), "a cache miss leaves no operations to inspect");
+    check(netParser.convertText(first, "474a_circuit2.v", hitVerilog), "cache hit fails: " + netParser.getErrorMessage());
+    check(hitVerilog == readFile(expected / "474a_circuit2.v"), "a cache hit differs from the expected Verilog");
+    check(netParser.getOperations().empty() && netParser.getSymbols().size() == 0, "a cache hit leaves the operations of the previous netlist");
+
+    // The key of netlist text ignores blank lines, but every byte of a precompiled image (.dpir) is data
+    ConversionCache keys(cached.cacheDir);
+    NetParser compiler;
+    check(compiler.parseText(first), "474a_circuit2 does not parse: " + compiler.getErrorMessage());
+    string image = NetlistImage::save(compiler);
+    check(keys.makeKey(first, "m", "") == keys.makeKey(first + "\n\n", "m", ""), "blank lines change the cache key of a netlist");
+    check(keys.makeKey(image, "m", "") != keys.makeKey(image + "\n", "m", ""), "an image and the same image with one more byte share a cache key");
+
+    // Only the dpgen executable replaces operator new, so a program that links the library counts no allocations
+    ConvertOptions withStats;
+    withStats.collectStats = true;
+    NetParser counted;
+    counted.setOptions(withStats);
+    string verilog;
+    check(counted.convertText(first, "474a_circuit2.v", verilog), "conversion with stats fails: " + counted.getErrorMessage());
+    check(counted.getStats().allocations == 0, "libdpgen counts the allocations of the program that links it");
+
+    if (failures > 0)
+    {
+        cout << failures << (failures == 1 ? " check failed" : " checks failed") << endl;
+        return 1;
+    }
+    cout << "All checks passed" << endl;
+    return 0;
+}
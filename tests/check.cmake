@@ -0,0 +1,77 @@
+# Runs dpgen on one netlist and compares what it prints, and the Verilog it writes, with the
+# expected files of the test (cmake -P check.cmake, as tests/CMakeLists.txt calls it).
+#
+#	DPGEN    : The dpgen executable
+#	NAME     : Name of the test, which names its expected files (expected/NAME.out and expected/NAME.v)
+#	       and the Verilog file (NAME.v, so the module is named NAME.v as well)
+#	NETLIST  : The netlist, copied into the work directory so messages name it without a path
+#	ARGS     : Options given before the netlist
+#	STATUS   : Exit status that dpgen must return (default: 0)
+#	RUNS     : Times to convert in the same work directory, so later --cache=dir runs find the cache filled (default: 1)
+#	EXPECTED : Directory of the expected files
+#	WORK_DIR : Scratch directory of the test, emptied first
+#
+# The output of the runs, one after the other, is compared with expected/NAME.out (with the times and
+# allocation counts of --stats masked), and the Verilog with expected/NAME.v when the test has one.
+# With the environment variable DPGEN_UPDATE_EXPECTED set, the expected files are written instead
+# (after a change that is meant to alter them; review the diff before committing it).
+
+if(NOT DEFINED STATUS)
+	set(STATUS 0)
+endif()
+if(NOT DEFINED RUNS)
+	set(RUNS 1)
+endif()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+get_filename_component(netlistName "${NETLIST}" NAME)
+configure_file("${NETLIST}" "${WORK_DIR}/${netlistName}" COPYONLY)
+
+set(expectedOutput "${EXPECTED}/${NAME}.out")
+set(expectedVerilog "${EXPECTED}/${NAME}.v")
+set(verilog "${WORK_DIR}/${NAME}.v")
+set(outputs "")
+
+foreach(run RANGE 1 ${RUNS})
+	file(REMOVE "${verilog}") # So the Verilog compared is the one the last run wrote, even from the cache
+	execute_process(COMMAND "${DPGEN}" ${ARGS} "${netlistName}" "${NAME}.v"
+		WORKING_DIRECTORY "${WORK_DIR}"
+		RESULT_VARIABLE status
+		OUTPUT_VARIABLE output
+		ERROR_VARIABLE output
+		TIMEOUT 60)
+
+	# Phase times and heap allocations (--stats) vary from run to run, so only the rest is compared
+	string(REGEX REPLACE "[0-9]+\\.[0-9]+ ms" "<time> ms" output "${output}")
+	string(REGEX REPLACE "allocations    [0-9]+ \\([0-9]+ bytes\\)" "allocations    <count>" output "${output}")
+
+	if(NOT "${status}" STREQUAL "${STATUS}" AND NOT DEFINED ENV{DPGEN_UPDATE_EXPECTED})
+		message(FATAL_ERROR "Run ${run}: dpgen ${ARGS} ${netlistName} ${NAME}.v exited with ${status} instead of ${STATUS}:\n${output}")
+	endif()
+	string(APPEND outputs "${output}")
+endforeach()
+
+if(DEFINED ENV{DPGEN_UPDATE_EXPECTED})
+	file(WRITE "${expectedOutput}" "${outputs}")
+	if(EXISTS "${verilog}" AND STATUS EQUAL 0)
+		configure_file("${verilog}" "${expectedVerilog}" COPYONLY)
+	endif()
+	message(STATUS "Wrote the expected files of ${NAME}")
+	return()
+endif()
+
+file(READ "${expectedOutput}" expected)
+if(NOT outputs STREQUAL expected)
+	message(FATAL_ERROR "Output differs from ${expectedOutput}:\n${outputs}")
+endif()
+
+if(EXISTS "${expectedVerilog}")
+	if(NOT EXISTS "${verilog}")
+		message(FATAL_ERROR "No Verilog was written to ${verilog}")
+	endif()
+	execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${verilog}" "${expectedVerilog}" RESULT_VARIABLE different)
+	if(different)
+		message(FATAL_ERROR "${verilog} differs from ${expectedVerilog}")
+	endif()
+endif()
@@ -0,0 +1,24 @@
+`timescale 1ns / 1ps
+
+module 474a_circuit2.v (
+	input Clk, Rst,
+	input [31:0] a, b, c,
+	output [31:0] z, x
+);
+	wire [31:0] d, e, f, g, h;
+	wire dLTe, dEQe;
+	wire [31:0] zwire, xwire;
+
+	SADD #(.DATAWIDTH(32)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(32)) ADD2(a, c, e);
+	SSUB #(.DATAWIDTH(32)) SUB1(a, b, f);
+	SCOMP #(.DATAWIDTH(32)) COMP1(d, e, 1'b0, 1'b0, dEQe);
+	SCOMP #(.DATAWIDTH(32)) COMP2(d, e, 1'b0, dLTe, 1'b0);
+	SMUX #(.DATAWIDTH(32)) MUX1(d, e, dLTe, g);
+	SMUX #(.DATAWIDTH(32)) MUX2(g, f, dEQe, h);
+	SHL #(.DATAWIDTH(32)) SHL1(g, xwire, dLTe);
+	SHR #(.DATAWIDTH(32)) SHR1(h, zwire, dEQe);
+	SREG #(.DATAWIDTH(32)) REG1(xwire, Clk, Rst, x);
+	SREG #(.DATAWIDTH(32)) REG2(zwire, Clk, Rst, z);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,28 @@
+`timescale 1ns / 1ps
+
+module 474a_circuit4.v (
+	input Clk, Rst,
+	input [63:0] a, b, c,
+	output [31:0] z, x
+);
+	wire [63:0] d, e, f, g, h;
+	wire dLTe, dEQe;
+	wire [63:0] xrin, zrin;
+
+	wire [63:0] greg, hreg;
+
+	SADD #(.DATAWIDTH(64)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(64)) ADD2(a, c, e);
+	SSUB #(.DATAWIDTH(64)) SUB1(a, b, f);
+	SCOMP #(.DATAWIDTH(64)) COMP1(d, e, 1'b0, 1'b0, dEQe);
+	SCOMP #(.DATAWIDTH(64)) COMP2(d, e, 1'b0, dLTe, 1'b0);
+	SMUX #(.DATAWIDTH(64)) MUX1(d, e, dLTe, g);
+	SMUX #(.DATAWIDTH(64)) MUX2(g, f, dEQe, h);
+	SREG #(.DATAWIDTH(64)) REG1(g, Clk, Rst, greg);
+	SREG #(.DATAWIDTH(64)) REG2(h, Clk, Rst, hreg);
+	SHL #(.DATAWIDTH(64)) SHL1(hreg, xrin, dLTe);
+	SHR #(.DATAWIDTH(64)) SHR1(greg, zrin, dEQe);
+	SREG #(.DATAWIDTH(32)) REG3(xrin, Clk, Rst, x);
+	SREG #(.DATAWIDTH(32)) REG4(zrin, Clk, Rst, z);
+
+endmodule
\ No newline at end of file
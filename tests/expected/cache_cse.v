@@ -0,0 +1,15 @@
+`timescale 1ns / 1ps
+
+module cache_cse.v (
+	input Clk, Rst,
+	input [7:0] a, b,
+	output [7:0] x, y
+);
+	wire [7:0] xwire;
+	wire [7:0] ywire;
+
+	SADD #(.DATAWIDTH(8)) ADD1(a, b, xwire);
+	SREG #(.DATAWIDTH(8)) REG1(xwire, Clk, Rst, x);
+	SREG #(.DATAWIDTH(8)) REG2(xwire, Clk, Rst, y);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,43 @@
+`timescale 1ns / 1ps
+
+module clock_period.v (
+	input Clk, Rst,
+	input [31:0] a, b, c,
+	output [31:0] z, x
+);
+	wire [31:0] d, e, f, g, h;
+	wire [0:0] dLTe, dEQe;
+	wire [31:0] zwire, xwire;
+
+	wire [31:0] d_p1, d_p2, e_p1, e_p2, f_p1, f_p2, f_p3, g_p1, h_p1, zwire_p1, xwire_p1, xwire_p2;
+	wire [0:0] dLTe_p1, dLTe_p2, dEQe_p1, dEQe_p2;
+
+	SADD #(.DATAWIDTH(32)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(32)) ADD2(a, c, e);
+	SSUB #(.DATAWIDTH(32)) SUB1(a, b, f);
+	SCOMP #(.DATAWIDTH(32)) COMP1(d_p2, e_p2, 1'b0, 1'b0, dEQe);
+	SCOMP #(.DATAWIDTH(32)) COMP2(d_p1, e_p1, 1'b0, dLTe, 1'b0);
+	SMUX #(.DATAWIDTH(32)) MUX1(d_p2, e_p2, dLTe_p1, g);
+	SMUX #(.DATAWIDTH(32)) MUX2(g_p1, f_p3, dEQe_p1, h);
+	SHL #(.DATAWIDTH(32)) SHL1(g_p1, xwire, dLTe_p2);
+	SHR #(.DATAWIDTH(32)) SHR1(h_p1, zwire, dEQe_p2);
+	SREG #(.DATAWIDTH(32)) REG1(xwire_p2, Clk, Rst, x);
+	SREG #(.DATAWIDTH(32)) REG2(zwire_p1, Clk, Rst, z);
+	SREG #(.DATAWIDTH(32)) REG3(d, Clk, Rst, d_p1);
+	SREG #(.DATAWIDTH(32)) REG4(d_p1, Clk, Rst, d_p2);
+	SREG #(.DATAWIDTH(32)) REG5(e, Clk, Rst, e_p1);
+	SREG #(.DATAWIDTH(32)) REG6(e_p1, Clk, Rst, e_p2);
+	SREG #(.DATAWIDTH(32)) REG7(f, Clk, Rst, f_p1);
+	SREG #(.DATAWIDTH(32)) REG8(f_p1, Clk, Rst, f_p2);
+	SREG #(.DATAWIDTH(32)) REG9(f_p2, Clk, Rst, f_p3);
+	SREG #(.DATAWIDTH(32)) REG10(g, Clk, Rst, g_p1);
+	SREG #(.DATAWIDTH(32)) REG11(h, Clk, Rst, h_p1);
+	SREG #(.DATAWIDTH(1)) REG12(dLTe, Clk, Rst, dLTe_p1);
+	SREG #(.DATAWIDTH(1)) REG13(dLTe_p1, Clk, Rst, dLTe_p2);
+	SREG #(.DATAWIDTH(1)) REG14(dEQe, Clk, Rst, dEQe_p1);
+	SREG #(.DATAWIDTH(1)) REG15(dEQe_p1, Clk, Rst, dEQe_p2);
+	SREG #(.DATAWIDTH(32)) REG16(zwire, Clk, Rst, zwire_p1);
+	SREG #(.DATAWIDTH(32)) REG17(xwire, Clk, Rst, xwire_p1);
+	SREG #(.DATAWIDTH(32)) REG18(xwire_p1, Clk, Rst, xwire_p2);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,36 @@
+`timescale 1ns / 1ps
+
+module cost.v (
+	input Clk, Rst,
+	input [31:0] a, b, c,
+	output [31:0] z, x
+);
+	wire [31:0] d, e, f, g, h;
+	wire [0:0] dLTe, dEQe;
+	wire [31:0] zwire, xwire;
+
+	wire [31:0] d_p1, e_p1, f_p1, g_p1, h_p1;
+	wire [0:0] dLTe_p1, dLTe_p2, dEQe_p1, dEQe_p2;
+
+	SADD #(.DATAWIDTH(32)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(32)) ADD2(a, c, e);
+	SSUB #(.DATAWIDTH(32)) SUB1(a, b, f);
+	SCOMP #(.DATAWIDTH(32)) COMP1(d, e, 1'b0, 1'b0, dEQe);
+	SCOMP #(.DATAWIDTH(32)) COMP2(d, e, 1'b0, dLTe, 1'b0);
+	SMUX #(.DATAWIDTH(32)) MUX1(d_p1, e_p1, dLTe_p1, g);
+	SMUX #(.DATAWIDTH(32)) MUX2(g, f_p1, dEQe_p1, h);
+	SHL #(.DATAWIDTH(32)) SHL1(g_p1, xwire, dLTe_p2);
+	SHR #(.DATAWIDTH(32)) SHR1(h_p1, zwire, dEQe_p2);
+	SREG #(.DATAWIDTH(32)) REG1(xwire, Clk, Rst, x);
+	SREG #(.DATAWIDTH(32)) REG2(zwire, Clk, Rst, z);
+	SREG #(.DATAWIDTH(32)) REG3(d, Clk, Rst, d_p1);
+	SREG #(.DATAWIDTH(32)) REG4(e, Clk, Rst, e_p1);
+	SREG #(.DATAWIDTH(32)) REG5(f, Clk, Rst, f_p1);
+	SREG #(.DATAWIDTH(32)) REG6(g, Clk, Rst, g_p1);
+	SREG #(.DATAWIDTH(32)) REG7(h, Clk, Rst, h_p1);
+	SREG #(.DATAWIDTH(1)) REG8(dLTe, Clk, Rst, dLTe_p1);
+	SREG #(.DATAWIDTH(1)) REG9(dLTe_p1, Clk, Rst, dLTe_p2);
+	SREG #(.DATAWIDTH(1)) REG10(dEQe, Clk, Rst, dEQe_p1);
+	SREG #(.DATAWIDTH(1)) REG11(dEQe_p1, Clk, Rst, dEQe_p2);
+
+endmodule
\ No newline at end of file
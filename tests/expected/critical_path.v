@@ -0,0 +1,25 @@
+`timescale 1ns / 1ps
+
+module critical_path.v (
+	input Clk, Rst,
+	input [7:0] a, b, c,
+	output [7:0] z,
+	output [15:0] x,
+
+);
+	wire [7:0] d, e;
+	wire g;
+	wire [15:0] f;
+	wire [15:0] xwire;
+	wire [7:0] zwire;
+
+	SADD #(.DATAWIDTH(8)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(8)) ADD2(a, c, e);
+	SCOMP #(.DATAWIDTH(8)) COMP1(d, e, g, 1'b0, 1'b0);
+	SMUX #(.DATAWIDTH(8)) MUX1(d, e, g, zwire);
+	SREG #(.DATAWIDTH(8)) REG1(zwire, Clk, Rst, z);
+	SMUL #(.DATAWIDTH(16)) MUL1(a, c, f);
+	SSUB #(.DATAWIDTH(16)) SUB1(f, d, xwire);
+	SREG #(.DATAWIDTH(16)) REG2(xwire, Clk, Rst, x);
+
+endmodule
\ No newline at end of file
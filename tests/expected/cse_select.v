@@ -0,0 +1,27 @@
+`timescale 1ns / 1ps
+
+module cse_select.v (
+	input Clk, Rst,
+	input [7:0] a, b, c, e,
+	output [7:0] x, y, z, v
+);
+	wire w2, w3;
+	wire [7:0] w1, w4;
+	wire [7:0] xwire;
+	wire [7:0] ywire;
+	wire [7:0] zwire;
+	wire [7:0] vwire;
+
+	SADD #(.DATAWIDTH(8)) ADD1(a, b, w1);
+	SADD #(.DATAWIDTH(8)) ADD2(a, b, w2);
+	SMUX #(.DATAWIDTH(8)) MUX1(c, e, w2, xwire);
+	SREG #(.DATAWIDTH(8)) REG1(xwire, Clk, Rst, x);
+	SADD #(.DATAWIDTH(8)) ADD3(w1, c, ywire);
+	SREG #(.DATAWIDTH(8)) REG2(ywire, Clk, Rst, y);
+	SSUB #(.DATAWIDTH(8)) SUB1(a, b, w3);
+	SMUX #(.DATAWIDTH(8)) MUX2(c, e, w3, zwire);
+	SREG #(.DATAWIDTH(8)) REG3(zwire, Clk, Rst, z);
+	SMUX #(.DATAWIDTH(8)) MUX3(e, c, w3, vwire);
+	SREG #(.DATAWIDTH(8)) REG4(vwire, Clk, Rst, v);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,18 @@
+`timescale 1ns / 1ps
+
+module literals.v (
+	input Clk, Rst,
+	input [7:0] a,
+	output [7:0] x, y
+);
+	wire [7:0] w;
+	wire [7:0] xwire;
+	wire [7:0] ywire;
+
+	assign w = {a[4:0], 3'd0};
+	assign xwire = w;
+	REG #(.DATAWIDTH(8)) REG1(xwire, Clk, Rst, x);
+	ADD #(.DATAWIDTH(8)) ADD1(a, 16'd300, ywire);
+	REG #(.DATAWIDTH(8)) REG2(ywire, Clk, Rst, y);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,24 @@
+`timescale 1ns / 1ps
+
+module min_width.v (
+	input Clk, Rst,
+	input [15:0] a, b, c, d, e, f, g, h,
+	input [7:0] sa,
+	output [15:0] avg
+);
+	wire [18:0] l00, l01, l02, l03, l10, l11, l2, l2div2, l2div4;
+	wire [15:0] l2div8;
+
+	SADD #(.DATAWIDTH(18)) ADD1(a, b, l00);
+	SADD #(.DATAWIDTH(18)) ADD2(c, d, l01);
+	SADD #(.DATAWIDTH(18)) ADD3(e, f, l02);
+	SADD #(.DATAWIDTH(18)) ADD4(g, h, l03);
+	SADD #(.DATAWIDTH(19)) ADD5(l00, l01, l10);
+	SADD #(.DATAWIDTH(19)) ADD6(l02, l03, l11);
+	SADD #(.DATAWIDTH(19)) ADD7(l10, l11, l2);
+	SHR #(.DATAWIDTH(19)) SHR1(l2, l2div2, sa);
+	SHR #(.DATAWIDTH(19)) SHR2(l2div2, l2div4, sa);
+	SHR #(.DATAWIDTH(19)) SHR3(l2div4, l2div8, sa);
+	SREG #(.DATAWIDTH(16)) REG1(l2div8, Clk, Rst, avg);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,83 @@
+`timescale 1ns / 1ps
+
+module min_width_resources.v (
+	input Clk, Rst,
+	input [15:0] a, b, c, d, e, f, g, h,
+	input [7:0] sa,
+	output [15:0] avg
+);
+	wire [18:0] l00, l01, l02, l03, l10, l11, l2, l2div2, l2div4;
+	wire [15:0] l2div8;
+	wire [15:0] avg_next;
+	wire State9, State_from6, State_from4, State_from5, State_from2, State_from1, State_from3, State0, State1, State2, State3, State4, State5, State6, State7, State8;
+	wire [18:0] add1_a1, add1_a2, add1_a3, add1_a4, add1_a5, add1_a6, add1_b1, add1_b2, add1_b3, add1_b4, add1_b5, add1_b6, add1_out, shr1_out, shr2_out, shr3_out;
+
+	wire [18:0] l00_q, l01_q, l02_q, l03_q, l10_q, l11_q, l2_q, l2div2_q, l2div4_q;
+	wire [15:0] l2div8_q;
+
+	SREG #(.DATAWIDTH(16)) REG1(avg_next, Clk, Rst, avg);
+	SMUX #(.DATAWIDTH(16)) MUX1(l2div8, avg, State9, avg_next);
+	SMUX #(.DATAWIDTH(19)) MUX2(l10, l02, State_from6, add1_a1);
+	SMUX #(.DATAWIDTH(19)) MUX3(l00, g, State_from4, add1_a2);
+	SMUX #(.DATAWIDTH(19)) MUX4(add1_a1, add1_a2, State_from5, add1_a3);
+	SMUX #(.DATAWIDTH(19)) MUX5(e, c, State_from2, add1_a4);
+	SMUX #(.DATAWIDTH(19)) MUX6(add1_a4, a, State_from1, add1_a5);
+	SMUX #(.DATAWIDTH(19)) MUX7(add1_a3, add1_a5, State_from3, add1_a6);
+	SMUX #(.DATAWIDTH(19)) MUX8(l11, l03, State_from6, add1_b1);
+	SMUX #(.DATAWIDTH(19)) MUX9(l01, h, State_from4, add1_b2);
+	SMUX #(.DATAWIDTH(19)) MUX10(add1_b1, add1_b2, State_from5, add1_b3);
+	SMUX #(.DATAWIDTH(19)) MUX11(f, d, State_from2, add1_b4);
+	SMUX #(.DATAWIDTH(19)) MUX12(add1_b4, b, State_from1, add1_b5);
+	SMUX #(.DATAWIDTH(19)) MUX13(add1_b3, add1_b5, State_from3, add1_b6);
+	SADD #(.DATAWIDTH(19)) ADD1(add1_a6, add1_b6, add1_out);
+	SMUX #(.DATAWIDTH(18)) MUX14(add1_out, l00_q, State0, l00);
+	SREG #(.DATAWIDTH(19)) REG2(l00, Clk, Rst, l00_q);
+	SMUX #(.DATAWIDTH(18)) MUX15(add1_out, l01_q, State1, l01);
+	SREG #(.DATAWIDTH(19)) REG3(l01, Clk, Rst, l01_q);
+	SMUX #(.DATAWIDTH(18)) MUX16(add1_out, l02_q, State2, l02);
+	SREG #(.DATAWIDTH(19)) REG4(l02, Clk, Rst, l02_q);
+	SMUX #(.DATAWIDTH(18)) MUX17(add1_out, l03_q, State3, l03);
+	SREG #(.DATAWIDTH(19)) REG5(l03, Clk, Rst, l03_q);
+	SMUX #(.DATAWIDTH(19)) MUX18(add1_out, l10_q, State4, l10);
+	SREG #(.DATAWIDTH(19)) REG6(l10, Clk, Rst, l10_q);
+	SMUX #(.DATAWIDTH(19)) MUX19(add1_out, l11_q, State5, l11);
+	SREG #(.DATAWIDTH(19)) REG7(l11, Clk, Rst, l11_q);
+	SMUX #(.DATAWIDTH(19)) MUX20(add1_out, l2_q, State6, l2);
+	SREG #(.DATAWIDTH(19)) REG8(l2, Clk, Rst, l2_q);
+	SHR #(.DATAWIDTH(19)) SHR1(l2, shr1_out, sa);
+	MUX #(.DATAWIDTH(19)) MUX21(shr1_out, l2div2_q, State7, l2div2);
+	SREG #(.DATAWIDTH(19)) REG9(l2div2, Clk, Rst, l2div2_q);
+	SHR #(.DATAWIDTH(19)) SHR2(l2div2, shr2_out, sa);
+	MUX #(.DATAWIDTH(19)) MUX22(shr2_out, l2div4_q, State8, l2div4);
+	SREG #(.DATAWIDTH(19)) REG10(l2div4, Clk, Rst, l2div4_q);
+	SHR #(.DATAWIDTH(19)) SHR3(l2div4, shr3_out, sa);
+	MUX #(.DATAWIDTH(16)) MUX23(shr3_out, l2div8_q, State9, l2div8);
+	SREG #(.DATAWIDTH(16)) REG11(l2div8, Clk, Rst, l2div8_q);
+
+	reg [3:0] State;
+
+	always @(posedge Clk) begin
+		if (Rst == 1'b1 || State == 4'd9)
+			State <= 4'd0;
+		else
+			State <= State + 4'd1;
+	end
+
+	assign State0 = State == 4'd0;
+	assign State1 = State == 4'd1;
+	assign State2 = State == 4'd2;
+	assign State3 = State == 4'd3;
+	assign State4 = State == 4'd4;
+	assign State5 = State == 4'd5;
+	assign State6 = State == 4'd6;
+	assign State7 = State == 4'd7;
+	assign State8 = State == 4'd8;
+	assign State9 = State == 4'd9;
+	assign State_from1 = State >= 4'd1;
+	assign State_from2 = State >= 4'd2;
+	assign State_from3 = State >= 4'd3;
+	assign State_from4 = State >= 4'd4;
+	assign State_from5 = State >= 4'd5;
+	assign State_from6 = State >= 4'd6;
+
+endmodule
\ No newline at end of file
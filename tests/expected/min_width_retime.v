@@ -0,0 +1,35 @@
+`timescale 1ns / 1ps
+
+module min_width_retime.v (
+	input Clk, Rst,
+	input [63:0] a, b, c,
+	output [31:0] z, x
+);
+	wire [63:0] d, e;
+	wire [31:0] f, h;
+	wire [32:0] g;
+	wire dLTe;
+	wire [0:0] dEQe;
+	wire [31:0] xrin, zrin;
+
+	wire [32:0] greg;
+	wire [31:0] hreg;
+	wire [31:0] f_r1;
+	wire [0:0] dEQe_r1;
+
+	SADD #(.DATAWIDTH(64)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(64)) ADD2(a, c, e);
+	SSUB #(.DATAWIDTH(32)) SUB1(a, b, f);
+	SCOMP #(.DATAWIDTH(64)) COMP1(d, e, 1'b0, 1'b0, dEQe);
+	SCOMP #(.DATAWIDTH(64)) COMP2(d, e, 1'b0, dLTe, 1'b0);
+	SMUX #(.DATAWIDTH(33)) MUX1(d, e, dLTe, g);
+	SMUX #(.DATAWIDTH(32)) MUX2(greg, f_r1, dEQe_r1, h);
+	SHL #(.DATAWIDTH(32)) SHL1(h, xrin, dLTe);
+	SHR #(.DATAWIDTH(33)) SHR1(greg, zrin, dEQe);
+	SREG #(.DATAWIDTH(32)) REG1(f, Clk, Rst, f_r1);
+	SREG #(.DATAWIDTH(33)) REG2(g, Clk, Rst, greg);
+	SREG #(.DATAWIDTH(1)) REG3(dEQe, Clk, Rst, dEQe_r1);
+	SREG #(.DATAWIDTH(32)) REG4(zrin, Clk, Rst, z);
+	SREG #(.DATAWIDTH(32)) REG5(xrin, Clk, Rst, x);
+
+endmodule
\ No newline at end of file
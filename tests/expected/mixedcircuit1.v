@@ -0,0 +1,14 @@
+`timescale 1ns / 1ps
+
+module mixedcircuit1.v (
+	input Clk, Rst,
+	input [7:0] a,
+	input [7:0] b,
+	output [7:0] c
+);
+	wire [7:0] cwire;
+
+	SADD #(.DATAWIDTH(8)) ADD1(a, b, cwire);
+	SREG #(.DATAWIDTH(8)) REG1(cwire, Clk, Rst, c);
+
+endmodule
\ No newline at end of file
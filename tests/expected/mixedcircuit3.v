@@ -0,0 +1,14 @@
+`timescale 1ns / 1ps
+
+module mixedcircuit3.v (
+	input Clk, Rst,
+	input [31:0] a,
+	input [15:0] b,
+	output [7:0] c
+);
+	wire [7:0] cwire;
+
+	SADD #(.DATAWIDTH(8)) ADD1(a, b, cwire);
+	SREG #(.DATAWIDTH(8)) REG1(cwire, Clk, Rst, c);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,19 @@
+`timescale 1ns / 1ps
+
+module pipeline_literals.v (
+	input Clk, Rst,
+	input [7:0] u,
+	output [7:0] z
+);
+	wire [7:0] v;
+	wire [7:0] zwire;
+
+	wire [7:0] v_p1, zwire_p1;
+
+	SMUL #(.DATAWIDTH(8)) MUL1(u, 2'd3, v);
+	SADD #(.DATAWIDTH(8)) ADD1(v_p1, 4'd5, zwire);
+	SREG #(.DATAWIDTH(8)) REG1(zwire_p1, Clk, Rst, z);
+	SREG #(.DATAWIDTH(8)) REG2(v, Clk, Rst, v_p1);
+	SREG #(.DATAWIDTH(8)) REG3(zwire, Clk, Rst, zwire_p1);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,18 @@
+`timescale 1ns / 1ps
+
+module pipeline_output_chain.v (
+	input Clk, Rst,
+	input [7:0] a,
+	output [7:0] x, y
+);
+	wire [7:0] t;
+	wire [7:0] xwire;
+	wire [7:0] ywire;
+
+	SADD #(.DATAWIDTH(8)) ADD1(a, a, t);
+	SADD #(.DATAWIDTH(8)) ADD2(t, a, xwire);
+	SREG #(.DATAWIDTH(8)) REG1(xwire, Clk, Rst, x);
+	SADD #(.DATAWIDTH(8)) ADD3(x, a, ywire);
+	SREG #(.DATAWIDTH(8)) REG2(ywire, Clk, Rst, y);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,32 @@
+`timescale 1ns / 1ps
+
+module retime.v (
+	input Clk, Rst,
+	input [63:0] a, b, c,
+	output [31:0] z, x
+);
+	wire [63:0] d, e, f, g, h;
+	wire dLTe;
+	wire [0:0] dEQe;
+	wire [63:0] xrin, zrin;
+
+	wire [63:0] greg, hreg;
+	wire [63:0] f_r1;
+	wire [0:0] dEQe_r1;
+
+	SADD #(.DATAWIDTH(64)) ADD1(a, b, d);
+	SADD #(.DATAWIDTH(64)) ADD2(a, c, e);
+	SSUB #(.DATAWIDTH(64)) SUB1(a, b, f);
+	SCOMP #(.DATAWIDTH(64)) COMP1(d, e, 1'b0, 1'b0, dEQe);
+	SCOMP #(.DATAWIDTH(64)) COMP2(d, e, 1'b0, dLTe, 1'b0);
+	SMUX #(.DATAWIDTH(64)) MUX1(d, e, dLTe, g);
+	SMUX #(.DATAWIDTH(64)) MUX2(greg, f_r1, dEQe_r1, h);
+	SHL #(.DATAWIDTH(64)) SHL1(h, xrin, dLTe);
+	SHR #(.DATAWIDTH(64)) SHR1(greg, zrin, dEQe);
+	SREG #(.DATAWIDTH(32)) REG1(xrin, Clk, Rst, x);
+	SREG #(.DATAWIDTH(32)) REG2(zrin, Clk, Rst, z);
+	SREG #(.DATAWIDTH(64)) REG3(f, Clk, Rst, f_r1);
+	SREG #(.DATAWIDTH(64)) REG4(g, Clk, Rst, greg);
+	SREG #(.DATAWIDTH(1)) REG5(dEQe, Clk, Rst, dEQe_r1);
+
+endmodule
\ No newline at end of file
@@ -0,0 +1,22 @@
+`timescale 1ns / 1ps
+
+module retime_literals.v (
+	input Clk, Rst,
+	input [7:0] a, b,
+	output [7:0] y
+);
+	wire [7:0] w0, w1, w2, w3, w4;
+
+	wire [7:0] r0, r1;
+	wire [7:0] w2_r1;
+
+	SMUL #(.DATAWIDTH(8)) MUL1(b, a, w0);
+	SSUB #(.DATAWIDTH(8)) SUB1(r0, a, w1);
+	SSUB #(.DATAWIDTH(8)) SUB2(w0, w0, w2);
+	SMUL #(.DATAWIDTH(8)) MUL2(w2_r1, 4'd6, w3);
+	SMUL #(.DATAWIDTH(8)) MUL3(r0, r0, w4);
+	SREG #(.DATAWIDTH(8)) REG1(w0, Clk, Rst, r0);
+	SREG #(.DATAWIDTH(8)) REG2(w2, Clk, Rst, w2_r1);
+	SREG #(.DATAWIDTH(8)) REG3(w4, Clk, Rst, y);
+
+endmodule
\ No newline at end of file
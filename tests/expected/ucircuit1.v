@@ -0,0 +1,13 @@
+`timescale 1ns / 1ps
+
+module ucircuit1.v (
+	input Clk, Rst,
+	input [7:0] a, b,
+	output [7:0] c
+);
+	wire [7:0] cwire;
+
+	ADD #(.DATAWIDTH(8)) ADD1(a, b, cwire);
+	REG #(.DATAWIDTH(8)) REG1(cwire, Clk, Rst, c);
+
+endmodule
\ No newline at end of file
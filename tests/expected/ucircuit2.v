@@ -0,0 +1,14 @@
+`timescale 1ns / 1ps
+
+module ucircuit2.v (
+	input Clk, Rst,
+	input [7:0] a,
+	input [15:0] b,
+	output [31:0] c
+);
+	wire [31:0] cwire;
+
+	ADD #(.DATAWIDTH(32)) ADD1(a, b, cwire);
+	REG #(.DATAWIDTH(32)) REG1(cwire, Clk, Rst, c);
+
+endmodule
\ No newline at end of file
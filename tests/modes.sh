@@ -0,0 +1,274 @@
+#!/bin/sh
+# Runs one of the dpgen modes that convert several netlists, or keep running, and compares the Verilog
+# they write with the expected files of the single conversions (tests/CMakeLists.txt runs it through ctest).
+#
+#	sh modes.sh mode dpgen testsDir circuitsDir workDir
+#
+#	- mode       : One of the modes in the case below (e.g., batch)
+#	- dpgen      : The dpgen executable
+#	- testsDir   : This directory, with expected/ and netlists/
+#	- circuitsDir: The example circuits
+#	- workDir    : Scratch directory of the test, emptied first
+
+mode=$1
+dpgen=$2
+tests=$3
+circuits=$4
+work=$5
+
+# The netlists converted by each mode, whose expected Verilog the single conversions share
+names="474a_circuit1 474a_circuit2 474a_circuit3 474a_circuit4 mixedcircuit1 mixedcircuit2 mixedcircuit3 ucircuit1 ucircuit2 ucircuit3 literals"
+
+rm -rf "$work"
+mkdir -p "$work" || exit 1
+cd "$work" || exit 1
+cp "$circuits"/*.txt "$tests"/netlists/*.txt . || exit 1
+
+failed=0
+
+# Compare name.v with its expected Verilog
+compare()
+{
+    if ! cmp -s "$1.v" "$tests/expected/$1.v"; then
+        echo "$mode: $work/$1.v differs from $tests/expected/$1.v"
+        failed=1
+    fi
+    rm -f "$1.v"
+}
+
+case $mode in
+batch)
+    # A manifest names each Verilog file, so the modules are named as in the single conversions
+    for name in $names; do
+        echo "$name.txt $name.v" >> manifest
+    done
+    for jobs in 1 4; do
+        "$dpgen" --batch manifest --jobs $jobs > batch.out || { cat batch.out; exit 1; }
+        for name in $names; do
+            compare $name
+        done
+    done
+
+    # Netlists of the same name in different directories would write the same Verilog file, so nothing is converted
+    mkdir -p a b
+    cp ucircuit1.txt a/x.txt
+    cp ucircuit2.txt b/x.txt
+    if "$dpgen" --batch '*/x.txt' out > collision.out 2>&1 || [ -e out/x.v ]; then
+        echo "batch: a/x.txt and b/x.txt were both converted to out/x.v"
+        failed=1
+    fi
+    if ! grep -q "a/x.txt and b/x.txt would both be written to out/x.v" collision.out; then
+        echo "batch: the collision is reported as:"
+        cat collision.out
+        failed=1
+    fi
+    ;;
+
+serve)
+    "$dpgen" --serve dpgen.sock --jobs 1 > serve.out 2>&1 &
+    server=$!
+    tries=0
+    while [ ! -S dpgen.sock ]; do
+        tries=$((tries + 1))
+        if [ $tries -gt 100 ]; then
+            echo "serve: the server did not create its socket"
+            cat serve.out
+            kill $server 2> /dev/null
+            exit 1
+        fi
+        sleep 0.1
+    done
+
+    # A client that pings and then keeps its connection open must not hold the only worker (with perl, which
+    # can open a Unix domain socket where the shell cannot)
+    idle=
+    if command -v perl > /dev/null; then
+        perl -MIO::Socket::UNIX -e '$s = IO::Socket::UNIX->new(Peer => $ARGV[0]) or exit 1; print $s "PING\n"; $s->flush;
+            <$s> eq "OK\n" or exit 1; open(READY, ">", $ARGV[1]); close(READY); sleep 30' dpgen.sock idle.ready &
+        idle=$!
+        tries=0
+        while [ ! -f idle.ready ]; do
+            tries=$((tries + 1))
+            if [ $tries -gt 100 ]; then
+                echo "serve: the idle client got no answer to its PING"
+                kill $idle $server 2> /dev/null
+                exit 1
+            fi
+            sleep 0.1
+        done
+    fi
+
+    # The worker reuses its parser, so convert every netlist several times, by path and as text
+    for round in 1 2 3; do
+        for name in $names; do
+            "$dpgen" --client dpgen.sock $name.txt $name.v > client.out 2>&1 || { cat client.out; failed=1; }
+            compare $name
+            "$dpgen" --client dpgen.sock $name.txt $name.v --text > client.out 2>&1 || { cat client.out; failed=1; }
+            compare $name
+        done
+        "$dpgen" --client dpgen.sock error1.txt error1.v > client.out 2>&1
+        if ! cmp -s client.out "$tests/expected/error1.out"; then
+            echo "serve: error1.txt is reported differently than in a single conversion:"
+            cat client.out
+            failed=1
+        fi
+    done
+
+    if [ -n "$idle" ]; then
+        if ! kill -0 $idle 2> /dev/null; then
+            echo "serve: the conversions waited for the idle client to hang up"
+            failed=1
+        fi
+        kill $idle 2> /dev/null
+        wait $idle
+    fi
+
+    kill -INT $server
+    wait $server
+    ;;
+
+trace)
+    # Chrome trace-event JSON with one complete event per phase of the conversion
+    "$dpgen" --trace=trace.json --emit-threads=1 474a_circuit1.txt 474a_circuit1.v > trace.out || { cat trace.out; exit 1; }
+    compare 474a_circuit1
+    if [ "$(head -n 1 trace.json)" != '{"displayTimeUnit": "ms", "traceEvents": [' ] || [ "$(tail -n 1 trace.json)" != ']}' ]; then
+        echo "trace: trace.json is not a trace-event array"
+        failed=1
+    fi
+    for phase in read parse declarations operations optimize emit instances translate write convert; do
+        if ! grep -q "^{\"name\": \"$phase\", \"cat\": \"dpgen\", \"ph\": \"X\", .*\"dur\": [0-9.]*[,}]" trace.json; then
+            echo "trace: no complete event of the $phase phase"
+            failed=1
+        fi
+    done
+    ;;
+
+compile_ir)
+    # A precompiled netlist converts to the same Verilog as its text
+    for name in $names; do
+        "$dpgen" --compile-ir $name.txt $name.dpir > compile.out || { cat compile.out; failed=1; }
+        "$dpgen" $name.dpir $name.v > convert.out || { cat convert.out; failed=1; }
+        compare $name
+    done
+    ;;
+
+emit_threads)
+    # Enough operations for several formatting chunks (each at least 32768 operations), with every kind of instance
+    awk 'BEGIN {
+        n = 100000
+        print "input Int16 a, b"
+        print "input UInt4 c"
+        print "output Int16 y"
+        for (i = 0; i <= n; i++) {
+            print "wire Int16 w" i
+            if (i % 8 == 3 || i % 8 == 6) print "wire Int1 g" i
+            if (i % 8 == 7) print "register Int16 r" i
+        }
+        print ""
+        print "w0 = a + b"
+        for (i = 1; i <= n; i++) {
+            p = "w" (i - 1)
+            k = i % 8
+            if (k == 0) print "w" i " = " p " + a"
+            if (k == 1) print "w" i " = " p " - b"
+            if (k == 2) print "w" i " = " p " * a"
+            if (k == 3) { print "g" i " = " p " > b"; print "w" i " = g" i " ? " p " : a" }
+            if (k == 4) print "w" i " = " p " >> c"
+            if (k == 5) print "w" i " = " p " << c"
+            if (k == 6) { print "g" i " = " p " == a"; print "w" i " = g" i " ? b : " p }
+            if (k == 7) { print "r" i " = " p; print "w" i " = r" i " + b" }
+        }
+        print "y = w" n
+    }' > large.txt
+
+    # The instances are formatted on several threads, and the Verilog must not depend on how many
+    "$dpgen" --emit-threads=1 large.txt large.v > emit.out || { cat emit.out; exit 1; }
+    mv large.v serial.v
+    for threads in 2 3 8; do
+        "$dpgen" --emit-threads=$threads large.txt large.v > emit.out || { cat emit.out; exit 1; }
+        if ! cmp -s large.v serial.v; then
+            echo "emit_threads: the Verilog of $threads threads differs from the one of 1 thread"
+            failed=1
+        fi
+    done
+    for name in $names; do
+        "$dpgen" --emit-threads=4 $name.txt $name.v > emit.out || { cat emit.out; failed=1; }
+        compare $name
+    done
+    ;;
+
+check)
+    # The error circuits and the reproducers of the errors that the conversion reports, linted together with a clean netlist
+    "$dpgen" --check ucircuit1.txt error1.txt error2.txt error3.txt error4.txt operand_count.txt literal_overflow.txt literal_destination.txt > check.out
+    status=$?
+    if [ $status -ne 1 ]; then
+        echo "check: exited with $status instead of 1"
+        failed=1
+    fi
+    if [ -n "$DPGEN_UPDATE_EXPECTED" ]; then
+        cp check.out "$tests/expected/check.out"
+    elif ! cmp -s check.out "$tests/expected/check.out"; then
+        echo "check: output differs from $tests/expected/check.out:"
+        cat check.out
+        failed=1
+    fi
+    ;;
+
+watch)
+    # Each edit is converted as the edited netlist would be from scratch, and only the declaration edit needs that
+    cp 474a_circuit2.txt netlist.txt
+    mkdir fresh
+    "$dpgen" --watch netlist.txt netlist.v > watch.out 2>&1 &
+    watcher=$!
+
+    # Wait for the watcher to print its line of conversion $1, then compare netlist.v with a fresh conversion
+    expect()
+    {
+        tries=0
+        while [ "$(grep -c -e ' converted ' -e ' updated ' watch.out)" -lt $1 ]; do
+            tries=$((tries + 1))
+            if [ $tries -gt 100 ]; then
+                echo "watch: conversion $1 was not reported:"
+                cat watch.out
+                kill $watcher 2> /dev/null
+                exit 1
+            fi
+            if [ $((tries % 20)) -eq 0 ]; then # Save again in case the edit came before the watcher started watching
+                cp netlist.txt resaved.txt && mv resaved.txt netlist.txt
+            fi
+            sleep 0.1
+        done
+        cp netlist.txt fresh/netlist.txt
+        (cd fresh && "$dpgen" netlist.txt netlist.v > /dev/null)
+        if ! cmp -s netlist.v fresh/netlist.v; then
+            echo "watch: after conversion $1, netlist.v differs from a conversion of the edited netlist"
+            failed=1
+        fi
+    }
+
+    expect 1
+    sed -i 's/^f = a - b/f = a * b/' netlist.txt # One operation changes its instance
+    expect 2
+    sed -i -e '/^f = a \* b/d' -e 's/^d = a + b$/d = a + b\nf = b - c/' netlist.txt # Operations move, so later instances are renumbered
+    expect 3
+    sed -i 's/^g = dLTe ? d : e/g = dEQe ? e : d/' netlist.txt
+    expect 4
+    sed -i 's/^wire Int32 d, e, f, g, h/wire Int16 d, e, f, g, h/' netlist.txt # A declaration edit is converted again
+    expect 5
+
+    kill -INT $watcher
+    wait $watcher
+    if [ "$(grep -c ' updated ' watch.out)" -ne 3 ] || [ "$(grep -c ' converted ' watch.out)" -ne 2 ]; then
+        echo "watch: the operation edits were not spliced into the resident netlist:"
+        cat watch.out
+        failed=1
+    fi
+    ;;
+
+*)
+    echo "Unknown mode: $mode"
+    exit 1
+    ;;
+esac
+
+exit $failed
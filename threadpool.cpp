@@ -0,0 +1,150 @@
+#include "threadpool.h"
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+static thread_local const ThreadPool* currentPool = nullptr; // Pool of the calling worker thread, if any
+static thread_local size_t currentIndex = 0; // Queue index of the calling worker thread
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : queued(0), pending(0), nextQueue(0), stopping(false)
+{
+    if (threadCount == 0) // Default to one worker per hardware core
+    {
+        threadCount = thread::hardware_concurrency();
+        if (threadCount == 0) // The core count is unknown
+        {
+            threadCount = 1;
+        }
+    }
+
+    for (size_t i = 0; i < threadCount; ++i) // Create every queue before any worker can try to steal from it
+    {
+        this->queues.push_back(make_unique<WorkerQueue>());
+    }
+
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    this->wait();
+
+    {
+        lock_guard<mutex> guard(this->sleepLock);
+        this->stopping = true;
+    }
+    this->wakeUp.notify_all();
+
+    for (thread& worker : this->workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task)
+{
+    size_t index;
+
+    if (currentPool == this) // Keep nested work on the submitting worker, where its data is still in cache
+    {
+        index = currentIndex;
+    }
+    else
+    {
+        index = this->nextQueue.fetch_add(1) % this->queues.size();
+    }
+
+    this->pending.fetch_add(1);
+
+    {
+        lock_guard<mutex> guard(this->queues[index]->lock);
+        this->queues[index]->tasks.push_back(move(task));
+    }
+
+    {
+        lock_guard<mutex> guard(this->sleepLock); // Publish under the lock so that a worker about to sleep sees it
+        this->queued.fetch_add(1);
+    }
+    this->wakeUp.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    unique_lock<mutex> guard(this->sleepLock);
+    this->allDone.wait(guard, [this] { return this->pending.load() == 0; });
+}
+
+size_t ThreadPool::size() const // Getter for the number of worker threads
+{
+    return this->workers.size();
+}
+
+/*
+    Take the oldest task of the worker's own queue, or else steal the oldest task of another queue
+*/
+bool ThreadPool::popTask(size_t index, function<void()>& task)
+{
+    {
+        WorkerQueue& own = *this->queues[index];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < this->queues.size(); ++offset) // Visit the other queues, starting with the neighbour
+    {
+        WorkerQueue& victim = *this->queues[(index + offset) % this->queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        function<void()> task;
+
+        if (this->popTask(index, task))
+        {
+            this->queued.fetch_sub(1);
+            task();
+
+            if (this->pending.fetch_sub(1) == 1) // This was the last unfinished task
+            {
+                lock_guard<mutex> guard(this->sleepLock);
+                this->allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(this->sleepLock);
+        this->wakeUp.wait(guard, [this] { return this->stopping || this->queued.load() > 0; });
+
+        if (this->stopping && this->queued.load() == 0)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    A fixed set of worker threads, each with its own task queue. A worker takes its tasks in the order
+    they were submitted (so a batch submitted largest first starts with its largest netlists), and when
+    its queue is empty it steals the oldest task of another worker, so a few large netlists do not leave
+    the other cores idle behind them.
+*/
+class ThreadPool
+{
+    private:
+
+        // Task queue owned by one worker
+        struct WorkerQueue
+        {
+            mutex lock; // Guards tasks
+            deque<function<void()>> tasks; // Submitted at the back; the owner and thieves both take from the front
+        };
+
+        vector<unique_ptr<WorkerQueue>> queues; // One queue per worker
+        vector<thread> workers; // The worker threads
+
+        atomic<size_t> queued; // Tasks waiting in any queue
+        atomic<size_t> pending; // Tasks submitted but not finished yet
+        atomic<size_t> nextQueue; // Round-robin target for tasks submitted from outside the pool
+
+        mutex sleepLock; // Guards the condition variables and stopping
+        condition_variable wakeUp; // Signalled when a task is queued or the pool stops
+        condition_variable allDone; // Signalled when pending drops to zero
+        bool stopping; // Set by the destructor
+
+        bool popTask(size_t index, function<void()>& task);
+        void workerLoop(size_t index);
+
+    public:
+
+        // Parameterized Constructor (zero threads means one per hardware core)
+        explicit ThreadPool(size_t threadCount = 0);
+
+        // Destructor (finishes the queued tasks first)
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void submit(function<void()> task); // Queue a task (tasks submitted by a worker go to its own queue)
+        void wait(); // Block until every submitted task has finished
+
+        size_t size() const;
+};
+
+#endif
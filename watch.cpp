@@ -0,0 +1,511 @@
+#include "watch.h"
+#include "lexer.h"
+#include "cache.h"
+#include "dataflow.h"
+#include "dpir.h"
+
+#include <algorithm> // Provides mismatch(), count(), and lower_bound()
+#include <chrono> // Provides steady_clock to time each update
+#include <cstdio> // Provides snprintf()
+#include <csignal> // Provides signal() for a clean shutdown
+#include <fstream> // Provides fstream to patch the output in place
+#include <filesystem> //  Provides functions to perform operations on file systems (e.g., querying file attributes, iterating through directory contents, and manipulating paths)
+#include <iostream> // Provides the basic input/output stream functionality in C++ (e.g., cin and cout)
+#include <memory> // Provides unique_ptr
+#include <thread> // Provides this_thread::sleep_for()
+
+#if defined(__linux__)
+#include <poll.h> // Provides poll() so the loop can notice a shutdown request
+#include <sys/inotify.h> // Provides inotify_init1() and inotify_add_watch()
+#include <unistd.h> // Provides read() and close()
+#endif
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+const int WATCH_SETTLE_MS = 50; // Quiet time after the last change before converting, so one save is converted once
+const int WATCH_POLL_MS = 500; // Interval between reads of the netlists where inotify is not available
+
+static volatile sig_atomic_t stopRequested = 0; // Set by SIGINT or SIGTERM
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+static size_t countLines(string_view text) // Number of lines in text, counting an unterminated last line
+{
+    size_t lines = (size_t)count(text.begin(), text.end(), '\n');
+    return (!text.empty() && text.back() != '\n') ? lines + 1 : lines;
+}
+
+static size_t digitCount(int value) // Number of decimal digits of a positive value
+{
+    size_t digits = 1;
+    for (; value >= 10; value /= 10)
+    {
+        digits++;
+    }
+    return digits;
+}
+
+/*
+    Bring a file that holds oldSize bytes up to date with contents, which differ from its text only from byte from
+    up to byte to (of contents). Text of the same length is patched in place, otherwise everything after from is rewritten
+*/
+static bool patchFile(const string& path, string_view contents, size_t from, size_t to, size_t oldSize)
+{
+    error_code error;
+    if (filesystem::file_size(path, error) != oldSize || error) // Changed behind our back, so it is written from scratch
+    {
+        return writeWholeFile(path, contents);
+    }
+
+    fstream file(path, ios::in | ios::out | ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    size_t end = contents.size() == oldSize ? to : contents.size();
+    file.seekp((streamoff)from);
+    file.write(contents.data() + from, (streamsize)(end - from));
+    file.close();
+
+    if (contents.size() < oldSize)
+    {
+        filesystem::resize_file(path, contents.size(), error);
+    }
+    return !file.fail() && !error;
+}
+
+const string& WatchSession::getNetlistFile() const // Getter for the watched netlist
+{
+    return this->netlistFile;
+}
+
+void WatchSession::formatFragments(size_t first, size_t count, vector<Fragment>& formatted)
+{
+    const OpList& operations = this->netParser.getOperations();
+    const SymbolTable& symbols = this->netParser.getSymbols();
+
+    formatted.reserve(formatted.size() + count);
+    for (size_t index = first; index < first + count; ++index)
+    {
+        Fragment fragment{this->fragments.size(), 0, 0};
+        if (operations.getOpcode(index) != Opcode::NONE) // Unrecognized operations are not emitted
+        {
+            operations.printInstanceHead(this->fragments, index, symbols);
+            fragment.headLength = (uint32_t)(this->fragments.size() - fragment.start);
+            operations.printInstancePorts(this->fragments, index, symbols);
+            fragment.length = (uint32_t)(this->fragments.size() - fragment.start);
+        }
+        formatted.push_back(fragment);
+    }
+    return;
+}
+
+void WatchSession::compactFragments()
+{
+    Emitter compacted;
+    string_view text = this->fragments.text();
+    compacted.reserve(text.size() / 2);
+
+    for (Fragment& fragment : this->operationFragments)
+    {
+        size_t start = compacted.size();
+        compacted.append(text.substr(fragment.start, fragment.length));
+        fragment.start = start;
+    }
+
+    this->fragments = move(compacted);
+    return;
+}
+
+// Operations [first, last) with their instance numbers; operationCounts holds the number of instances named before first
+void WatchSession::appendInstances(Emitter& file, size_t first, size_t last, int* operationCounts) const
+{
+    const OpList& operations = this->netParser.getOperations();
+    string_view text = this->fragments.text();
+
+    for (size_t index = first; index < last; ++index)
+    {
+        Opcode opcode = operations.getOpcode(index);
+        if (opcode != Opcode::NONE) // Numbered like printInstances() numbers them
+        {
+            const Fragment& fragment = this->operationFragments[index];
+            file.append(text.substr(fragment.start, fragment.headLength));
+            file.appendInt(++operationCounts[getDescriptor(opcode).counter]);
+            file.append(text.substr(fragment.start + fragment.headLength, fragment.length - fragment.headLength));
+        }
+    }
+    return;
+}
+
+string WatchSession::assembleVerilog()
+{
+    Emitter file;
+    file.reserve(this->verilogText.size() + 4096);
+    printModuleHead(file, this->moduleName, this->netParser);
+    this->headLength = file.size();
+
+    int operationCounts[COUNTER_COUNT] = {}; // Number of instances emitted so far for each instance name
+    this->appendInstances(file, 0, this->netParser.getOperations().size(), operationCounts);
+
+    file.append("\nendmodule");
+    return file.release();
+}
+
+// Convert the whole netlist, and keep the fragments when the next edit can be spliced into the result
+bool WatchSession::convertAll(const string& text)
+{
+    this->incremental = false;
+    this->fragments = Emitter();
+    this->operationFragments.clear();
+
+    bool image = NetlistImage::isImage(text);
+    string error;
+    bool parsed = image ? NetlistImage::load(text, this->netParser, error) : this->netParser.parseText(text);
+    if (!parsed)
+    {
+        cout << this->netlistFile << ": ERROR FOUND: " << (image ? error : this->netParser.getErrorMessage()) << endl;
+        return false;
+    }
+
+    this->netParser.optimize();
+
+    string verilog;
+    if (image || this->options.eliminateCommonSubexpressions || this->options.minimizeWidths || this->options.clockPeriod > 0 || this->options.retime || !this->options.unitLimits.empty() ||
+        this->netParser.getLiteralCount() != 0) // These passes (with constant folding) look across the whole netlist, so an edit is never local
+    {
+        verilog = this->netParser.emitVerilog(this->moduleName);
+    }
+    else
+    {
+        formatFragments(0, this->netParser.getOperations().size(), this->operationFragments);
+        verilog = this->assembleVerilog();
+        this->incremental = true;
+    }
+
+    if (!writeFileIfChanged(this->verilogFile, verilog))
+    {
+        cout << this->netlistFile << ": Unable to write the Verilog file " << this->verilogFile << endl;
+        this->incremental = false;
+        return false;
+    }
+
+    this->verilogText = move(verilog);
+    return true;
+}
+
+/*
+    Splice an edit into the resident netlist. The edit is the smallest run of whole lines outside the common leading and
+    trailing lines of both texts; the operations of its old lines are replaced by those of its new lines, and only those
+    are formatted. Finding the edit, counting the lines and instances before it, and rebuilding the use-def index are
+    memory scans; the output is patched from the first instance whose text changes, without formatting anything else
+*/
+bool WatchSession::convertEdit(const string& text, string& summary)
+{
+    const string& old = this->netlistText;
+    if (!this->incremental || NetlistImage::isImage(text))
+    {
+        return false;
+    }
+
+    // The first differing byte, moved back to the start of its line
+    size_t common = min(old.size(), text.size());
+    size_t prefix = (size_t)(mismatch(old.begin(), old.begin() + common, text.begin()).first - old.begin());
+    size_t editStart = prefix == 0 ? 0 : old.rfind('\n', prefix - 1);
+    editStart = (prefix == 0 || editStart == string::npos) ? 0 : editStart + 1;
+
+    // The common trailing bytes after it, moved forward to the start of a line in both texts
+    size_t suffix = (size_t)(mismatch(old.rbegin(), old.rbegin() + (common - editStart), text.rbegin()).first - old.rbegin());
+    size_t oldEnd = old.size() - suffix;
+    size_t newEnd = text.size() - suffix;
+    bool lineStart = (oldEnd == 0 || old[oldEnd - 1] == '\n') && (newEnd == 0 || text[newEnd - 1] == '\n');
+    if (!lineStart)
+    {
+        size_t newline = old.find('\n', oldEnd);
+        size_t skip = newline == string::npos ? suffix : newline + 1 - oldEnd;
+        oldEnd += skip;
+        newEnd += skip;
+    }
+
+    string_view oldLines = string_view(old).substr(editStart, oldEnd - editStart);
+    string_view newLines = string_view(text).substr(editStart, newEnd - editStart);
+
+    NetLexer lexer(oldLines); // Removing a declaration or a comment changes more than the operations of its line
+    NetLine line;
+    while (lexer.nextLine(line))
+    {
+        if (line.kind != LineKind::OPERATION)
+        {
+            return false;
+        }
+    }
+
+    int firstLine = 1 + (int)count(old.begin(), old.begin() + editStart, '\n');
+    int oldLineCount = (int)countLines(oldLines);
+    int newLineCount = (int)countLines(newLines);
+
+    const vector<uint32_t>& operationLines = this->netParser.getOperationLines();
+    const OpList& operations = this->netParser.getOperations();
+    size_t firstOp = (size_t)(lower_bound(operationLines.begin(), operationLines.end(), (uint32_t)firstLine) - operationLines.begin());
+    size_t lastOp = (size_t)(lower_bound(operationLines.begin(), operationLines.end(), (uint32_t)(firstLine + oldLineCount)) - operationLines.begin());
+    size_t oldCount = operations.size();
+
+    // Where the instances of the edited operations are in the output, and how many instances of each kind come before and among them
+    int countsBefore[COUNTER_COUNT] = {};
+    size_t instancesStart = this->headLength;
+    for (size_t index = 0; index < firstOp; ++index)
+    {
+        Opcode opcode = operations.getOpcode(index);
+        if (opcode != Opcode::NONE)
+        {
+            int number = ++countsBefore[getDescriptor(opcode).counter];
+            instancesStart += this->operationFragments[index].length + digitCount(number);
+        }
+    }
+
+    int oldCounts[COUNTER_COUNT];
+    copy(countsBefore, countsBefore + COUNTER_COUNT, oldCounts);
+    size_t instancesEnd = instancesStart;
+    for (size_t index = firstOp; index < lastOp; ++index)
+    {
+        Opcode opcode = operations.getOpcode(index);
+        if (opcode != Opcode::NONE)
+        {
+            int number = ++oldCounts[getDescriptor(opcode).counter];
+            instancesEnd += this->operationFragments[index].length + digitCount(number);
+        }
+    }
+
+    bool selectsChanged;
+    if (!this->netParser.replaceOperationText(firstOp, lastOp, newLines, firstLine, newLineCount - oldLineCount, selectsChanged))
+    {
+        return false;
+    }
+
+    size_t newCount = operations.size() - (oldCount - (lastOp - firstOp)); // Operations of the new lines
+    vector<Fragment> formatted;
+    formatFragments(firstOp, newCount, formatted);
+    this->operationFragments.erase(this->operationFragments.begin() + firstOp, this->operationFragments.begin() + lastOp);
+    this->operationFragments.insert(this->operationFragments.begin() + firstOp, formatted.begin(), formatted.end());
+
+    if (this->fragments.size() > 2 * this->verilogText.size() + (1 << 20)) // Mostly replaced text by now
+    {
+        this->compactFragments();
+    }
+
+    /*
+        The module head keeps its text unless a wire starts or stops being a select, and the instances after the edit keep
+        theirs unless the edit changes how many instances of some kind come before them. Only the text that changes is
+        formatted and written; a changed head, which is rare, assembles the whole module again
+    */
+    size_t oldSize = this->verilogText.size();
+    bool written;
+    if (selectsChanged)
+    {
+        this->verilogText = this->assembleVerilog();
+        written = writeWholeFile(this->verilogFile, this->verilogText);
+    }
+    else
+    {
+        Emitter instances;
+        int newCounts[COUNTER_COUNT];
+        copy(countsBefore, countsBefore + COUNTER_COUNT, newCounts);
+        this->appendInstances(instances, firstOp, firstOp + newCount, newCounts);
+
+        if (equal(newCounts, newCounts + COUNTER_COUNT, oldCounts))
+        {
+            this->verilogText.replace(instancesStart, instancesEnd - instancesStart, instances.text());
+            written = patchFile(this->verilogFile, this->verilogText, instancesStart, instancesStart + instances.size(), oldSize);
+        }
+        else // The later instances are numbered differently now
+        {
+            this->appendInstances(instances, firstOp + newCount, operations.size(), newCounts);
+            instances.append("\nendmodule");
+            this->verilogText.resize(instancesStart);
+            this->verilogText.append(instances.text());
+            written = patchFile(this->verilogFile, this->verilogText, instancesStart, this->verilogText.size(), oldSize);
+        }
+    }
+
+    if (!written)
+    {
+        cout << this->netlistFile << ": Unable to write the Verilog file " << this->verilogFile << endl;
+        this->incremental = false;
+        return false;
+    }
+
+    summary = newLineCount == 0 ? "removed lines " + to_string(firstLine) + "-" + to_string(firstLine + oldLineCount - 1)
+                                : "lines " + to_string(firstLine) + "-" + to_string(firstLine + newLineCount - 1);
+    summary += ", " + to_string(newCount) + (newCount == 1 ? " operation" : " operations");
+    return true;
+}
+
+void WatchSession::report(const char* action, double milliseconds, const string& summary)
+{
+    char time[32];
+    snprintf(time, sizeof(time), "%.3f", milliseconds);
+    cout << this->netlistFile << ": " << action << " " << this->verilogFile << " in " << time << " ms";
+    if (!summary.empty())
+    {
+        cout << " (" << summary << ")";
+    }
+    cout << endl;
+
+    if (this->options.criticalPath)
+    {
+        DataflowGraph graph; // Edges from each operation to the operations that read its output
+        graph.build(this->netParser.getOperations(), this->netParser.getSymbols());
+        printTimingReport(cout, graph, graph.analyzeTiming());
+    }
+    if (this->options.costReport)
+    {
+        DataflowGraph graph;
+        graph.build(this->netParser.getOperations(), this->netParser.getSymbols());
+        printCostReport(cout, graph.analyzeCost(this->options.clockPeriod), this->netParser.getSymbols());
+    }
+    return;
+}
+
+bool WatchSession::update()
+{
+    MappedFile file(this->netlistFile);
+    if (!file.isOpen()) // An editor may replace the file by a rename, which leaves it missing for a moment
+    {
+        cout << this->netlistFile << ": Unable to open the text file of " << this->netlistFile << endl;
+        return false;
+    }
+
+    string text(file.text());
+    if (this->started && text == this->netlistText) // Saved without a change
+    {
+        return true;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    string summary;
+    bool edited = this->started && this->convertEdit(text, summary);
+    bool converted = edited || this->convertAll(text);
+    double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    this->started = true;
+    this->netlistText = move(text); // A failed netlist is not converted again until it changes
+    if (!converted)
+    {
+        this->incremental = false;
+        return false;
+    }
+
+    this->report(edited ? "updated" : "converted", milliseconds, summary);
+    return true;
+}
+
+int runWatch(const vector<string>& args, const ConvertOptions& options)
+{
+    if (args.empty() || args.size() % 2 != 0)
+    {
+        cerr << "Error: --watch expects pairs of netlistFile verilogFile" << endl;
+        return 1;
+    }
+
+    ConvertOptions watchOptions = options;
+    watchOptions.collectStats = false; // Updates are timed by the session itself
+
+    vector<unique_ptr<WatchSession>> sessions;
+    for (size_t i = 0; i < args.size(); i += 2)
+    {
+        sessions.push_back(make_unique<WatchSession>(args[i], args[i + 1], watchOptions));
+        sessions.back()->update();
+    }
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    cout << "dpgen watching " << sessions.size() << (sessions.size() == 1 ? " netlist" : " netlists") << " (Ctrl+C to stop)" << endl;
+
+#if defined(__linux__)
+    int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify < 0)
+    {
+        cerr << "Error: Unable to start inotify" << endl;
+        return 1;
+    }
+
+    // Editors often save by writing a new file and renaming it over the old one, so the directories are watched rather than the files
+    vector<int> watches(sessions.size());
+    for (size_t i = 0; i < sessions.size(); ++i)
+    {
+        filesystem::path directory = filesystem::path(sessions[i]->getNetlistFile()).parent_path();
+        string watched = directory.empty() ? "." : directory.string();
+        watches[i] = inotify_add_watch(notify, watched.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY);
+        if (watches[i] < 0)
+        {
+            cerr << "Error: Unable to watch " << watched << endl;
+            close(notify);
+            return 1;
+        }
+    }
+
+    vector<bool> pending(sessions.size(), false);
+    alignas(inotify_event) char events[16384];
+
+    while (!stopRequested)
+    {
+        bool anyPending = find(pending.begin(), pending.end(), true) != pending.end();
+        pollfd waiting = { notify, POLLIN, 0 };
+        int ready = poll(&waiting, 1, anyPending ? WATCH_SETTLE_MS : 200); // Wake up regularly to notice a shutdown request
+
+        if (ready > 0)
+        {
+            ssize_t length;
+            while ((length = read(notify, events, sizeof(events))) > 0)
+            {
+                for (char* at = events; at < events + length; at += sizeof(inotify_event) + ((inotify_event*)at)->len)
+                {
+                    const inotify_event* event = (const inotify_event*)at;
+                    if (event->len == 0)
+                    {
+                        continue;
+                    }
+                    for (size_t i = 0; i < sessions.size(); ++i)
+                    {
+                        if (watches[i] == event->wd && filesystem::path(sessions[i]->getNetlistFile()).filename() == event->name)
+                        {
+                            pending[i] = true;
+                        }
+                    }
+                }
+            }
+            continue; // Wait until the changes settle
+        }
+
+        for (size_t i = 0; i < sessions.size(); ++i)
+        {
+            if (pending[i])
+            {
+                pending[i] = false;
+                sessions[i]->update();
+            }
+        }
+    }
+
+    close(notify);
+#else
+    while (!stopRequested) // Without inotify, the file is read again at a fixed interval
+    {
+        this_thread::sleep_for(chrono::milliseconds(WATCH_POLL_MS));
+        for (unique_ptr<WatchSession>& session : sessions)
+        {
+            session->update(); // Reads the file, which is cheap next to a conversion, and converts only if the text changed
+        }
+    }
+#endif
+
+    cout << "dpgen stopped watching" << endl;
+    return 0;
+}
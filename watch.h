@@ -0,0 +1,82 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "parser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    A directive that allows you to use names from the std namespace without prefixing them with ''
+    The std namespace contains many standard library components for tasks like I/O operations, string manipulation, and working with containers.
+*/
+using namespace std;
+
+/*
+    One netlist kept converted by dpgen --watch. The parsed netlist stays resident between edits together with
+    the instance text of every operation (without its instance number, which depends on the operations before it).
+    An edit is diffed against the previous text by its common leading and trailing lines; when it only touches
+    operation lines, just those lines are parsed and formatted and spliced into the resident netlist. Any other
+    edit (declarations, comments, registers synthesized for outputs, --cse, --min-width, --clock-period, --retime, --resources, a precompiled netlist) is converted
+    again from scratch
+*/
+class WatchSession
+{
+    private:
+        // The instance text of one operation, split where the instance number goes
+        struct Fragment
+        {
+            size_t start; // Offset in fragments
+            uint32_t headLength; // e.g., "\tADD #(.DATAWIDTH(8)) ADD"
+            uint32_t length; // Head plus ports, e.g., "(a, b, d);\n"
+        };
+
+        string netlistFile;
+        string verilogFile;
+        string moduleName;
+        ConvertOptions options;
+        NetParser netParser; // The resident netlist
+        string netlistText; // Text of the last conversion
+        string verilogText; // Output of the last conversion
+        size_t headLength; // Length of the module text before the first instance in verilogText
+        bool started; // Whether the netlist was read at least once
+        bool incremental; // Whether netParser and the fragments match netlistText, so the next edit can be spliced in
+
+        Emitter fragments; // Instance text of the operations, in no particular order (replaced fragments are left behind until a compaction)
+        vector<Fragment> operationFragments; // Fragment of each operation of netParser (indexed like OpList)
+
+        void formatFragments(size_t first, size_t count, vector<Fragment>& formatted); // Format operations [first, first + count)
+        void compactFragments(); // Drop the text that no operation refers to any more
+        string assembleVerilog(); // The module from the nets and the fragments, exactly as emitVerilog() would write it
+        void appendInstances(Emitter& file, size_t first, size_t last, int* operationCounts) const; // The instances of operations [first, last)
+        bool convertAll(const string& text); // Full conversion
+        bool convertEdit(const string& text, string& summary); // Incremental conversion, false if the edit needs a full one
+        void report(const char* action, double milliseconds, const string& summary); // One line per conversion, then the --critical-path and --cost reports
+
+    public:
+
+        // Parameterized Constructor
+        WatchSession(const string& netlistFile, const string& verilogFile, const ConvertOptions& options)
+        {
+            this->netlistFile = netlistFile;
+            this->verilogFile = verilogFile;
+            this->moduleName = verilogFile; // Named after the output file, like a single conversion
+            this->options = options;
+            this->headLength = 0;
+            this->started = false;
+            this->incremental = false;
+            this->netParser.setOptions(this->options);
+        }
+
+        WatchSession(const WatchSession&) = delete; // Owns a NetParser
+        WatchSession& operator=(const WatchSession&) = delete;
+
+        const string& getNetlistFile() const;
+        bool update(); // Convert the current contents of the netlist if they changed, false if the conversion failed
+};
+
+// Convert each netlist, then convert it again whenever it is saved, until SIGINT or SIGTERM: dpgen --watch netlistFile verilogFile...
+int runWatch(const vector<string>& args, const ConvertOptions& options);
+
+#endif